@@ -0,0 +1,163 @@
+#include "LegacyRosterRender.hpp"
+
+#include "util/TimeZone.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace legacy_roster_render {
+
+using namespace alliance_helpers;
+
+namespace {
+
+std::string format_hhmm(std::time_t t, const TimeZone& zone) {
+    const std::tm tm = zone.to_local(t);
+    std::ostringstream oss;
+    oss << tm.tm_hour << 'h'
+        << std::setw(2) << std::setfill('0') << tm.tm_min;
+    return oss.str();
+}
+
+} // namespace
+
+std::vector<dpp::embed> build_alliance_embeds(
+    const AllianceRosterData& data,
+    const TimeZone& zone
+)
+{
+    const Alliance& alliance = data.alliance;
+    const auto& ships        = data.ships;
+    const auto& by_ship      = data.by_ship;
+
+    std::time_t scheduled_at = alliance.scheduled_at();
+    std::time_t sale_at      = alliance.sale_at();
+
+    const std::tm tm_start = zone.to_local(scheduled_at);
+
+    std::string day_name  = french_day_name(tm_start);
+    std::string start_str = format_hhmm(scheduled_at, zone);
+    std::string sale_str  = format_hhmm(sale_at, zone);
+
+    int day   = tm_start.tm_mday;
+    int month = tm_start.tm_mon + 1;
+
+    std::time_t replace_at = scheduled_at + 30 * 60;
+    std::string replace_str = format_hhmm(replace_at, zone);
+
+    std::time_t rdv1 = sale_at - 30 * 60;
+    std::time_t rdv2 = sale_at - 15 * 60;
+    std::string rdv1_str = format_hhmm(rdv1, zone);
+    std::string rdv2_str = format_hhmm(rdv2, zone);
+
+    std::vector<dpp::embed> embeds;
+
+    dpp::embed e;
+    e.set_color(ALLIANCE_GOLD_COLOR);
+    e.set_title("🏴‍☠️ Alliance programmée");
+
+    {
+        std::ostringstream desc;
+        desc << "\n";
+        desc << "**Alliance** : **" << alliance.name() << "**\n"
+             << "**Jour/heure** : *" << day_name << " "
+             << std::setw(2) << std::setfill('0') << day
+             << "/"
+             << std::setw(2) << std::setfill('0') << month
+             << "* de " << start_str << " à " << sale_str << "\n";
+
+        std::string organizer_mention =
+            "<@" + std::to_string(alliance.organizer_id()) + ">";
+
+        desc << "**Organisateur** : " << organizer_mention << "\n";
+
+        const std::string& bras_droit = alliance.right_hand();
+        desc << "**Bras droit** : "
+             << (bras_droit.empty() ? "_non défini_" : bras_droit) << "\n";
+
+        desc << "**Reprise des bateaux** : "
+             << (alliance.ships_reuse_planned() ? "✅ Prévu" : "❌ Non prévu") << "\n";
+
+        e.set_description(desc.str());
+    }
+
+    {
+        std::ostringstream der;
+        der << "\n";
+        der << "- Début des try à **" << start_str
+            << "**, remplacement des retardataires à **" << replace_str << "**\n"
+            << "- RDV vers **" << rdv1_str << "-" << rdv2_str
+            << "** pour vendre à **" << sale_str << "**";
+
+        e.add_field("📜 Déroulement", der.str(), false);
+    }
+
+    if (ships.empty()) {
+        e.add_field(
+            "🚢 FLOTTE",
+            "\n_Aucun bateau configuré pour cette alliance._",
+            false
+        );
+    } else {
+        e.add_field(
+            "🚢 FLOTTE",
+            "\u200b",
+            false
+        );
+
+        for (const Ship& ship : ships) {
+            std::string hull = hull_label(ship.hull_type());
+            std::string role = ship.crew_role().empty()
+                             ? "Libre"
+                             : ship.crew_role();
+
+            int cap = hull_capacity(ship.hull_type());
+
+            std::vector<AllianceParticipant> participants;
+            auto it = by_ship.find(ship.id());
+            if (it != by_ship.end()) {
+                participants = it->second;
+                std::sort(participants.begin(), participants.end(),
+                          [](const AllianceParticipant& a,
+                             const AllianceParticipant& b) {
+                              return a.joined_at() < b.joined_at();
+                          });
+            }
+
+            std::ostringstream value;
+            int nb = static_cast<int>(participants.size());
+
+            // Slots principaux
+            for (int i = 0; i < cap; ++i) {
+                if (i < nb) {
+                    value << "• <@" << participants[i].user_id() << ">\n";
+                } else {
+                    value << "• _dispo_\n";
+                }
+            }
+
+            // Remplaçants : italique, plus discret, pas de ligne vide avant,
+            // pas de double saut de ligne entre bateaux.
+            if (nb > cap) {
+                value << "*Remplaçants :*\n";
+                for (int i = cap; i < nb; ++i) {
+                    value << "• <@" << participants[i].user_id() << ">\n";
+                }
+            } else {
+                value << "*Remplaçants :* _aucun_\n";
+            }
+
+            std::ostringstream field_name;
+            field_name << hull << " - " << role
+                       << " [" << std::min(nb, cap) << "/" << cap << "]";
+
+            e.add_field(field_name.str(), value.str(), false);
+        }
+    }
+
+    embeds.push_back(e);
+    return embeds;
+}
+
+} // namespace legacy_roster_render
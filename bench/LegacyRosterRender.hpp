@@ -0,0 +1,17 @@
+#pragma once
+
+#include <vector>
+
+#include "bot/RosterRender.hpp"
+
+// Rendu du roster tel qu'il était avant RenderBuffer et la pagination
+// (ostringstream, copie et tri des participants, un seul embed).
+// Référence du benchmark uniquement.
+namespace legacy_roster_render {
+
+std::vector<dpp::embed> build_alliance_embeds(
+    const alliance_helpers::AllianceRosterData& data,
+    const TimeZone& zone
+);
+
+} // namespace legacy_roster_render
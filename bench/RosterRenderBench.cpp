@@ -0,0 +1,129 @@
+// Rendu des embeds de roster, 6 à 25 bateaux : ancienne version (ostringstream,
+// un seul embed, bench/LegacyRosterRender.cpp) contre build_alliance_roster_pages.
+// dpp::embed est remplacé par bench/stub/dpp/message.h. Compteurs par rendu :
+// allocs (appels à operator new) et bytes (octets demandés).
+
+#include "bot/RosterRender.hpp"
+#include "util/TimeZone.hpp"
+
+#include "LegacyRosterRender.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> g_allocs {0};
+std::atomic<std::uint64_t> g_alloc_bytes {0};
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Les modèles n'exposent pas d'id en écriture : ODB les renseigne via odb::access.
+namespace odb {
+class access {
+public:
+    static void set_id(Ship& s, std::uint64_t id) { s.id_ = id; }
+};
+} // namespace odb
+
+namespace {
+
+using alliance_helpers::AllianceRosterData;
+
+// Flotte réaliste : coques alternées, équipages complets, quelques places
+// libres et quelques remplaçants.
+AllianceRosterData make_roster(int ship_count) {
+    const std::time_t scheduled_at = 1763496000; // mardi 18/11/2025 21h00, Paris
+    AllianceRosterData data;
+    data.alliance = Alliance(987654321098765432ULL, 123456789012345678ULL,
+                             "Alliance des Sept Mers", scheduled_at, scheduled_at + 2 * 3600,
+                             static_cast<unsigned short>(ship_count));
+    data.alliance.right_hand("Capitaine Crochet");
+    data.alliance.ships_reuse_planned(true);
+
+    static const HullType hulls[] = { HullType::galleon, HullType::brig, HullType::sloop };
+    static const char* const roles[] = { "Canons", "Voiles", "", "Abordage" };
+
+    std::uint64_t user_id = 300000000000000000ULL;
+
+    for (int i = 0; i < ship_count; ++i) {
+        const HullType hull = hulls[i % 3];
+        Ship ship(1, static_cast<unsigned short>(i + 1), hull, roles[i % 4]);
+        odb::access::set_id(ship, static_cast<std::uint64_t>(100 + i));
+
+        int members = alliance_helpers::hull_capacity(hull);
+        if (i % 4 == 3)
+            members -= 1;
+        if (i % 3 == 0)
+            members += 2;
+
+        auto& participants = data.by_ship[ship.id()];
+        for (int j = 0; j < members; ++j) {
+            participants.emplace_back(1, user_id, ship.id());
+            user_id += 7919;
+        }
+
+        data.ships.push_back(std::move(ship));
+    }
+
+    return data;
+}
+
+const TimeZone& bench_zone() {
+    static const TimeZone utc("UTC", 0);
+    const TimeZone* paris = time_zone::locate("Europe/Paris");
+    return paris ? *paris : utc;
+}
+
+template <typename Render>
+void run(benchmark::State& state, Render render) {
+    const AllianceRosterData data = make_roster(static_cast<int>(state.range(0)));
+    const TimeZone& zone = bench_zone();
+
+    // Premier rendu hors mesure (tampons par thread, fuseau chargé).
+    benchmark::DoNotOptimize(render(data, zone));
+
+    const std::uint64_t allocs0 = g_allocs.load();
+    const std::uint64_t bytes0  = g_alloc_bytes.load();
+
+    for (auto _ : state) {
+        auto result = render(data, zone);
+        benchmark::DoNotOptimize(result);
+    }
+
+    state.counters["allocs"] = benchmark::Counter(
+        static_cast<double>(g_allocs.load() - allocs0), benchmark::Counter::kAvgIterations);
+    state.counters["bytes"] = benchmark::Counter(
+        static_cast<double>(g_alloc_bytes.load() - bytes0), benchmark::Counter::kAvgIterations);
+}
+
+void BM_RosterRender_Legacy(benchmark::State& state) {
+    run(state, legacy_roster_render::build_alliance_embeds);
+}
+BENCHMARK(BM_RosterRender_Legacy)->DenseRange(6, 25);
+
+void BM_RosterRender(benchmark::State& state) {
+    run(state, alliance_helpers::build_alliance_roster_pages);
+}
+BENCHMARK(BM_RosterRender)->DenseRange(6, 25);
+
+} // namespace
@@ -0,0 +1,178 @@
+// Analyse des saisies des modals : versions std::stoi / ostringstream / mktime
+// (legacy) contre time_parse. Le corpus mêle saisies valides et invalides,
+// comme dans les modals.
+
+#include "util/TimeParse.hpp"
+#include "util/TimeZone.hpp"
+
+#include "legacy/LegacyTimeParse.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string> TIMES = {
+    "21h", "21h30", " 7h05 ", "07:30", "7 h 30", "23:59", "9", "24h", "ab", "12:75"
+};
+
+const std::vector<std::string> CLOCKS = {
+    "21:00", "07:30", " 7 : 05 ", "23:59", "00:00", "9:5", "24:00", "x:10"
+};
+
+const std::vector<std::string> ISO_DATES = {
+    "2025-11-18", " 2026-02-28 ", "2025-1-5", "2024-02-29", "2025-13-01", "2025-11"
+};
+
+const std::vector<std::string> FRENCH_DATES = {
+    "18/11", "18/11/25", "18/11/2025", " 01/01/2026 ", "29/02/2024", "31/02", "18-11", "32/01"
+};
+
+// mktime et localtime lisent TZ : le benchmark tourne dans un fuseau à règles
+// d'heure d'été, comme le bot en production.
+const TimeZone& bench_zone() {
+    static const TimeZone* zone = [] {
+        setenv("TZ", "Europe/Paris", 1);
+        tzset();
+        const TimeZone* z = time_zone::locate("Europe/Paris");
+        static const TimeZone utc("UTC", 0);
+        return z ? z : &utc;
+    }();
+    return *zone;
+}
+
+void BM_ParseHhmm_Legacy(benchmark::State& state) {
+    std::string out;
+    for (auto _ : state) {
+        for (const std::string& s : TIMES) {
+            benchmark::DoNotOptimize(legacy_time_parse::parse_time_to_hhmm(s, out));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * TIMES.size());
+}
+BENCHMARK(BM_ParseHhmm_Legacy);
+
+void BM_ParseHhmm(benchmark::State& state) {
+    int h = 0, m = 0;
+    char out[6];
+    for (auto _ : state) {
+        for (const std::string& s : TIMES) {
+            if (time_parse::parse_hhmm(s, h, m))
+                time_parse::format_hhmm(h, m, out);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * TIMES.size());
+}
+BENCHMARK(BM_ParseHhmm);
+
+void BM_ParseIsoDate_Legacy(benchmark::State& state) {
+    int y = 0, m = 0, d = 0;
+    for (auto _ : state) {
+        for (const std::string& s : ISO_DATES) {
+            benchmark::DoNotOptimize(legacy_time_parse::parse_iso_date(s, y, m, d));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * ISO_DATES.size());
+}
+BENCHMARK(BM_ParseIsoDate_Legacy);
+
+void BM_ParseIsoDate(benchmark::State& state) {
+    int y = 0, m = 0, d = 0;
+    for (auto _ : state) {
+        for (const std::string& s : ISO_DATES) {
+            benchmark::DoNotOptimize(time_parse::parse_iso_date(s, y, m, d));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * ISO_DATES.size());
+}
+BENCHMARK(BM_ParseIsoDate);
+
+void BM_ParseFrenchDate_Legacy(benchmark::State& state) {
+    bench_zone();
+    std::string out;
+    for (auto _ : state) {
+        for (const std::string& s : FRENCH_DATES) {
+            benchmark::DoNotOptimize(legacy_time_parse::parse_french_date_to_iso(s, out));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * FRENCH_DATES.size());
+}
+BENCHMARK(BM_ParseFrenchDate_Legacy);
+
+// Même travail que alliance_helpers::parse_french_date_to_iso : année courante
+// dans le fuseau, puis écriture ISO.
+void BM_ParseFrenchDate(benchmark::State& state) {
+    const TimeZone& zone = bench_zone();
+    std::string out;
+    int y = 0, m = 0, d = 0;
+    char buf[20];
+    for (auto _ : state) {
+        for (const std::string& s : FRENCH_DATES) {
+            const int current_year = zone.to_local(std::time(nullptr)).tm_year + 1900;
+            if (time_parse::parse_french_date(s, current_year, y, m, d))
+                out.assign(buf, time_parse::format_iso_date(y, m, d, buf));
+            benchmark::DoNotOptimize(out);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * FRENCH_DATES.size());
+}
+BENCHMARK(BM_ParseFrenchDate);
+
+void BM_ParseDateDdmm_Legacy(benchmark::State& state) {
+    const std::tm base = bench_zone().to_local(std::time(nullptr));
+    std::tm out {};
+    for (auto _ : state) {
+        for (const std::string& s : FRENCH_DATES) {
+            benchmark::DoNotOptimize(legacy_time_parse::parse_date_ddmm(s, base, out));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * FRENCH_DATES.size());
+}
+BENCHMARK(BM_ParseDateDdmm_Legacy);
+
+void BM_ParseDateDdmm(benchmark::State& state) {
+    const std::tm base = bench_zone().to_local(std::time(nullptr));
+    std::tm out {};
+    for (auto _ : state) {
+        for (const std::string& s : FRENCH_DATES) {
+            benchmark::DoNotOptimize(time_parse::parse_date_ddmm(s, base, out));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * FRENCH_DATES.size());
+}
+BENCHMARK(BM_ParseDateDdmm);
+
+void BM_MakeTimeT_Legacy(benchmark::State& state) {
+    bench_zone();
+    std::time_t out = 0;
+    for (auto _ : state) {
+        for (const std::string& date : ISO_DATES) {
+            for (const std::string& time : CLOCKS) {
+                benchmark::DoNotOptimize(legacy_time_parse::make_time_t(date, time, out));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * ISO_DATES.size() * CLOCKS.size());
+}
+BENCHMARK(BM_MakeTimeT_Legacy);
+
+void BM_MakeTimeT(benchmark::State& state) {
+    const TimeZone& zone = bench_zone();
+    std::time_t out = 0;
+    for (auto _ : state) {
+        for (const std::string& date : ISO_DATES) {
+            for (const std::string& time : CLOCKS) {
+                benchmark::DoNotOptimize(time_parse::make_time_t(date, time, zone, out));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * ISO_DATES.size() * CLOCKS.size());
+}
+BENCHMARK(BM_MakeTimeT);
+
+} // namespace
@@ -0,0 +1,50 @@
+#pragma once
+
+// dpp::embed réduit à ce qu'utilise le rendu du roster, pour construire
+// src/bot/RosterRender.cpp sans DPP. Mêmes signatures, mêmes copies de
+// chaînes ; les membres inutilisés (footer, image, auteur...) sont omis.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dpp {
+
+struct embed_field {
+    std::string name;
+    std::string value;
+    bool is_inline = false;
+};
+
+struct embed {
+    std::string title;
+    std::string description;
+    uint32_t color = 0;
+    std::vector<embed_field> fields;
+
+    embed& set_title(const std::string& text) {
+        title = text;
+        return *this;
+    }
+
+    embed& set_description(const std::string& text) {
+        description = text;
+        return *this;
+    }
+
+    embed& set_color(uint32_t col) {
+        color = col;
+        return *this;
+    }
+
+    embed& add_field(const std::string& name, const std::string& value, bool is_inline = false) {
+        embed_field f;
+        f.name = name;
+        f.value = value;
+        f.is_inline = is_inline;
+        fields.push_back(f);
+        return *this;
+    }
+};
+
+} // namespace dpp
@@ -0,0 +1,7 @@
+#pragma once
+
+// Les modèles (include/model) ne demandent à ODB que la déclaration de
+// odb::access ; bench/ la définit pour renseigner les identifiants.
+namespace odb {
+class access;
+}
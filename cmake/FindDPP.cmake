@@ -11,3 +11,36 @@ find_package_handle_standard_args(
     DPP_LIBRARIES
     DPP_INCLUDE_DIR
 )
+
+# Support des coroutines (dpp::task, dpp::job, dpp::async) : les headers DPP
+# ne les déclarent que si DPP_CORO est défini, et GCC 10 exige -fcoroutines.
+# DPP_CORO_FLAGS / DPP_CORO_DEFINITIONS sont à appliquer aux cibles qui
+# incluent dpp/dpp.h ; DPP_HAS_CORO indique si l'ensemble compile.
+if(DPP_FOUND AND NOT DEFINED DPP_HAS_CORO)
+    set(DPP_CORO_FLAGS "")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU" AND CMAKE_CXX_COMPILER_VERSION VERSION_LESS 11)
+        set(DPP_CORO_FLAGS "-fcoroutines")
+    endif()
+    set(DPP_CORO_DEFINITIONS DPP_CORO)
+
+    include(CheckCXXSourceCompiles)
+    include(CMakePushCheckState)
+
+    cmake_push_check_state(RESET)
+    set(CMAKE_REQUIRED_INCLUDES    "${DPP_INCLUDE_DIR}")
+    set(CMAKE_REQUIRED_DEFINITIONS "-DDPP_CORO")
+    set(CMAKE_REQUIRED_FLAGS       "${CMAKE_CXX20_STANDARD_COMPILE_OPTION} ${DPP_CORO_FLAGS}")
+    set(CMAKE_REQUIRED_LIBRARIES   "${DPP_LIBRARIES}")
+    set(CMAKE_REQUIRED_QUIET       ON)
+    check_cxx_source_compiles("
+        #include <dpp/dpp.h>
+        dpp::task<int> answer() { co_return 42; }
+        dpp::job fire(dpp::cluster&) { co_await answer(); }
+        int main() { return 0; }
+    " DPP_HAS_CORO)
+    cmake_pop_check_state()
+
+    if(DPP_HAS_CORO)
+        message(STATUS "DPP : coroutines disponibles")
+    endif()
+endif()
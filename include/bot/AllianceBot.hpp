@@ -3,9 +3,11 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <dpp/dpp.h>
 
+#include "bot/ComponentRouter.hpp"
 #include "bot/commands/ISlashCommand.hpp"
 #include "bot/ui/IModalUI.hpp"
 
@@ -13,8 +15,6 @@ namespace odb { namespace pgsql {
     class database;
 }}
 
-class SetupUI;
-
 class AllianceBot {
 public:
     AllianceBot(const std::string& token,
@@ -29,12 +29,17 @@ private:
     // "ping" -> PingCommand, "setup" -> SetupCommand, ...
     std::unordered_map<std::string, std::unique_ptr<ISlashCommand>> commands_;
 
-    // "setup_advanced_modal" -> SetupUI, "create_alliance_modal" -> CreateAllianceUI, ...
-    std::unordered_map<std::string, std::unique_ptr<IModalUI>> modal_handlers_;
+    // Instances des UIs à modal ; les routes ci-dessous pointent dessus.
+    std::vector<std::unique_ptr<IModalUI>> modal_uis_;
 
-    SetupUI* setup_ui_ = nullptr;
+    // custom_id (ou préfixe) -> handler de l'UI propriétaire
+    ComponentRouter<dpp::button_click_t> buttons_ {"bouton"};
+    ComponentRouter<dpp::select_click_t> selects_ {"sélecteur"};
+    ComponentRouter<dpp::form_submit_t>  modals_  {"modal"};
 
     void init_commands();
-    void init_modals();
+    void init_components();
+    void init_outbox();
+    void init_metrics();
     void register_event_handlers();
 };
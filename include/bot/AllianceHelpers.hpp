@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <unordered_map>
+#include <functional>
+#include <string>
 #include <memory>
 #include <cstdint>
 #include <ctime>
@@ -22,15 +24,14 @@
 #include "model/alliance_discord_objects.hxx"
 #include "alliance_discord_objects-odb.hxx"
 
-namespace alliance_helpers {
+#include "model/alliance_roster_view.hxx"
+#include "alliance_roster_view-odb.hxx"
 
-constexpr uint32_t ALLIANCE_GOLD_COLOR = 0xFFCF40;
+#include "bot/RosterRender.hpp"
 
-struct AllianceRosterData {
-    Alliance alliance;
-    std::vector<Ship> ships;
-    std::unordered_map<std::uint64_t, std::vector<AllianceParticipant>> by_ship;
-};
+class TimeZone;
+
+namespace alliance_helpers {
 
 std::string trim(const std::string& s);
 bool parse_time_to_hhmm(const std::string& input, std::string& out);
@@ -38,39 +39,80 @@ bool parse_iso_date(const std::string& iso,
                     int& year, int& month, int& day);
 bool make_time_t(const std::string& date_iso,
                  const std::string& time_str,
+                 const TimeZone& zone,
                  std::time_t& out);
 bool parse_french_date_to_iso(const std::string& input,
+                              const TimeZone& zone,
                               std::string& iso_out);
 bool parse_date_ddmm(const std::string& input,
                      const std::tm& base_tm,
                      std::tm& out_tm);
 std::string random_alliance_name();
 
-// Helpers date / texte
-std::string french_day_name(const std::tm& tm);
-std::string format_hhmm(std::time_t t);
-
-// Helpers bateaux (version DB : HullType)
-std::string hull_label(HullType h);
-int hull_capacity(HullType h);
-
-// Chargement complet de la flotte + participants
+// Chargement complet de la flotte + participants (transaction propre).
+// Lève odb::object_not_persistent si l'alliance n'existe pas.
 AllianceRosterData load_alliance_roster_data(
     const std::shared_ptr<odb::pgsql::database>& db,
     std::uint64_t alliance_id
 );
 
-// Construction des embeds dorés
-std::vector<dpp::embed> build_alliance_embeds(
-    const AllianceRosterData& data
+// Variantes en un seul aller-retour, à appeler dans une transaction ouverte.
+// Retournent false si aucune alliance ne correspond.
+bool fetch_alliance_roster(
+    odb::pgsql::database& db,
+    std::uint64_t alliance_id,
+    AllianceRosterData& out
+);
+
+bool fetch_alliance_roster_by_thread(
+    odb::pgsql::database& db,
+    std::uint64_t guild_id,
+    std::uint64_t thread_channel_id,
+    AllianceRosterData& out
 );
 
-// Création / MAJ du message de roster dans le thread
+// Fin d'un rendu de roster : ok est faux si un appel REST a échoué.
+using RenderDone = std::function<void(bool ok, const std::string& error)>;
+
+// Création / MAJ des messages de roster dans le thread, un par page :
+// seules les pages modifiées sont rééditées, les pages en trop supprimées.
+// Les demandes rapprochées sont regroupées : un seul rendu par alliance toutes les
+// ROSTER_DEBOUNCE_SECONDS secondes (0 = rendu immédiat), et jamais deux rendus
+// d'une même alliance en même temps (sinon les deux créeraient la même page).
+// done (facultatif) est appelé quand les appels REST du rendu regroupé sont terminés.
 void create_or_update_alliance_roster_message(
     dpp::cluster* cluster,
     const std::shared_ptr<odb::pgsql::database>& db,
     std::uint64_t alliance_id,
-    dpp::snowflake thread_id
+    dpp::snowflake thread_id,
+    RenderDone done = {}
 );
 
+// Rendu immédiat, sans regroupement ni garde contre un rendu en cours :
+// passer par create_or_update_alliance_roster_message.
+void render_alliance_roster_message_now(
+    dpp::cluster* cluster,
+    const std::shared_ptr<odb::pgsql::database>& db,
+    std::uint64_t alliance_id,
+    dpp::snowflake thread_id,
+    RenderDone done = {}
+);
+
+// Préfixe le nom du thread (ex. "✅ [Terminé] "), sauf s'il l'est déjà.
+void rename_thread_with_prefix(
+    dpp::cluster* cluster,
+    dpp::snowflake thread_id,
+    const std::string& prefix,
+    std::function<void(bool ok, const std::string& error)> done
+);
+
+struct RosterDebounceStats {
+    std::uint64_t requests  = 0; // demandes de mise à jour
+    std::uint64_t renders   = 0; // pages effectivement envoyées à Discord
+    std::uint64_t coalesced = 0; // éditions économisées par regroupement
+    std::uint64_t unchanged = 0; // pages identiques au dernier envoi, non envoyées
+};
+
+RosterDebounceStats roster_debounce_stats();
+
 } // namespace alliance_helpers
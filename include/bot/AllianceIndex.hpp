@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "model/alliances.hxx"
+
+namespace odb { namespace pgsql {
+    class database;
+}}
+
+// Index mémoire thread forum -> alliance.
+// Rempli au démarrage avec les alliances non terminées, puis tenu à jour par
+// les flows create / start / cancel / end : la plupart des handlers savent
+// à quelle alliance correspond un thread sans interroger Postgres.
+namespace alliance_index {
+
+struct Entry {
+    std::uint64_t  alliance_id = 0;
+    std::uint64_t  guild_id    = 0;
+    AllianceStatus status      = AllianceStatus::planned;
+};
+
+struct Stats {
+    std::uint64_t hits    = 0;
+    std::uint64_t misses  = 0; // résolutions ayant dû interroger la base
+    std::size_t   entries = 0;
+};
+
+// Charge les alliances planned / matching / in_game ayant un thread.
+void load(const std::shared_ptr<odb::pgsql::database>& db);
+
+void put(std::uint64_t thread_id, const Entry& entry);
+void set_status(std::uint64_t thread_id, AllianceStatus status);
+void erase(std::uint64_t thread_id);
+
+// Mémoire uniquement.
+std::optional<Entry> find(std::uint64_t guild_id, std::uint64_t thread_id);
+
+// Mémoire, puis repli sur la base (transaction courante si ouverte) ; le résultat est mis en index.
+std::optional<Entry> resolve(odb::pgsql::database& db,
+                             std::uint64_t guild_id,
+                             std::uint64_t thread_id);
+
+// Résout le thread puis charge l'alliance par clé primaire.
+// À appeler dans une transaction ouverte ; nullptr si le thread n'est pas une alliance.
+std::unique_ptr<Alliance> load_alliance(odb::pgsql::database& db,
+                                        std::uint64_t guild_id,
+                                        std::uint64_t thread_id);
+
+Stats stats();
+
+} // namespace alliance_index
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <dpp/dpp.h>
+
+#include "model/alliance_discord_objects.hxx"
+
+namespace odb { namespace pgsql {
+    class database;
+}}
+
+struct PendingCleanupRow;
+
+// File de suppression des objets Discord d'une alliance terminée.
+// L'état est porté par alliance_discord_objects (cleanup_at / cleanup_attempts,
+// deleted_at == 0 tant que l'objet existe) : une suppression interrompue par
+// un redémarrage est reprise par init(). En mémoire, un tas trié par date de
+// prochaine tentative est dépilé par un timer du cluster.
+namespace cleanup_queue {
+
+struct Stats {
+    std::size_t   queued    = 0;
+    std::size_t   in_flight = 0;
+    std::uint64_t deleted   = 0;
+    std::uint64_t retried   = 0;
+    std::uint64_t abandoned = 0; // trop de tentatives, laissé en base avec cleanup_at = 0
+};
+
+// Rôles, salons vocaux / textuels et catégories ; pas les threads ni les messages.
+bool handles(DiscordObjectType type);
+
+// Recharge les suppressions non terminées et démarre le timer (une seule fois).
+void init(dpp::cluster* cluster, const std::shared_ptr<odb::pgsql::database>& db);
+
+// Dans la transaction de l'appelant : planifie la suppression de l'objet.
+void schedule(odb::pgsql::database& db, AllianceDiscordObject& obj);
+
+// Après commit : ajoute à la file les objets planifiés avec schedule().
+void enqueue(std::uint64_t guild_id, const std::vector<AllianceDiscordObject>& objects);
+
+// Idem pour des lignes déjà planifiées en base (reprise, réconciliation).
+void enqueue(const std::vector<PendingCleanupRow>& rows);
+
+Stats stats();
+
+} // namespace cleanup_queue
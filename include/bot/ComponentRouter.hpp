@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Table de routage des custom_id : ids exacts dans une table de hachage,
+// préfixes (ex. "edit_alliance_ship_hull_") dans un trie. Un id exact gagne
+// sur un préfixe ; entre deux préfixes, le plus long gagne.
+class RouteTable {
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    RouteTable();
+
+    // Lève std::logic_error si l'id (ou le préfixe) est déjà enregistré.
+    void add_exact(const std::string& id, std::size_t target);
+    void add_prefix(const std::string& prefix, std::size_t target);
+
+    // target, ou npos. prefix_match indique si la route vient du trie.
+    std::size_t find(const std::string& id, bool& prefix_match) const;
+
+    std::size_t size() const { return exact_.size() + prefixes_; }
+
+private:
+    struct Node {
+        std::vector<std::pair<char, std::uint32_t>> children; // triés par caractère
+        std::size_t target = npos;
+    };
+
+    std::unordered_map<std::string, std::size_t> exact_;
+    std::vector<Node> nodes_; // nodes_[0] : racine
+    std::size_t prefixes_ = 0;
+};
+
+// Routeur d'interactions de composants (boutons, sélecteurs, modals).
+// Les routes sont enregistrées au démarrage, avant le premier événement :
+// route() ne fait ensuite que des lectures et peut être appelé de n'importe quel thread.
+template <typename Event>
+class ComponentRouter {
+public:
+    // Retourne false si l'interaction n'a pas été traitée (ni réponse ni acquittement).
+    using Handler = std::function<bool(const Event& event)>;
+
+    struct Stats {
+        std::size_t   routes      = 0;
+        std::uint64_t exact_hits  = 0;
+        std::uint64_t prefix_hits = 0;
+        std::uint64_t misses      = 0; // aucun handler pour ce custom_id, ou handler qui ne l'a pas traité
+    };
+
+    // Résultat de route() : handler trouvé, à exécuter par dispatch().
+    struct Match {
+        const Handler* handler = nullptr;
+        std::string    key;    // id ou préfixe enregistré (clé stable pour les statistiques)
+        bool           prefix = false;
+
+        explicit operator bool() const { return handler != nullptr; }
+    };
+
+    explicit ComponentRouter(std::string name) : name_(std::move(name)) {}
+
+    void on(const std::string& id, Handler handler) {
+        table_.add_exact(id, handlers_.size());
+        handlers_.push_back(std::move(handler));
+        keys_.push_back(id);
+    }
+
+    void on_prefix(const std::string& prefix, Handler handler) {
+        table_.add_prefix(prefix, handlers_.size());
+        handlers_.push_back(std::move(handler));
+        keys_.push_back(prefix);
+    }
+
+    // Handler propriétaire du custom_id ; Match vide (compté comme miss)
+    // si aucun ne l'est (ex. message d'une ancienne version).
+    Match route(const Event& event) const {
+        Match m;
+        const std::size_t target = table_.find(event.custom_id, m.prefix);
+
+        if (target == RouteTable::npos) {
+            miss(event);
+            return m;
+        }
+
+        m.handler = &handlers_[target];
+        m.key     = keys_[target];
+        return m;
+    }
+
+    // Exécute le handler : un handler qui retourne false (custom_id mal formé
+    // sous un préfixe connu, interaction hors serveur...) compte comme un miss,
+    // et l'appelant doit répondre à sa place.
+    bool dispatch(const Match& m, const Event& event) const {
+        if (!m.handler || !(*m.handler)(event)) {
+            miss(event);
+            return false;
+        }
+
+        (m.prefix ? prefix_hits_ : exact_hits_).fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.routes      = table_.size();
+        s.exact_hits  = exact_hits_.load(std::memory_order_relaxed);
+        s.prefix_hits = prefix_hits_.load(std::memory_order_relaxed);
+        s.misses      = misses_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    const std::string& name() const { return name_; }
+
+    // Ids et préfixes enregistrés, dans l'ordre d'enregistrement.
+    const std::vector<std::string>& keys() const { return keys_; }
+
+private:
+    void miss(const Event& event) const {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "[Router] " << name_ << " non traité : '" << event.custom_id << "'\n";
+    }
+
+    std::string name_;
+    RouteTable table_;
+    std::vector<Handler> handlers_;
+    std::vector<std::string> keys_;
+
+    mutable std::atomic<std::uint64_t> exact_hits_  {0};
+    mutable std::atomic<std::uint64_t> prefix_hits_ {0};
+    mutable std::atomic<std::uint64_t> misses_      {0};
+};
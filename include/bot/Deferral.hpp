@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <dpp/dpp.h>
+
+// Réponses d'interaction avec report automatique.
+// AllianceBot enregistre chaque interaction (begin) avant de la confier au
+// pool DB ; les handlers répondent via reply/ack/dialog au lieu de event.*.
+// Si aucune réponse n'est partie au bout de DEFER_THRESHOLD_MS (ou d'emblée
+// quand la latence moyenne du chemin dépasse ce seuil), l'interaction est
+// acquittée (thinking, ou deferred update pour les chemins qui acquittent
+// ou mettent à jour un composant) et la réponse du handler devient une édition différée.
+namespace deferral {
+
+struct PathStats {
+    std::string   path;                   // ex. "button:end_alliance_confirm"
+    std::uint64_t calls              = 0;
+    std::uint64_t deferred_upfront   = 0; // latence moyenne au-dessus du seuil
+    std::uint64_t deferred_watchdog  = 0; // seuil atteint pendant le traitement
+    std::uint64_t late               = 0; // réponse après le délai Discord sans report possible
+    double        ewma_ms            = 0;
+    std::uint64_t max_ms             = 0;
+};
+
+// Sur le thread du gateway, avant de lancer le handler.
+void begin(const dpp::interaction_create_t& event, const std::string& path);
+
+void reply(const dpp::interaction_create_t& event,
+           const dpp::message& msg,
+           dpp::command_completion_event_t callback = {});
+
+// Acquittement sans message (sélecteurs).
+void ack(const dpp::interaction_create_t& event);
+
+// Remplace le message du composant (ou du modal ouvert depuis un composant).
+void update(const dpp::interaction_create_t& event,
+            const dpp::message& msg,
+            dpp::command_completion_event_t callback = {});
+
+// Un modal doit être la première réponse : le chemin n'est plus jamais reporté.
+void dialog(const dpp::interaction_create_t& event, const dpp::interaction_modal_response& modal);
+
+#ifdef DPP_CORO
+dpp::async<dpp::confirmation_callback_t> co_reply(const dpp::interaction_create_t& event,
+                                                  const dpp::message& msg);
+
+dpp::async<dpp::confirmation_callback_t> co_update(const dpp::interaction_create_t& event,
+                                                   const dpp::message& msg);
+#endif
+
+std::vector<PathStats> stats();
+
+} // namespace deferral
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+
+#include "util/Trace.hpp"
+
+namespace metrics { class Counter; }
+
+// Span racine et compteur d'erreurs de l'interaction en cours de dispatch.
+// AllianceBot termine le span à la sortie du handler ; un handler coroutine
+// (dpp::job) rend la main dès sa première suspension et reprend donc
+// l'interaction (take) pour la conclure lui-même à sa fin.
+namespace interaction_trace {
+
+class Handle {
+public:
+    Handle() = default;
+    Handle(std::shared_ptr<trace::Span> span, metrics::Counter* errors);
+
+    Handle(Handle&& other) noexcept;
+    Handle& operator=(Handle&&) noexcept;
+    ~Handle(); // termine le span
+
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+
+    // Contexte à restaurer après une reprise (invalide sans interaction).
+    trace::Context context() const;
+
+    // Handler sorti sur une exception : span en erreur et compteur incrémenté.
+    void fail(std::string_view message);
+
+    void end();
+
+private:
+    std::shared_ptr<trace::Span> span_;
+    metrics::Counter* errors_ = nullptr;
+};
+
+// Posée par AllianceBot sur le worker DB le temps du dispatch ; à sa
+// destruction, termine le span s'il n'a pas été repris.
+class Dispatch {
+public:
+    Dispatch(std::shared_ptr<trace::Span> span, metrics::Counter* errors);
+    ~Dispatch();
+
+    Dispatch(const Dispatch&) = delete;
+    Dispatch& operator=(const Dispatch&) = delete;
+
+private:
+    Handle    handle_;
+    Dispatch* previous_;
+
+    friend Handle take();
+};
+
+// Reprend l'interaction du dispatch en cours (Handle vide hors dispatch ou
+// si elle a déjà été reprise). À appeler avant la première suspension.
+Handle take();
+
+} // namespace interaction_trace
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <dpp/dpp.h>
+
+#include "model/discord_outbox.hxx"
+
+namespace odb { namespace pgsql {
+    class database;
+}}
+
+// Outbox transactionnelle des effets Discord.
+// Les handlers écrivent l'événement dans la transaction qui change l'état
+// (ex. statut matching + provisioning) ; un dispatcher le rejoue ensuite de
+// façon asynchrone, par lots, jusqu'à succès. Un crash entre le commit et
+// l'appel REST ne perd donc rien : l'événement est repris au démarrage.
+// Chaque événement est réservé en base (FOR UPDATE SKIP LOCKED, statut
+// in_progress jusqu'à locked_until) : plusieurs instances peuvent drainer la
+// même table sans le traiter deux fois. La lecture et les handlers tournent
+// sur le pool db_executor.
+// Les handlers doivent être idempotents (un événement peut être rejoué).
+namespace outbox {
+
+using Done = std::function<void(bool ok, const std::string& error)>;
+
+using Handler = std::function<void(dpp::cluster* cluster,
+                                   const std::shared_ptr<odb::pgsql::database>& db,
+                                   const OutboxEvent& event,
+                                   Done done)>;
+
+struct Stats {
+    std::uint64_t dispatched = 0;
+    std::uint64_t succeeded  = 0;
+    std::uint64_t retried    = 0;
+    std::uint64_t failed     = 0; // abandonnés
+    std::size_t   in_flight  = 0;
+};
+
+// Appelé (sur le pool DB) quand un événement passe en failed après MAX_ATTEMPTS essais.
+using Abandoned = std::function<void(const OutboxEvent& event)>;
+
+void register_handler(OutboxKind kind, Handler handler, Abandoned abandoned = {});
+
+// Démarre le dispatcher (timer du cluster). Les événements en attente sont repris.
+void init(dpp::cluster* cluster, const std::shared_ptr<odb::pgsql::database>& db);
+
+// Dans la transaction de l'appelant. Retourne false si un événement avec la
+// même clé d'idempotence existe déjà (rien n'est écrit).
+bool add(odb::pgsql::database& db,
+         const std::string& idempotency_key,
+         OutboxKind kind,
+         std::uint64_t guild_id,
+         std::uint64_t alliance_id,
+         std::uint64_t channel_id,
+         const std::string& payload = {});
+
+// Après commit : draine tout de suite au lieu d'attendre le prochain tick.
+void kick();
+
+Stats stats();
+
+} // namespace outbox
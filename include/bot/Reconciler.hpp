@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <dpp/dpp.h>
+
+namespace odb { namespace pgsql {
+    class database;
+}}
+
+// Réconciliation des objets Discord orphelins : rôles et salons d'alliances
+// terminées ou annulées encore présents en base (auto_delete, deleted_at = 0)
+// sans être dans la file de nettoyage, typiquement après un crash pendant
+// /terminer. Lancée peu après le démarrage puis périodiquement.
+namespace reconciler {
+
+struct Report {
+    std::size_t scanned   = 0;
+    std::size_t batches   = 0;
+    std::size_t queued    = 0; // encore sur Discord : confiés à cleanup_queue
+    std::size_t missing   = 0; // absents du cache de la guild : marqués supprimés
+    std::size_t unknown   = 0; // guild absente du cache : laissés pour une prochaine passe
+    bool          deferred = false; // passe arrêtée, file REST trop chargée
+    std::uint64_t elapsed_ms = 0;
+};
+
+// Programme la première passe et les suivantes (RECONCILE_INTERVAL_SECONDS),
+// exécutées sur le pool db_executor.
+void init(dpp::cluster* cluster, const std::shared_ptr<odb::pgsql::database>& db);
+
+// Une passe complète, synchrone.
+Report run_once(const std::shared_ptr<odb::pgsql::database>& db);
+
+Report last_report();
+
+} // namespace reconciler
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <dpp/dpp.h>
+
+// File d'attente centrale pour les mutations REST du bot (rôles, salons,
+// messages). Les requêtes sont servies par priorité, chaque route suit son
+// bucket Discord (en-têtes X-RateLimit-*), et les 429 / erreurs serveur sont
+// relancés avec un backoff exponentiel + jitter (429 seulement pour les créations).
+namespace rest_scheduler {
+
+enum class Priority {
+    interactive = 0, // visible immédiatement par l'utilisateur (rôles d'un joueur, roster)
+    normal      = 1, // provisioning d'une alliance
+    background  = 2  // nettoyage
+};
+
+// Erreurs relancées : 429 toujours ; 5xx et erreurs réseau (statut 0) seulement
+// pour les appels idempotents. Une création (POST) peut avoir abouti côté
+// Discord avant l'erreur : la relancer ferait un doublon.
+enum class Retry {
+    transient,       // 429, 5xx, statut 0
+    rate_limit_only  // 429
+};
+
+// Lance l'appel DPP réel ; le scheduler fournit le callback de complétion.
+using Dispatch = std::function<void(dpp::command_completion_event_t)>;
+
+struct Stats {
+    std::uint64_t submitted    = 0;
+    std::uint64_t completed    = 0;
+    std::uint64_t failed       = 0; // abandonnées après erreur ou trop de tentatives
+    std::uint64_t retried      = 0;
+    std::uint64_t rate_limited = 0; // réponses 429 reçues
+    std::size_t   queued       = 0;
+    std::size_t   in_flight    = 0;
+};
+
+// Démarre le tick du scheduler (à appeler une fois, avant tout submit).
+void init(dpp::cluster* cluster);
+
+// route : "<type>:<paramètre majeur>", ex. "role_delete:<guild_id>".
+// on_done est toujours appelé une fois, y compris si l'appel n'a pas pu partir.
+void submit(const std::string& route,
+            Priority prio,
+            Dispatch dispatch,
+            dpp::command_completion_event_t on_done = {},
+            int max_attempts = 5,
+            Retry retry = Retry::transient);
+
+Stats stats();
+
+// Raccourcis pour les appels utilisés par le bot.
+void role_create(dpp::cluster* cluster, const dpp::role& r, Priority prio,
+                 dpp::command_completion_event_t on_done = {});
+void role_delete(dpp::cluster* cluster, dpp::snowflake guild_id, dpp::snowflake role_id,
+                 Priority prio, dpp::command_completion_event_t on_done = {});
+
+void channel_create(dpp::cluster* cluster, const dpp::channel& ch, Priority prio,
+                    dpp::command_completion_event_t on_done = {});
+void channel_delete(dpp::cluster* cluster, dpp::snowflake channel_id, Priority prio,
+                    dpp::command_completion_event_t on_done = {});
+
+void member_add_role(dpp::cluster* cluster, dpp::snowflake guild_id, dpp::snowflake user_id,
+                     dpp::snowflake role_id, Priority prio,
+                     dpp::command_completion_event_t on_done = {});
+void member_remove_role(dpp::cluster* cluster, dpp::snowflake guild_id, dpp::snowflake user_id,
+                        dpp::snowflake role_id, Priority prio,
+                        dpp::command_completion_event_t on_done = {});
+// PATCH du membre complet (remplace sa liste de rôles).
+void member_edit(dpp::cluster* cluster, const dpp::guild_member& member, Priority prio,
+                 dpp::command_completion_event_t on_done = {});
+void member_get(dpp::cluster* cluster, dpp::snowflake guild_id, dpp::snowflake user_id,
+                Priority prio, dpp::command_completion_event_t on_done = {});
+
+void message_create(dpp::cluster* cluster, const dpp::message& msg, Priority prio,
+                    dpp::command_completion_event_t on_done = {});
+void message_edit(dpp::cluster* cluster, const dpp::message& msg, Priority prio,
+                  dpp::command_completion_event_t on_done = {});
+void message_delete(dpp::cluster* cluster, dpp::snowflake message_id, dpp::snowflake channel_id,
+                    Priority prio, dpp::command_completion_event_t on_done = {});
+
+#ifdef DPP_CORO
+// Variantes awaitables (co_await depuis une dpp::task), même file et mêmes priorités.
+dpp::async<dpp::confirmation_callback_t> co_role_create(dpp::cluster* cluster, const dpp::role& r,
+                                                        Priority prio);
+dpp::async<dpp::confirmation_callback_t> co_channel_create(dpp::cluster* cluster, const dpp::channel& ch,
+                                                           Priority prio);
+dpp::async<dpp::confirmation_callback_t> co_message_create(dpp::cluster* cluster, const dpp::message& msg,
+                                                           Priority prio);
+#endif
+
+// Vrai si l'erreur signifie que l'objet n'existe déjà plus côté Discord (404).
+bool is_not_found(const dpp::confirmation_callback_t& cb);
+
+} // namespace rest_scheduler
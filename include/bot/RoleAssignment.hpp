@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dpp/dpp.h>
+
+#include "bot/RestScheduler.hpp"
+
+// Attribution groupée de rôles : pour chaque joueur, on calcule l'ensemble
+// final de ses rôles et on l'applique en une seule édition de membre, au lieu
+// d'un guild_member_add_role par rôle.
+namespace role_assignment {
+
+// user_id -> rôles à ajouter
+using Targets = std::unordered_map<std::uint64_t, std::vector<std::uint64_t>>;
+
+struct Report {
+    std::size_t users    = 0;
+    std::size_t applied  = 0; // une seule édition de membre (ou rien à faire)
+    std::size_t fallback = 0; // rôles ajoutés un par un (membre introuvable ou édition refusée)
+    std::size_t failed   = 0;
+    std::vector<std::pair<std::uint64_t, std::string>> errors; // user_id, message
+    std::uint64_t elapsed_ms = 0;
+};
+
+using Callback = std::function<void(const Report&)>;
+
+// Appelle on_finished une seule fois, quand tous les joueurs ont été traités.
+void assign(dpp::cluster* cluster,
+            std::uint64_t guild_id,
+            Targets targets,
+            rest_scheduler::Priority prio,
+            Callback on_finished);
+
+} // namespace role_assignment
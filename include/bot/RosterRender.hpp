@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dpp/message.h>
+
+#include "model/alliances.hxx"
+#include "model/ships.hxx"
+#include "model/alliance_participants.hxx"
+
+class TimeZone;
+
+// Rendu des embeds de roster, sans accès à la base ni appel REST
+// (construit aussi par bench/ avec un dpp::embed minimal).
+namespace alliance_helpers {
+
+constexpr uint32_t ALLIANCE_GOLD_COLOR = 0xFFCF40;
+
+struct AllianceRosterData {
+    Alliance alliance;
+    std::vector<Ship> ships;
+    // Participants actifs par bateau, triés par date d'inscription (ordre de la requête).
+    std::unordered_map<std::uint64_t, std::vector<AllianceParticipant>> by_ship;
+};
+
+// Helpers date / texte
+std::string french_day_name(const std::tm& tm);
+std::string format_hhmm(std::time_t t, const TimeZone& zone);
+
+// Helpers bateaux (version DB : HullType)
+std::string hull_label(HullType h);
+int hull_capacity(HullType h);
+
+// Embeds d'un message de roster (10 au plus).
+using RosterPage = std::vector<dpp::embed>;
+
+// Construction des embeds dorés, répartis en pages dans les limites Discord
+// (25 champs par embed, 10 embeds et 6000 caractères par message).
+// Toujours au moins une page.
+std::vector<RosterPage> build_alliance_roster_pages(
+    const AllianceRosterData& data,
+    const TimeZone& zone
+);
+
+} // namespace alliance_helpers
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Graphe de tâches asynchrones (appels REST en chaîne) : une tâche démarre
+// dès que ses dépendances sont terminées, dans la limite de `max_parallel`
+// tâches en cours. Une tâche dont une dépendance a échoué est sautée, sauf
+// si elle est marquée `always_run`.
+class TaskGraph {
+public:
+    using Id   = std::size_t;
+    using Done = std::function<void(bool ok)>;
+    using Run  = std::function<void(Done done)>;
+
+    struct Progress {
+        std::size_t total     = 0;
+        std::size_t succeeded = 0;
+        std::size_t failed    = 0;
+        std::size_t skipped   = 0;
+        std::size_t running   = 0;
+        std::uint64_t elapsed_ms = 0;
+        std::vector<std::string> failures; // noms des tâches échouées ou sautées
+
+        std::size_t finished() const { return succeeded + failed + skipped; }
+    };
+
+    using ProgressCallback = std::function<void(const Progress&)>;
+
+    explicit TaskGraph(std::size_t max_parallel);
+
+    // À appeler avant start(). Les dépendances doivent déjà exister.
+    Id add(std::string name, std::vector<Id> deps, Run run, bool always_run = false);
+
+    // on_progress : après chaque tâche terminée ; on_finished : une seule fois.
+    // Les tâches en cours gardent l'état en vie : l'objet peut être détruit après start().
+    void start(ProgressCallback on_progress, ProgressCallback on_finished);
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> impl_;
+};
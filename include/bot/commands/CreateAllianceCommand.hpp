@@ -1,8 +1,8 @@
 #pragma once
 
-#include "bot/commands/ISlashCommand.hpp"
+#include "bot/commands/ICoroSlashCommand.hpp"
 
-class CreateAllianceCommand : public ISlashCommand {
+class CreateAllianceCommand : public ICoroSlashCommand {
 public:
     std::string subcommand_name() const override {
         return "creer";
@@ -12,6 +12,6 @@ public:
         return "Créer une nouvelle alliance";
     }
 
-    void handle(const dpp::slashcommand_t& event,
-                const std::shared_ptr<odb::pgsql::database>& db) const override;
+    dpp::task<void> co_handle(dpp::slashcommand_t event,
+                              std::shared_ptr<odb::pgsql::database> db) const override;
 };
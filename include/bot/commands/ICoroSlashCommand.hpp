@@ -0,0 +1,61 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <dpp/dpp.h>
+
+#include "bot/Deferral.hpp"
+#include "bot/InteractionTrace.hpp"
+#include "bot/commands/ISlashCommand.hpp"
+
+#ifndef DPP_CORO
+#error "ICoroSlashCommand nécessite DPP avec le support des coroutines (DPP_CORO)."
+#endif
+
+namespace odb { namespace pgsql {
+    class database;
+}}
+
+// Variante coroutine de ISlashCommand : co_handle peut attendre les appels
+// REST (co_*) et le pool DB (db_executor::run) au lieu d'imbriquer des callbacks.
+// event et db sont pris par valeur : ils vivent dans la frame de la coroutine,
+// comme le span de l'interaction, terminé quand la coroutine se termine.
+class ICoroSlashCommand : public ISlashCommand {
+public:
+    void handle(const dpp::slashcommand_t& event,
+                const std::shared_ptr<odb::pgsql::database>& db) const final
+    {
+        spawn(this, event, db, interaction_trace::take());
+    }
+
+    virtual dpp::task<void> co_handle(dpp::slashcommand_t event,
+                                      std::shared_ptr<odb::pgsql::database> db) const = 0;
+
+private:
+    static dpp::job spawn(const ICoroSlashCommand* self,
+                          dpp::slashcommand_t event,
+                          std::shared_ptr<odb::pgsql::database> db,
+                          interaction_trace::Handle interaction)
+    {
+        std::string error;
+        try {
+            co_await self->co_handle(event, db);
+        } catch (const std::exception& ex) {
+            error = ex.what();
+        }
+
+        // Reprise éventuelle sur un autre thread : on se rattache à l'interaction.
+        const trace::Scope scope(interaction.context());
+        if (error.empty())
+            co_return;
+
+        interaction.fail(error);
+        std::cerr << "[CMD] Exception dans '/alliance " << self->subcommand_name() << "': "
+                  << error << "\n";
+        dpp::message msg("Erreur interne lors de l'exécution de la commande ❌");
+        msg.set_flags(dpp::m_ephemeral);
+        deferral::reply(event, msg);
+    }
+};
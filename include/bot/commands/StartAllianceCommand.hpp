@@ -1,13 +1,16 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
 #include <dpp/dpp.h>
 
-#include "bot/commands/ISlashCommand.hpp"
+#include "bot/commands/ICoroSlashCommand.hpp"
 
 namespace odb { namespace pgsql { class database; } }
 
-class StartAllianceCommand : public ISlashCommand {
+class StartAllianceCommand : public ICoroSlashCommand {
 public:
     std::string subcommand_name() const override {
         return "demarrer";
@@ -17,6 +20,17 @@ public:
         return "Démarrer une alliance (rôles & salons vocaux)";
     }
 
-    void handle(const dpp::slashcommand_t& event,
-                const std::shared_ptr<odb::pgsql::database>& db) const override;
+    dpp::task<void> co_handle(dpp::slashcommand_t event,
+                              std::shared_ptr<odb::pgsql::database> db) const override;
+
+    // Handler de l'événement d'outbox alliance_provision : crée rôles et
+    // salons, en réutilisant ceux d'une exécution précédente.
+    static void provision(dpp::cluster* cluster,
+                          const std::shared_ptr<odb::pgsql::database>& db,
+                          std::uint64_t alliance_id,
+                          std::function<void(bool ok, const std::string& error)> done);
+
+    // Événement alliance_provision abandonné par l'outbox : la progression
+    // n'a plus personne à qui être envoyée.
+    static void provision_abandoned(std::uint64_t alliance_id);
 };
@@ -3,10 +3,12 @@
 #include <memory>
 #include <dpp/dpp.h>
 
-#include "bot/ui/IModalUI.hpp"
+#include "bot/ui/ICoroModalUI.hpp"
 
 namespace odb { namespace pgsql { class database; } }
 
+class TimeZone;
+
 static void create_or_update_alliance_roster_message(
     dpp::cluster* cluster,
     const std::shared_ptr<odb::pgsql::database>& db,
@@ -14,12 +16,12 @@ static void create_or_update_alliance_roster_message(
     dpp::snowflake thread_id
 );
 
-class CreateAllianceUI : public IModalUI {
+class CreateAllianceUI : public ICoroModalUI {
 public:
-    static void open_modal(const dpp::slashcommand_t& event);
+    static dpp::task<void> open_modal(dpp::slashcommand_t event, const TimeZone& zone);
 
-    bool handle_modal(const dpp::form_submit_t& event,
-                      const std::shared_ptr<odb::pgsql::database>& db) const override;
+    dpp::task<void> co_handle_modal(dpp::form_submit_t event,
+                                    std::shared_ptr<odb::pgsql::database> db) const override;
 
     static bool handle_select(const dpp::select_click_t& event,
                               const std::shared_ptr<odb::pgsql::database>& db);
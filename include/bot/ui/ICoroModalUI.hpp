@@ -0,0 +1,53 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <dpp/dpp.h>
+
+#include "bot/InteractionTrace.hpp"
+#include "bot/ui/IModalUI.hpp"
+
+#ifndef DPP_CORO
+#error "ICoroModalUI nécessite DPP avec le support des coroutines (DPP_CORO)."
+#endif
+
+namespace odb { namespace pgsql { class database; } }
+
+// Variante coroutine de IModalUI (cf. ICoroSlashCommand). Le routage se fait
+// sur le custom_id avant l'appel : handle_modal considère le modal comme traité.
+class ICoroModalUI : public IModalUI {
+public:
+    bool handle_modal(const dpp::form_submit_t& event,
+                      const std::shared_ptr<odb::pgsql::database>& db) const final
+    {
+        spawn(this, event, db, interaction_trace::take());
+        return true;
+    }
+
+    virtual dpp::task<void> co_handle_modal(dpp::form_submit_t event,
+                                            std::shared_ptr<odb::pgsql::database> db) const = 0;
+
+private:
+    static dpp::job spawn(const ICoroModalUI* self,
+                          dpp::form_submit_t event,
+                          std::shared_ptr<odb::pgsql::database> db,
+                          interaction_trace::Handle interaction)
+    {
+        std::string error;
+        try {
+            co_await self->co_handle_modal(event, db);
+        } catch (const std::exception& ex) {
+            error = ex.what();
+        }
+
+        const trace::Scope scope(interaction.context());
+        if (error.empty())
+            co_return;
+
+        interaction.fail(error);
+        std::cerr << "[UI] Exception dans le modal '" << event.custom_id << "': " << error << "\n";
+        self->reply_ephemeral(event, "Erreur interne lors du traitement du formulaire ❌");
+    }
+};
@@ -5,6 +5,8 @@
 
 #include <dpp/dpp.h>
 
+#include "bot/Deferral.hpp"
+
 namespace odb { namespace pgsql { class database; } }
 
 class IModalUI {
@@ -48,6 +50,6 @@ protected:
     {
         dpp::message m(message);
         m.set_flags(dpp::m_ephemeral);
-        event.reply(m);
+        deferral::reply(event, m);
     }
 };
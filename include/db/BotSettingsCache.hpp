@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace odb { namespace pgsql {
+    class database;
+}}
+
+class BotSettings;
+class TimeZone;
+
+// Cache mémoire des BotSettings par serveur.
+// Les réglages ne changent que via SetupUI, qui met le cache à jour après commit :
+// les autres handlers évitent ainsi un aller-retour DB.
+namespace bot_settings_cache {
+
+struct Stats {
+    std::uint64_t hits    = 0;
+    std::uint64_t misses  = 0;
+    std::size_t   entries = 0;
+};
+
+// Réglages du serveur, ou nullptr s'il n'est pas configuré (résultat négatif aussi mis en cache).
+// En cas de miss, lit la base dans la transaction courante s'il y en a une, sinon dans une transaction dédiée.
+std::shared_ptr<const BotSettings> get(odb::pgsql::database& db, std::uint64_t guild_id);
+
+// Fuseau du serveur (BotSettings::timezone), fuseau par défaut s'il n'est pas
+// configuré ou si le nom est inconnu. Sans verrou une fois résolu.
+const TimeZone& zone(odb::pgsql::database& db, std::uint64_t guild_id);
+
+// À appeler après le commit d'une écriture.
+void put(const BotSettings& settings);
+void invalidate(std::uint64_t guild_id);
+
+Stats stats();
+
+} // namespace bot_settings_cache
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include <odb/pgsql/connection-factory.hxx>
+
+struct DbPoolStats {
+    std::size_t in_use  = 0;
+    std::size_t idle    = 0;
+    std::size_t waiting = 0;
+
+    std::uint64_t acquisitions       = 0;
+    std::uint64_t waits              = 0; // acquisitions ayant attendu une connexion libre
+    std::uint64_t total_wait_us      = 0;
+    std::uint64_t total_acquire_us   = 0;
+    std::uint64_t max_acquire_us     = 0;
+    std::uint64_t created            = 0;
+    std::uint64_t reaped             = 0;
+    std::uint64_t validation_failures = 0;
+};
+
+// Pool ODB instrumenté : préchauffage, validation des connexions,
+// libération des connexions inactives au-delà du minimum.
+//
+// On s'appuie sur connection_pool_factory (min = 0 côté ODB pour que les
+// connexions rendues soient conservées) et c'est le reaper qui redescend
+// vers le minimum configuré après idle_timeout.
+class ConnectionPool : public odb::pgsql::connection_pool_factory {
+public:
+    ConnectionPool(std::size_t min_connections,
+                   std::size_t max_connections,
+                   std::chrono::seconds idle_timeout,
+                   bool validate);
+
+    ~ConnectionPool() override;
+
+    odb::pgsql::connection_ptr connect() override;
+
+    void database(database_type& db) override;
+
+    DbPoolStats stats();
+
+protected:
+    pooled_connection_ptr create() override;
+
+private:
+    void warm_up();
+    void reaper_loop();
+    void reap_idle();
+
+    const std::size_t          min_connections_;
+    const std::chrono::seconds idle_timeout_;
+    const bool                 validate_;
+
+    // Plus petit nombre de connexions inactives observé depuis le dernier passage du reaper
+    std::size_t idle_low_water_ = 0;
+
+    std::atomic<std::uint64_t> acquisitions_ {0};
+    std::atomic<std::uint64_t> waits_ {0};
+    std::atomic<std::uint64_t> total_wait_us_ {0};
+    std::atomic<std::uint64_t> total_acquire_us_ {0};
+    std::atomic<std::uint64_t> max_acquire_us_ {0};
+    std::atomic<std::uint64_t> created_ {0};
+    std::atomic<std::uint64_t> reaped_ {0};
+    std::atomic<std::uint64_t> validation_failures_ {0};
+
+    std::mutex              reaper_mutex_;
+    std::condition_variable reaper_cv_;
+    bool                    stopping_ = false;
+    std::thread             reaper_;
+};
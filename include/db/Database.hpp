@@ -3,6 +3,9 @@
 #include <memory>
 #include <string>
 #include <cstdint>
+#include <cstddef>
+
+#include "db/ConnectionPool.hpp"
 
 namespace odb { namespace pgsql {
     class database;
@@ -14,8 +17,20 @@ struct DbConfig {
     std::string password;
     std::string name;
     std::uint32_t port;
+
+    // Pool de connexions
+    std::size_t pool_min = 2;
+    std::size_t pool_max = 10;
+    std::uint32_t pool_idle_timeout = 300; // secondes, 0 = jamais libérées
+    bool pool_validate = true;
+
+    // Threads de db_executor qui exécutent les handlers (cf. DbExecutor.hpp)
+    std::size_t workers = 4;
 };
 
 DbConfig load_db_config_from_env();
 
 std::shared_ptr<odb::pgsql::database> make_database(const DbConfig& cfg);
+
+// Instantané des métriques du pool créé par make_database (vide si aucun pool).
+DbPoolStats db_pool_stats();
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Pool de threads dédié aux transactions ODB.
+// Les handlers DPP y déposent leur travail bloquant au lieu de l'exécuter sur
+// les threads du gateway : une requête Postgres lente ne retarde plus les
+// interactions des autres serveurs.
+//
+// Trois façons de soumettre :
+//   - post(job)            : fire-and-forget, le job répond lui-même à l'interaction ;
+//   - submit(work)         : std::future du résultat ;
+//   - co_await run(work)   : depuis une coroutine (dpp::task ou autre), reprise
+//                            sur le worker une fois le travail terminé.
+namespace db_executor {
+
+struct Stats {
+    std::size_t workers = 0;
+    std::size_t queued  = 0;
+    std::size_t running = 0;
+
+    std::uint64_t submitted = 0;
+    std::uint64_t completed = 0;
+    std::uint64_t failed    = 0; // jobs sortis sur une exception
+
+    std::uint64_t total_wait_us = 0; // temps passé dans la file
+    std::uint64_t max_wait_us   = 0;
+    std::uint64_t total_run_us  = 0;
+    std::uint64_t max_run_us    = 0;
+};
+
+// Démarre `workers` threads (0 : les jobs s'exécutent sur le thread appelant).
+void start(std::size_t workers);
+
+// Termine les jobs déjà en file puis arrête les workers.
+void stop();
+
+void post(std::function<void()> job);
+
+Stats stats();
+
+template <class F>
+auto submit(F&& work) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+    using R = std::invoke_result_t<std::decay_t<F>&>;
+
+    // std::function exige un objet copiable : la packaged_task est partagée.
+    auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(work));
+    std::future<R> fut = task->get_future();
+    post([task]() { (*task)(); });
+    return fut;
+}
+
+template <class R>
+class Awaitable {
+public:
+    explicit Awaitable(std::function<R()> work) : work_(std::move(work)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    // L'awaitable vit dans la frame de la coroutine tant qu'elle est suspendue.
+    void await_suspend(std::coroutine_handle<> handle) {
+        post([this, handle]() {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    work_();
+                } else {
+                    result_.emplace(work_());
+                }
+            } catch (...) {
+                error_ = std::current_exception();
+            }
+            handle.resume();
+        });
+    }
+
+    R await_resume() {
+        if (error_)
+            std::rethrow_exception(error_);
+        if constexpr (!std::is_void_v<R>)
+            return std::move(*result_);
+    }
+
+private:
+    using Slot = std::conditional_t<std::is_void_v<R>, bool, std::optional<R>>;
+
+    std::function<R()> work_;
+    Slot               result_ {};
+    std::exception_ptr error_;
+};
+
+template <class F>
+auto run(F&& work) -> Awaitable<std::invoke_result_t<std::decay_t<F>&>> {
+    using R = std::invoke_result_t<std::decay_t<F>&>;
+    return Awaitable<R>(std::function<R()>(std::forward<F>(work)));
+}
+
+} // namespace db_executor
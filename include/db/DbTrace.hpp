@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string_view>
+
+namespace odb {
+    class tracer;
+}
+
+// Spans des transactions ODB (BEGIN .. COMMIT/ROLLBACK) et de leurs requêtes,
+// rattachés au contexte de trace du thread (voir util/Trace.hpp).
+namespace db_trace {
+
+// À installer sur la base quand trace::enabled().
+odb::tracer& tracer();
+
+// Nomme la transaction en cours sur ce thread (appelé par tx_metrics::track).
+void label(std::string_view type);
+
+} // namespace db_trace
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace odb { namespace pgsql {
+    class database;
+}}
+
+// Migration SQL versionnée, appliquée une seule fois par base.
+// Les instructions doivent rester idempotentes (IF NOT EXISTS...) : une base
+// créée par create_schema() passe aussi par toutes les migrations.
+struct Migration {
+    int version;
+    std::string description;
+    std::vector<std::string> statements;
+};
+
+// Liste ordonnée des migrations connues du binaire.
+const std::vector<Migration>& all_migrations();
+
+// Applique les migrations manquantes, chacune dans sa propre transaction.
+// Retourne le nombre de migrations appliquées.
+int run_migrations(const std::shared_ptr<odb::pgsql::database>& db);
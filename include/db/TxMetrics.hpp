@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string_view>
+
+namespace odb {
+    class transaction;
+}
+
+// Durée des transactions ODB par type, exportée sur /metrics
+// (sot_db_transaction_duration_seconds{type, outcome}).
+namespace tx_metrics {
+
+// Juste après db->begin() : mesure jusqu'au commit ou au rollback,
+// via les callbacks de la transaction (aucune allocation).
+// type : nom stable du site, ex. "join.perform" (nomme aussi le span de trace).
+void track(odb::transaction& t, std::string_view type);
+
+} // namespace tx_metrics
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+#include <odb/core.hxx>
+
+// Inclusions relatives : ODB en dérive les *-odb.hxx, générés à plat dans generated/.
+#include "alliances.hxx"
+#include "alliance_discord_objects.hxx"
+
+// Objets Discord d'une alliance avec la guild et le statut de l'alliance
+// (la guild est nécessaire pour supprimer un rôle). Sert à la reprise de la
+// file de nettoyage (cleanup_queue::init) et à la réconciliation des objets
+// orphelins (reconciler).
+#pragma db view object(AllianceDiscordObject) \
+    object(Alliance: AllianceDiscordObject::alliance_id_ == Alliance::id_)
+struct PendingCleanupRow {
+    #pragma db column(AllianceDiscordObject::id_)
+    std::uint64_t object_id;
+
+    #pragma db column(AllianceDiscordObject::type_)
+    DiscordObjectType type;
+
+    #pragma db column(AllianceDiscordObject::discord_id_)
+    std::uint64_t discord_id;
+
+    #pragma db column(AllianceDiscordObject::cleanup_attempts_)
+    unsigned int attempts;
+
+    #pragma db column(AllianceDiscordObject::cleanup_at_)
+    std::time_t cleanup_at;
+
+    #pragma db column(Alliance::guild_id_)
+    std::uint64_t guild_id;
+
+    #pragma db column(Alliance::status_)
+    AllianceStatus alliance_status;
+};
@@ -33,7 +33,11 @@ public:
           name_(std::move(name)),
           auto_delete_(auto_delete),
           created_at_(std::time(nullptr)),
-          deleted_at_(0)
+          deleted_at_(0),
+          content_hash_(0),
+          cleanup_attempts_(0),
+          cleanup_at_(0),
+          page_(0)
     {}
 
     std::uint64_t id() const { return id_; }
@@ -57,6 +61,21 @@ public:
     std::time_t deleted_at() const { return deleted_at_; }
     void mark_deleted_now() { deleted_at_ = std::time(nullptr); }
 
+    // Hash du dernier contenu envoyé (messages uniquement), 0 = inconnu
+    std::uint64_t content_hash() const { return content_hash_; }
+    void content_hash(std::uint64_t h) { content_hash_ = h; }
+
+    // File de nettoyage : prochaine tentative de suppression (0 = pas planifiée)
+    std::time_t cleanup_at() const { return cleanup_at_; }
+    void cleanup_at(std::time_t t) { cleanup_at_ = t; }
+
+    unsigned int cleanup_attempts() const { return cleanup_attempts_; }
+    void cleanup_attempts(unsigned int n) { cleanup_attempts_ = n; }
+
+    // Rang du message de roster (0 = premier), quand la flotte tient sur plusieurs messages
+    unsigned int page() const { return page_; }
+    void page(unsigned int p) { page_ = p; }
+
 private:
     friend class odb::access;
 
@@ -72,4 +91,16 @@ private:
     bool        auto_delete_;
     std::time_t created_at_;
     std::time_t deleted_at_;
+
+    #pragma db default(0)
+    std::uint64_t content_hash_;
+
+    #pragma db default(0)
+    unsigned int cleanup_attempts_;
+
+    #pragma db default(0)
+    std::time_t cleanup_at_;
+
+    #pragma db default(0)
+    unsigned int page_;
 };
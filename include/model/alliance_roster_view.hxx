@@ -0,0 +1,26 @@
+#pragma once
+
+#include <odb/core.hxx>
+
+// Inclusions relatives : ODB en dérive les *-odb.hxx, générés à plat dans generated/.
+#include "alliances.hxx"
+#include "ships.hxx"
+#include "alliance_participants.hxx"
+
+// Une ligne par (bateau, participant actif) d'une alliance, en une seule requête.
+// Les jointures sont externes : une alliance sans bateau donne une ligne avec
+// ship == nullptr, un bateau sans équipage une ligne avec participant == nullptr.
+//
+// Les pointeurs sont bruts (pointeur par défaut des modèles) : l'appelant en
+// prend possession à chaque ligne, cf. alliance_helpers::fetch_alliance_roster.
+#pragma db view object(Alliance) \
+    object(Ship left: Ship::alliance_id_ == Alliance::id_) \
+    object(AllianceParticipant left: \
+        AllianceParticipant::ship_id_ == Ship::id_ && \
+        AllianceParticipant::alliance_id_ == Alliance::id_ && \
+        AllianceParticipant::left_at_ == 0)
+struct AllianceRosterRow {
+    Alliance* alliance = nullptr;
+    Ship* ship = nullptr;
+    AllianceParticipant* participant = nullptr;
+};
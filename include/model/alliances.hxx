@@ -37,6 +37,7 @@ public:
           right_hand_(),
           ships_reuse_planned_(false),
           thread_channel_id_(0),
+          wizard_nonce_(0),
           created_at_(std::time(nullptr)),
           updated_at_(std::time(nullptr))
     {}
@@ -70,6 +71,11 @@ public:
     std::uint64_t thread_channel_id() const { return thread_channel_id_; }
     void thread_channel_id(std::uint64_t id) { thread_channel_id_ = id; touch(); }
 
+    // Jeton de l'assistant /alliance creer qui a créé l'alliance (0 : aucun) ;
+    // unique par organisateur, il empêche une double création.
+    std::uint32_t wizard_nonce() const { return wizard_nonce_; }
+    void wizard_nonce(std::uint32_t n) { wizard_nonce_ = n; }
+
     std::time_t created_at() const { return created_at_; }
     std::time_t updated_at() const { return updated_at_; }
 
@@ -94,6 +100,7 @@ private:
     bool        ships_reuse_planned_;
 
     std::uint64_t thread_channel_id_;
+    std::uint32_t wizard_nonce_;
 
     std::time_t created_at_;
     std::time_t updated_at_;
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <ctime>
+
+#include <odb/core.hxx>
+
+enum class OutboxKind {
+    alliance_provision = 0, // rôles + salons de /demarrer
+    thread_rename      = 1, // préfixe du thread forum (payload = préfixe)
+    roster_refresh     = 2  // message de roster de l'alliance
+};
+
+#pragma db value(OutboxKind) type("smallint")
+
+enum class OutboxStatus {
+    pending     = 0,
+    done        = 1,
+    failed      = 2, // abandonné après trop de tentatives
+    in_progress = 3  // réservé par une instance jusqu'à locked_until
+};
+
+#pragma db value(OutboxStatus) type("smallint")
+
+// Effet Discord à appliquer, écrit dans la même transaction que le
+// changement d'état qui le déclenche ; cf. outbox::add.
+#pragma db object table("discord_outbox")
+class OutboxEvent {
+public:
+    OutboxEvent() = default;
+
+    OutboxEvent(std::string idempotency_key,
+                OutboxKind kind,
+                std::uint64_t guild_id,
+                std::uint64_t alliance_id,
+                std::uint64_t channel_id,
+                std::string payload)
+        : idempotency_key_(std::move(idempotency_key)),
+          kind_(kind),
+          status_(OutboxStatus::pending),
+          guild_id_(guild_id),
+          alliance_id_(alliance_id),
+          channel_id_(channel_id),
+          payload_(std::move(payload)),
+          attempts_(0),
+          created_at_(std::time(nullptr)),
+          next_attempt_at_(created_at_),
+          locked_until_(0),
+          done_at_(0)
+    {}
+
+    std::uint64_t id() const { return id_; }
+
+    const std::string& idempotency_key() const { return idempotency_key_; }
+
+    OutboxKind kind() const { return kind_; }
+
+    OutboxStatus status() const { return status_; }
+    void status(OutboxStatus s) { status_ = s; }
+
+    std::uint64_t guild_id() const { return guild_id_; }
+    std::uint64_t alliance_id() const { return alliance_id_; }
+    std::uint64_t channel_id() const { return channel_id_; }
+
+    const std::string& payload() const { return payload_; }
+
+    unsigned int attempts() const { return attempts_; }
+    void attempts(unsigned int n) { attempts_ = n; }
+
+    std::time_t created_at() const { return created_at_; }
+
+    std::time_t next_attempt_at() const { return next_attempt_at_; }
+    void next_attempt_at(std::time_t t) { next_attempt_at_ = t; }
+
+    std::time_t locked_until() const { return locked_until_; }
+    void locked_until(std::time_t t) { locked_until_ = t; }
+
+    std::time_t done_at() const { return done_at_; }
+    void done_at(std::time_t t) { done_at_ = t; }
+
+    const std::string& last_error() const { return last_error_; }
+    void last_error(const std::string& e) { last_error_ = e; }
+
+private:
+    friend class odb::access;
+
+    #pragma db id auto
+    std::uint64_t id_;
+
+    #pragma db unique
+    std::string idempotency_key_;
+
+    OutboxKind   kind_;
+    OutboxStatus status_;
+
+    std::uint64_t guild_id_;
+    std::uint64_t alliance_id_;
+    std::uint64_t channel_id_;
+    std::string   payload_;
+
+    unsigned int attempts_;
+    std::time_t  created_at_;
+    std::time_t  next_attempt_at_;
+    std::time_t  locked_until_;
+    std::time_t  done_at_;
+    std::string  last_error_;
+};
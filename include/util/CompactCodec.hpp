@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Encodage compact d'un état dans un custom_id Discord (100 caractères max) :
+// octets (varints LEB128) -> base85 (alphabet Z85), suivis d'un tag
+// SipHash-2-4 tronqué qui lie la charge utile à son préfixe et à un contexte
+// (guilde, utilisateur). Un id modifié ou rejoué ailleurs est refusé.
+namespace compact_codec {
+
+class Writer {
+public:
+    void u8(std::uint8_t v) { bytes_.push_back(static_cast<char>(v)); }
+    void varint(std::uint64_t v);
+    void str(std::string_view s); // longueur (varint) + octets
+
+    const std::string& bytes() const { return bytes_; }
+
+private:
+    std::string bytes_;
+};
+
+class Reader {
+public:
+    explicit Reader(std::string_view bytes) : bytes_(bytes) {}
+
+    bool u8(std::uint8_t& v);
+    bool varint(std::uint64_t& v);
+    bool str(std::string& s, std::size_t max_len);
+
+    bool done() const { return pos_ == bytes_.size(); }
+
+private:
+    std::string_view bytes_;
+    std::size_t pos_ = 0;
+};
+
+std::string base85_encode(std::string_view bytes);
+std::optional<std::string> base85_decode(std::string_view text);
+
+using Key = std::array<std::uint8_t, 16>;
+
+std::uint64_t siphash24(const Key& key, std::string_view data);
+
+// Clé de signature, dérivée d'un secret partagé par toutes les instances du bot.
+void set_secret(std::string_view secret);
+
+constexpr std::size_t CUSTOM_ID_MAX = 100;
+
+// prefix + base85(payload + tag) ; nullopt si le résultat dépasse max_len.
+std::optional<std::string> seal(std::string_view prefix,
+                                std::string_view context,
+                                std::string_view payload,
+                                std::size_t max_len = CUSTOM_ID_MAX);
+
+// Charge utile si l'id commence par prefix et que le tag est valide.
+std::optional<std::string> open(std::string_view custom_id,
+                                std::string_view prefix,
+                                std::string_view context);
+
+// Taille des ids scellés : l'état de l'assistant doit tenir dans CUSTOM_ID_MAX.
+struct Stats {
+    std::uint64_t sealed   = 0;
+    std::uint64_t too_long = 0; // refusés par seal(), état trop gros
+    std::size_t   last_len = 0;
+    std::size_t   max_len  = 0;
+};
+
+Stats stats();
+
+} // namespace compact_codec
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Métriques du processus au format Prometheus, servies sur GET /metrics.
+// Compteurs et histogrammes sont des atomiques : les enregistrer ne prend
+// aucun verrou. Les séries sont créées à la première demande puis jamais
+// détruites, et retrouvées sans verrou : les appelants fréquents gardent la référence.
+namespace metrics {
+
+enum class Type { counter, gauge, histogram };
+
+class Counter {
+public:
+    void add(std::uint64_t n = 1) noexcept { value_.fetch_add(n, std::memory_order_relaxed); }
+    std::uint64_t value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> value_ {0};
+};
+
+// Histogramme de durées à seaux fixes, de 1 ms à 10 s.
+class Histogram {
+public:
+    // Bornes supérieures des seaux, en microsecondes ; le dernier seau est +Inf.
+    static constexpr std::array<std::uint64_t, 13> BOUNDS_US = {
+        1'000, 2'500, 5'000, 10'000, 25'000, 50'000, 100'000,
+        250'000, 500'000, 1'000'000, 2'500'000, 5'000'000, 10'000'000
+    };
+
+    void observe_us(std::uint64_t us) noexcept;
+    void observe_since(std::chrono::steady_clock::time_point start) noexcept;
+
+    // Effectifs par seau (non cumulés) et somme, lus sans verrou.
+    std::uint64_t bucket(std::size_t i) const noexcept { return buckets_[i].load(std::memory_order_relaxed); }
+    std::uint64_t sum_us() const noexcept { return sum_us_.load(std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<std::uint64_t>, BOUNDS_US.size() + 1> buckets_ {};
+    std::atomic<std::uint64_t> sum_us_ {0};
+};
+
+// Paires nom/valeur, ex. {{"kind", "slash"}, {"route", "creer"}}.
+using Labels = std::initializer_list<std::pair<std::string_view, std::string_view>>;
+
+// Texte # HELP d'une famille (facultatif, une fois au démarrage).
+void describe(std::string_view family, std::string_view help);
+
+Counter&   counter(std::string_view family, Labels labels = {});
+Histogram& histogram(std::string_view family, Labels labels = {});
+
+// Valeur lue à l'export, pour les statistiques déjà tenues par un module
+// (db_executor::stats(), cleanup_queue::stats(), ...).
+void callback(std::string_view family, Type type, Labels labels, std::function<double()> read);
+
+// Toutes les séries au format d'exposition texte 0.0.4.
+std::string render();
+
+// Sert GET /metrics sur METRICS_PORT depuis un thread dédié (0 ou absent : désactivé).
+void start_server();
+
+} // namespace metrics
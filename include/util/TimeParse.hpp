@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <ctime>
+#include <string_view>
+
+class TimeZone;
+
+// Analyse des dates et heures saisies dans les modals, sans allocation ni
+// exception. La grammaire acceptée est exactement celle des anciennes
+// versions à base de std::stoi (blancs initiaux, signe, chiffres, suite
+// ignorée) : "7h30", "07:30", "7h", "15/11", "15/11/25", "2025-11-18".
+namespace time_parse {
+
+// "7h30", "7 h", "07:30", "7" -> heure et minutes (espaces ignorés partout).
+bool parse_hhmm(std::string_view input, int& hour, int& minute) noexcept;
+
+// "HH:MM" (espaces ignorés) ; les deux parties sont obligatoires.
+bool parse_clock(std::string_view input, int& hour, int& minute) noexcept;
+
+// "AAAA-MM-JJ" (mois 1-12, jour 1-31, sans contrôle du calendrier).
+bool parse_iso_date(std::string_view iso, int& year, int& month, int& day) noexcept;
+
+// "JJ/MM" (current_year), "JJ/MM/AA" ou "JJ/MM/AAAA" ; date réelle du calendrier.
+bool parse_french_date(std::string_view input, int current_year, int& year, int& month, int& day) noexcept;
+
+// "JJ/MM" ou "JJ/MM/AAAA" (1970-2100) appliqué sur base_tm.
+bool parse_date_ddmm(std::string_view input, const std::tm& base_tm, std::tm& out_tm) noexcept;
+
+// Date ISO + heure locale du fuseau -> time_t.
+bool make_time_t(std::string_view date_iso, std::string_view time_str,
+                 const TimeZone& zone, std::time_t& out) noexcept;
+
+// Écrit "HH:MM" dans out[0..5).
+void format_hhmm(int hour, int minute, char (&out)[6]) noexcept;
+
+// Écrit "AAAA-MM-JJ" (zéro final compris) ; renvoie le nombre de caractères.
+std::size_t format_iso_date(int year, int month, int day, char (&out)[20]) noexcept;
+
+} // namespace time_parse
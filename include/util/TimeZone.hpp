@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Fuseau horaire IANA lu dans les fichiers TZif de la base tzdata
+// (/usr/share/zoneinfo, ou $TZDIR), règle POSIX finale comprise.
+// Les conversions ne passent ni par TZ ni par localtime/mktime : elles sont
+// réentrantes et n'utilisent pas le verrou de fuseau de la libc.
+class TimeZone {
+public:
+    // Fuseau à décalage fixe (UTC, repli si la base tzdata est absente).
+    TimeZone(std::string name, int utc_offset);
+
+    // nullptr si le fichier est introuvable ou invalide.
+    static std::unique_ptr<TimeZone> load(const std::string& name);
+
+    const std::string& name() const { return name_; }
+
+    // Décalage UTC en secondes (positif à l'est) et heure d'été à l'instant t.
+    int offset_at(std::time_t t, bool* dst = nullptr) const;
+
+    // Heure locale (tm_wday, tm_yday et tm_isdst renseignés).
+    std::tm to_local(std::time_t t) const;
+
+    // Heure locale -> instant, champs normalisés comme mktime (32/01 -> 01/02).
+    // Heure inexistante (passage à l'heure d'été) : décalée d'autant ;
+    // heure ambiguë (retour à l'heure d'hiver) : première occurrence.
+    std::time_t from_local(const std::tm& local) const;
+    std::time_t from_local(int year, int month, int day, int hour, int minute, int second = 0) const;
+
+private:
+    // Date d'une règle POSIX : Jn, n ou Mm.w.d.
+    struct RuleDate {
+        enum class Kind { julian1, julian0, month_week_day } kind = Kind::julian0;
+        int month = 0;
+        int week  = 0;
+        int day   = 0; // jour julien, ou jour de la semaine pour Mm.w.d
+        int time  = 2 * 3600;
+    };
+
+    struct Rule {
+        int std_offset = 0;
+        int dst_offset = 0;
+        bool has_dst   = false;
+        RuleDate start;
+        RuleDate end;
+    };
+
+    struct Type {
+        int offset = 0;
+        bool dst   = false;
+    };
+
+    std::string name_;
+    std::vector<std::int64_t> transitions_;
+    std::vector<std::uint8_t> transition_types_;
+    std::vector<Type> types_;
+    Rule rule_;
+    bool has_rule_ = false;
+
+    static bool parse_rule(std::string_view spec, Rule& rule);
+    int rule_offset(std::time_t t, bool* dst) const;
+};
+
+namespace time_zone {
+
+// Jours depuis le 01/01/1970 (calendrier grégorien proleptique), et inverse.
+std::int64_t days_from_civil(std::int64_t y, int m, int d);
+void civil_from_days(std::int64_t days, std::int64_t& y, int& m, int& d);
+int days_in_month(std::int64_t y, int m);
+
+// Fuseau IANA ("Europe/Paris") chargé au premier appel puis servi sans verrou ;
+// nullptr si le nom est inconnu. Les fuseaux vivent jusqu'à la fin du processus.
+const TimeZone* locate(std::string_view name);
+
+// TZ de l'environnement, sinon Europe/Paris, sinon UTC.
+const TimeZone& default_zone();
+
+// Fuseau mémorisé pour un serveur (lecture sans verrou), nullptr si inconnu.
+// Renseigné par bot_settings_cache::zone, oublié quand les réglages changent.
+const TimeZone* for_guild(std::uint64_t guild_id);
+void remember_guild(std::uint64_t guild_id, const TimeZone* zone);
+void forget_guild(std::uint64_t guild_id);
+
+} // namespace time_zone
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Traces des interactions, exportées en lignes JSON au format OTLP
+// (une ExportTraceServiceRequest par ligne) dans TRACE_FILE ou vers TRACE_UDP.
+// Sans l'un ni l'autre, les spans sont inactifs et ne coûtent rien.
+//
+// Une interaction ouvre la trace (id de trace = id d'interaction) ; le
+// contexte courant, porté par le thread, est repris par db_executor, les
+// transactions ODB (db_trace) et rest_scheduler pour y rattacher leurs spans.
+namespace trace {
+
+struct Context {
+    std::uint64_t trace_hi = 0;
+    std::uint64_t trace_lo = 0;
+    std::uint64_t span_id  = 0;
+
+    bool valid() const { return span_id != 0; }
+};
+
+// Lit TRACE_FILE / TRACE_UDP et démarre l'export (une seule fois, au démarrage).
+void init();
+
+bool enabled();
+
+// Contexte du thread appelant (invalide hors de toute trace).
+Context current();
+
+// Remplace le contexte du thread le temps d'une portée.
+class Scope {
+public:
+    explicit Scope(const Context& ctx);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    Context previous_;
+};
+
+// Callback exécuté dans le contexte courant à l'appel de bind, quel que soit
+// le thread qui le rappelle (reprise d'une coroutine depuis un callback DPP).
+template <typename F>
+auto bind(F&& f) {
+    return [ctx = current(), f = std::forward<F>(f)](auto&&... args) mutable -> decltype(auto) {
+        const Scope scope(ctx);
+        return f(std::forward<decltype(args)>(args)...);
+    };
+}
+
+class Span {
+public:
+    enum class Kind { internal = 1, server = 2, client = 3 }; // valeurs OTLP
+
+    Span() noexcept; // inactif
+
+    // Enfant du contexte courant, ou racine d'une nouvelle trace.
+    explicit Span(std::string name, Kind kind = Kind::internal);
+    Span(std::string name, Kind kind, const Context& parent);
+
+    // Racine de la trace d'une interaction Discord.
+    static Span interaction(std::string name, std::uint64_t interaction_id);
+
+    Span(Span&&) noexcept;
+    Span& operator=(Span&&) noexcept;
+    ~Span();
+
+    bool active() const { return data_ != nullptr; }
+    Context context() const;
+
+    void name(std::string name);
+    void attr(std::string_view key, std::string_view value);
+    void attr(std::string_view key, std::int64_t value);
+    void error(std::string_view message);
+
+    // Termine et exporte le span ; sans effet ensuite.
+    void end();
+
+    struct Data; // défini dans Trace.cpp, manipulé par l'export
+
+private:
+    std::unique_ptr<Data> data_;
+};
+
+} // namespace trace
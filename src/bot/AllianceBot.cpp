@@ -1,6 +1,27 @@
 #include "bot/AllianceBot.hpp"
 
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "bot/AllianceHelpers.hpp"
+#include "bot/AllianceIndex.hpp"
+#include "bot/CleanupQueue.hpp"
+#include "bot/Deferral.hpp"
+#include "bot/InteractionTrace.hpp"
+#include "bot/Outbox.hpp"
+#include "bot/Reconciler.hpp"
+#include "bot/RestScheduler.hpp"
+#include "db/BotSettingsCache.hpp"
+#include "db/Database.hpp"
+#include "db/DbExecutor.hpp"
+#include "util/CompactCodec.hpp"
+#include "util/Metrics.hpp"
+#include "util/Trace.hpp"
+#include "util/env.hpp"
 
 #include "bot/commands/SetupCommand.hpp"
 #include "bot/commands/CreateAllianceCommand.hpp"
@@ -19,6 +40,87 @@
 #include "bot/ui/EditAllianceUI.hpp"
 #include "bot/ui/EndAllianceUI.hpp"
 
+namespace {
+
+// Handler sorti sur une exception, par sous-commande ou route de composant.
+metrics::Counter& interaction_errors(std::string_view kind, std::string_view route) {
+    return metrics::counter("sot_interaction_errors_total", {{"kind", kind}, {"route", route}});
+}
+
+// Séries créées d'avance : chaque route apparaît sur /metrics avant sa première interaction.
+void declare_interaction(std::string_view kind, std::string_view route) {
+    metrics::histogram("sot_interaction_duration_seconds", {{"kind", kind}, {"route", route}});
+    interaction_errors(kind, route);
+}
+
+// Racine de la trace d'une interaction, partagée avec le job posté sur l'exécuteur DB.
+std::shared_ptr<trace::Span> interaction_span(const dpp::interaction_create_t& event,
+                                              std::string_view kind, std::string_view route)
+{
+    auto span = std::make_shared<trace::Span>(trace::Span::interaction(
+        std::string(kind) + " " + std::string(route), static_cast<std::uint64_t>(event.command.id)
+    ));
+    if (span->active()) {
+        span->attr("discord.kind", kind);
+        span->attr("discord.route", route);
+        span->attr("discord.guild_id", std::to_string(event.command.guild_id));
+        span->attr("discord.user_id", std::to_string(event.command.usr.id));
+    }
+    return span;
+}
+
+// Handler de composant sorti sur une exception : l'erreur est tracée et
+// l'utilisateur reçoit un message, sinon l'interaction resterait sans
+// réponse (ou sur "réfléchit…") jusqu'à l'expiration du jeton.
+void fail_interaction(const dpp::interaction_create_t& event,
+                      trace::Span& span,
+                      std::string_view kind,
+                      std::string_view route,
+                      std::exception_ptr error)
+{
+    std::string what = "exception inconnue";
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& ex) {
+        what = ex.what();
+    } catch (...) {
+    }
+
+    span.error(what);
+    span.end();
+
+    std::cerr << "[UI] Exception dans " << kind << " '" << route << "': " << what << "\n";
+
+    dpp::message msg("Erreur interne lors du traitement de l'interaction ❌");
+    msg.set_flags(dpp::m_ephemeral);
+    deferral::reply(event, msg);
+}
+
+// custom_id sans handler, ou handler qui ne l'a pas traité : sans réponse,
+// Discord afficherait "Échec de l'interaction".
+void reply_unhandled(const dpp::interaction_create_t& event) {
+    dpp::message msg("Cette interaction n'est plus valide, relance la commande 🔁");
+    msg.set_flags(dpp::m_ephemeral);
+    deferral::reply(event, msg);
+}
+
+template <typename Event>
+void declare_router(const ComponentRouter<Event>& router, std::string_view kind) {
+    for (const std::string& key : router.keys())
+        declare_interaction(kind, key);
+
+    metrics::callback("sot_router_routes", metrics::Type::gauge, {{"router", kind}},
+                      [&router]() { return static_cast<double>(router.stats().routes); });
+    metrics::callback("sot_router_lookups_total", metrics::Type::counter, {{"router", kind}, {"result", "exact"}},
+                      [&router]() { return static_cast<double>(router.stats().exact_hits); });
+    metrics::callback("sot_router_lookups_total", metrics::Type::counter, {{"router", kind}, {"result", "prefix"}},
+                      [&router]() { return static_cast<double>(router.stats().prefix_hits); });
+    metrics::callback("sot_router_lookups_total", metrics::Type::counter, {{"router", kind}, {"result", "miss"}},
+                      [&router]() { return static_cast<double>(router.stats().misses); });
+}
+
+} // namespace
+
 AllianceBot::AllianceBot(const std::string& token,
                          std::shared_ptr<odb::pgsql::database> db)
     : bot_(token),
@@ -26,8 +128,17 @@ AllianceBot::AllianceBot(const std::string& token,
 {
     bot_.on_log(dpp::utility::cout_logger());
 
+    // Signature des états d'assistant portés par les custom_id : même secret sur toutes les instances.
+    compact_codec::set_secret(getenv_or("WIZARD_SECRET", token));
+
+    rest_scheduler::init(&bot_);
+    cleanup_queue::init(&bot_, db_);
+    reconciler::init(&bot_, db_);
+
     init_commands();
-    init_modals();
+    init_components();
+    init_outbox();
+    init_metrics();
     register_event_handlers();
 }
 
@@ -35,6 +146,137 @@ void AllianceBot::run() {
     bot_.start(dpp::st_wait);
 }
 
+void AllianceBot::init_outbox() {
+    outbox::register_handler(
+        OutboxKind::alliance_provision,
+        [](dpp::cluster* cluster, const std::shared_ptr<odb::pgsql::database>& db,
+           const OutboxEvent& ev, outbox::Done done)
+        {
+            StartAllianceCommand::provision(cluster, db, ev.alliance_id(), done);
+        },
+        [](const OutboxEvent& ev) {
+            StartAllianceCommand::provision_abandoned(ev.alliance_id());
+        }
+    );
+
+    outbox::register_handler(
+        OutboxKind::thread_rename,
+        [](dpp::cluster* cluster, const std::shared_ptr<odb::pgsql::database>&,
+           const OutboxEvent& ev, outbox::Done done)
+        {
+            alliance_helpers::rename_thread_with_prefix(
+                cluster, static_cast<dpp::snowflake>(ev.channel_id()), ev.payload(), done
+            );
+        }
+    );
+
+    // L'événement n'est soldé qu'une fois les pages envoyées à Discord,
+    // pas quand le rendu regroupé est simplement programmé.
+    outbox::register_handler(
+        OutboxKind::roster_refresh,
+        [](dpp::cluster* cluster, const std::shared_ptr<odb::pgsql::database>& db,
+           const OutboxEvent& ev, outbox::Done done)
+        {
+            alliance_helpers::create_or_update_alliance_roster_message(
+                cluster, db, ev.alliance_id(), static_cast<dpp::snowflake>(ev.channel_id()), done
+            );
+        }
+    );
+
+    outbox::init(&bot_, db_);
+}
+
+// Exporte sur /metrics (METRICS_PORT) les statistiques déjà tenues par chaque module.
+void AllianceBot::init_metrics() {
+    using metrics::Type;
+
+    auto gauge = [](std::string_view name, std::function<double()> read) {
+        metrics::callback(name, Type::gauge, {}, std::move(read));
+    };
+    auto counter = [](std::string_view name, std::function<double()> read) {
+        metrics::callback(name, Type::counter, {}, std::move(read));
+    };
+
+    metrics::describe("sot_interaction_duration_seconds", "Délai entre la réception d'une interaction et sa réponse");
+    metrics::describe("sot_interaction_errors_total", "Handlers sortis sur une exception");
+    metrics::describe("sot_interaction_deferred_total", "Interactions acquittées avant la réponse du handler");
+    metrics::describe("sot_interaction_late_total", "Réponses arrivées après le délai Discord de 3 s");
+    metrics::describe("sot_db_transaction_duration_seconds", "Durée des transactions ODB, du begin au commit ou rollback");
+    metrics::describe("sot_rest_request_duration_seconds", "Durée des appels REST Discord, file et reprises comprises");
+    metrics::describe("sot_rest_request_errors_total", "Appels REST Discord abandonnés en erreur");
+    metrics::describe("sot_cleanup_pending", "Suppressions d'objets Discord en attente");
+    metrics::describe("sot_wizard_state_bytes", "Taille du dernier custom_id portant l'état de l'assistant de création");
+
+    for (const auto& entry : commands_)
+        declare_interaction("slash", entry.first);
+    declare_router(buttons_, "button");
+    declare_router(selects_, "select");
+    declare_router(modals_, "modal");
+
+    gauge("sot_db_executor_workers", [] { return static_cast<double>(db_executor::stats().workers); });
+    gauge("sot_db_executor_queued",  [] { return static_cast<double>(db_executor::stats().queued); });
+    gauge("sot_db_executor_running", [] { return static_cast<double>(db_executor::stats().running); });
+    counter("sot_db_executor_submitted_total", [] { return static_cast<double>(db_executor::stats().submitted); });
+    counter("sot_db_executor_failed_total",    [] { return static_cast<double>(db_executor::stats().failed); });
+    counter("sot_db_executor_wait_seconds_total", [] { return db_executor::stats().total_wait_us / 1e6; });
+    counter("sot_db_executor_run_seconds_total",  [] { return db_executor::stats().total_run_us / 1e6; });
+
+    metrics::callback("sot_db_pool_connections", Type::gauge, {{"state", "in_use"}},
+                      [] { return static_cast<double>(db_pool_stats().in_use); });
+    metrics::callback("sot_db_pool_connections", Type::gauge, {{"state", "idle"}},
+                      [] { return static_cast<double>(db_pool_stats().idle); });
+    gauge("sot_db_pool_waiting", [] { return static_cast<double>(db_pool_stats().waiting); });
+    counter("sot_db_pool_acquisitions_total", [] { return static_cast<double>(db_pool_stats().acquisitions); });
+    counter("sot_db_pool_waits_total",        [] { return static_cast<double>(db_pool_stats().waits); });
+    counter("sot_db_pool_wait_seconds_total", [] { return db_pool_stats().total_wait_us / 1e6; });
+    counter("sot_db_pool_created_total",      [] { return static_cast<double>(db_pool_stats().created); });
+    counter("sot_db_pool_reaped_total",       [] { return static_cast<double>(db_pool_stats().reaped); });
+    counter("sot_db_pool_validation_failures_total",
+            [] { return static_cast<double>(db_pool_stats().validation_failures); });
+
+    gauge("sot_rest_queued",    [] { return static_cast<double>(rest_scheduler::stats().queued); });
+    gauge("sot_rest_in_flight", [] { return static_cast<double>(rest_scheduler::stats().in_flight); });
+    counter("sot_rest_retried_total",      [] { return static_cast<double>(rest_scheduler::stats().retried); });
+    counter("sot_rest_rate_limited_total", [] { return static_cast<double>(rest_scheduler::stats().rate_limited); });
+
+    metrics::callback("sot_cleanup_pending", Type::gauge, {{"state", "queued"}},
+                      [] { return static_cast<double>(cleanup_queue::stats().queued); });
+    metrics::callback("sot_cleanup_pending", Type::gauge, {{"state", "in_flight"}},
+                      [] { return static_cast<double>(cleanup_queue::stats().in_flight); });
+    counter("sot_cleanup_deleted_total",   [] { return static_cast<double>(cleanup_queue::stats().deleted); });
+    counter("sot_cleanup_retried_total",   [] { return static_cast<double>(cleanup_queue::stats().retried); });
+    counter("sot_cleanup_abandoned_total", [] { return static_cast<double>(cleanup_queue::stats().abandoned); });
+
+    gauge("sot_outbox_in_flight", [] { return static_cast<double>(outbox::stats().in_flight); });
+    counter("sot_outbox_dispatched_total", [] { return static_cast<double>(outbox::stats().dispatched); });
+    counter("sot_outbox_succeeded_total",  [] { return static_cast<double>(outbox::stats().succeeded); });
+    counter("sot_outbox_retried_total",    [] { return static_cast<double>(outbox::stats().retried); });
+    counter("sot_outbox_failed_total",     [] { return static_cast<double>(outbox::stats().failed); });
+
+    counter("sot_roster_requests_total",  [] { return static_cast<double>(alliance_helpers::roster_debounce_stats().requests); });
+    counter("sot_roster_renders_total",   [] { return static_cast<double>(alliance_helpers::roster_debounce_stats().renders); });
+    counter("sot_roster_coalesced_total", [] { return static_cast<double>(alliance_helpers::roster_debounce_stats().coalesced); });
+    counter("sot_roster_unchanged_total", [] { return static_cast<double>(alliance_helpers::roster_debounce_stats().unchanged); });
+
+    gauge("sot_settings_cache_entries", [] { return static_cast<double>(bot_settings_cache::stats().entries); });
+    metrics::callback("sot_settings_cache_lookups_total", Type::counter, {{"result", "hit"}},
+                      [] { return static_cast<double>(bot_settings_cache::stats().hits); });
+    metrics::callback("sot_settings_cache_lookups_total", Type::counter, {{"result", "miss"}},
+                      [] { return static_cast<double>(bot_settings_cache::stats().misses); });
+
+    gauge("sot_alliance_index_entries", [] { return static_cast<double>(alliance_index::stats().entries); });
+    metrics::callback("sot_alliance_index_lookups_total", Type::counter, {{"result", "hit"}},
+                      [] { return static_cast<double>(alliance_index::stats().hits); });
+    metrics::callback("sot_alliance_index_lookups_total", Type::counter, {{"result", "miss"}},
+                      [] { return static_cast<double>(alliance_index::stats().misses); });
+
+    gauge("sot_wizard_state_bytes",     [] { return static_cast<double>(compact_codec::stats().last_len); });
+    gauge("sot_wizard_state_max_bytes", [] { return static_cast<double>(compact_codec::stats().max_len); });
+    counter("sot_wizard_state_overflows_total", [] { return static_cast<double>(compact_codec::stats().too_long); });
+
+    metrics::start_server();
+}
+
 void AllianceBot::init_commands() {
     commands_.emplace("setup",  std::make_unique<SetupCommand>());
     commands_.emplace("creer", std::make_unique<CreateAllianceCommand>());
@@ -106,27 +348,68 @@ void AllianceBot::init_commands() {
 
 
 
-void AllianceBot::init_modals() {
-    {
-        auto ui = std::make_unique<SetupUI>();
-        setup_ui_ = ui.get();
-        modal_handlers_.emplace("setup_advanced_modal", std::move(ui));
-    }
+void AllianceBot::init_components() {
+    auto setup  = std::make_unique<SetupUI>();
+    auto create = std::make_unique<CreateAllianceUI>();
+    auto edit   = std::make_unique<EditAllianceUI>();
+    const SetupUI*          setup_ui  = setup.get();
+    const CreateAllianceUI* create_ui = create.get();
+    const EditAllianceUI*   edit_ui   = edit.get();
+    modal_uis_.push_back(std::move(setup));
+    modal_uis_.push_back(std::move(create));
+    modal_uis_.push_back(std::move(edit));
+
+    auto db = db_;
 
-    {
-        auto ui = std::make_unique<CreateAllianceUI>();
-        modal_handlers_.emplace("create_alliance_datetime_modal", std::move(ui));
+    // Boutons
+    for (const char* id : {"setup_channels", "setup_roles", "setup_advanced"}) {
+        buttons_.on(id, [setup_ui, db](const dpp::button_click_t& e) { return setup_ui->handle_button(e, db); });
+    }
+    // L'assistant de création porte son état dans le custom_id ("cw.<action>.<état>") :
+    // une route par action, pour des statistiques de report distinctes.
+    for (const char* prefix : {"cw.m.", "cw.f.", "cw.n.", "cw.t."}) {
+        buttons_.on_prefix(prefix, [db](const dpp::button_click_t& e) { return CreateAllianceUI::handle_button(e, db); });
+    }
+    for (const char* id : {"edit_alliance_schedule_button", "edit_alliance_fleet_button"}) {
+        buttons_.on(id, [db](const dpp::button_click_t& e) { return EditAllianceUI::handle_button(e, db); });
+    }
+    for (const char* id : {"end_alliance_confirm", "end_alliance_cancel"}) {
+        buttons_.on(id, [db](const dpp::button_click_t& e) { return EndAllianceUI::handle_button(e, db); });
+    }
+    for (const char* id : {"leave_alliance_confirm", "leave_alliance_cancel"}) {
+        buttons_.on(id, [db](const dpp::button_click_t& e) { return LeaveAllianceUI::handle_button(e, db); });
+    }
+    for (const char* id : {"cancel_alliance_confirm", "cancel_alliance_cancel"}) {
+        buttons_.on(id, [db](const dpp::button_click_t& e) { return CancelAllianceUI::handle_button(e, db); });
     }
 
-    {
-        auto ui = std::make_unique<CreateAllianceUI>();
-        modal_handlers_.emplace("create_alliance_ship_role_custom_modal", std::move(ui));
+    // Sélecteurs
+    for (const char* id : {"setup_channel_commands", "setup_channel_ping", "setup_channel_alliance_forum",
+                           "setup_channel_logs", "setup_role_organizer", "setup_role_notify"}) {
+        selects_.on(id, [setup_ui, db](const dpp::select_click_t& e) { return setup_ui->handle_select(e, db); });
+    }
+    for (const char* prefix : {"cw.d.", "cw.s.", "cw.v.", "cw.h.", "cw.r.", "cw.b.", "cw.p."}) {
+        selects_.on_prefix(prefix, [db](const dpp::select_click_t& e) { return CreateAllianceUI::handle_select(e, db); });
+    }
+    selects_.on("join_alliance_ship_select",
+                [db](const dpp::select_click_t& e) { return JoinAllianceUI::handle_select(e, db); });
+    for (const char* id : {"edit_alliance_choose_ship", "edit_alliance_reuse"}) {
+        selects_.on(id, [db](const dpp::select_click_t& e) { return EditAllianceUI::handle_select(e, db); });
+    }
+    for (const char* prefix : {"edit_alliance_ship_hull_", "edit_alliance_ship_role_"}) {
+        selects_.on_prefix(prefix, [db](const dpp::select_click_t& e) { return EditAllianceUI::handle_select(e, db); });
     }
 
-    {
-        auto ui = std::make_unique<EditAllianceUI>();
-        modal_handlers_.emplace("edit_alliance_sale_modal", std::move(ui));
+    // Modals
+    modals_.on("setup_advanced_modal",
+               [setup_ui, db](const dpp::form_submit_t& e) { return setup_ui->handle_modal(e, db); });
+    for (const char* prefix : {"cw.M.", "cw.R."}) {
+        modals_.on_prefix(prefix, [create_ui, db](const dpp::form_submit_t& e) { return create_ui->handle_modal(e, db); });
     }
+    modals_.on("edit_alliance_schedule_modal",
+               [edit_ui, db](const dpp::form_submit_t& e) { return edit_ui->handle_modal(e, db); });
+    modals_.on_prefix("edit_alliance_custom_ship_role_",
+                      [edit_ui, db](const dpp::form_submit_t& e) { return edit_ui->handle_modal(e, db); });
 }
 
 void AllianceBot::register_event_handlers() {
@@ -141,7 +424,7 @@ void AllianceBot::register_event_handlers() {
         if (cmd_data.options.empty()) {
             dpp::message msg("Sous-commande manquante 🤔\nEx : `/alliance create`");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
         const auto& sub = cmd_data.options[0];
@@ -151,67 +434,105 @@ void AllianceBot::register_event_handlers() {
         if (it == commands_.end()) {
             dpp::message msg("Sous-commande inconnue 🤔");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
-        try {
-            it->second->handle(event, db_);
-        } catch (const std::exception& ex) {
-            std::cerr << "[CMD] Exception dans '/alliance " << sub_name << "': "
-                      << ex.what() << "\n";
-            dpp::message msg("Erreur interne lors de l'exécution de la commande ❌");
-            msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
-        }
+        // Le handler (et ses transactions) tourne sur un worker DB, pas sur le gateway.
+        ISlashCommand* cmd = it->second.get();
+        auto span = interaction_span(event, "slash", sub_name);
+        const trace::Scope scope(span->context());
+
+        deferral::begin(event, "slash:" + sub_name);
+        db_executor::post([this, cmd, event, sub_name, span]() {
+            // Span terminé au retour du handler, sauf s'il est repris par une coroutine.
+            interaction_trace::Dispatch dispatch(span, &interaction_errors("slash", sub_name));
+            try {
+                cmd->handle(event, db_);
+            } catch (const std::exception& ex) {
+                interaction_errors("slash", sub_name).add();
+                span->error(ex.what());
+                std::cerr << "[CMD] Exception dans '/alliance " << sub_name << "': "
+                          << ex.what() << "\n";
+                dpp::message msg("Erreur interne lors de l'exécution de la commande ❌");
+                msg.set_flags(dpp::m_ephemeral);
+                deferral::reply(event, msg);
+            }
+        });
     });
 
     bot_.on_button_click([this](const dpp::button_click_t& event) {
-        if (setup_ui_ && setup_ui_->handle_button(event, db_)) {
-            return;
-        }
-        if (CreateAllianceUI::handle_button(event, db_)) {
-            return;
-        }
-        if (EditAllianceUI::handle_button(event, db_)) {
-            return;
-        }
-        if (EndAllianceUI::handle_button(event, db_)) {
-            return;
-        }
-        if (LeaveAllianceUI::handle_button(event, db_)) {
-            return;
-        }
-        if (CancelAllianceUI::handle_button(event, db_)) {
+        auto match = buttons_.route(event);
+        if (!match) {
+            reply_unhandled(event);
             return;
         }
+        const std::string route = match.key;
+
+        auto span = interaction_span(event, "button", route);
+        const trace::Scope scope(span->context());
+
+        deferral::begin(event, "button:" + route);
+        metrics::Counter* errors = &interaction_errors("button", route);
+        db_executor::post([this, match, event, route, errors, span]() {
+            interaction_trace::Dispatch dispatch(span, errors);
+            try {
+                if (!buttons_.dispatch(match, event))
+                    reply_unhandled(event);
+            } catch (...) {
+                errors->add();
+                fail_interaction(event, *span, "button", route, std::current_exception());
+            }
+        });
     });
 
     bot_.on_select_click([this](const dpp::select_click_t& event) {
-        if (setup_ui_ && setup_ui_->handle_select(event, db_)) {
-            return;
-        }
-        if (CreateAllianceUI::handle_select(event, db_)) {
-            return;
-        }
-        if (JoinAllianceUI::handle_select(event, db_)) {
-            return;
-        }
-        if (EditAllianceUI::handle_select(event, db_)) {
+        auto match = selects_.route(event);
+        if (!match) {
+            reply_unhandled(event);
             return;
         }
+        const std::string route = match.key;
+
+        auto span = interaction_span(event, "select", route);
+        const trace::Scope scope(span->context());
+
+        deferral::begin(event, "select:" + route);
+        metrics::Counter* errors = &interaction_errors("select", route);
+        db_executor::post([this, match, event, route, errors, span]() {
+            interaction_trace::Dispatch dispatch(span, errors);
+            try {
+                if (!selects_.dispatch(match, event))
+                    reply_unhandled(event);
+            } catch (...) {
+                errors->add();
+                fail_interaction(event, *span, "select", route, std::current_exception());
+            }
+        });
     });
 
     bot_.on_form_submit([this](const dpp::form_submit_t& event) {
-        const std::string& id = event.custom_id;
-
-        auto it = modal_handlers_.find(id);
-        if (it == modal_handlers_.end()) {
-            return;
-        }
-
-        if (it->second->handle_modal(event, db_)) {
+        auto match = modals_.route(event);
+        if (!match) {
+            reply_unhandled(event);
             return;
         }
+        const std::string route = match.key;
+
+        auto span = interaction_span(event, "modal", route);
+        const trace::Scope scope(span->context());
+
+        deferral::begin(event, "modal:" + route);
+        metrics::Counter* errors = &interaction_errors("modal", route);
+        db_executor::post([this, match, event, route, errors, span]() {
+            interaction_trace::Dispatch dispatch(span, errors);
+            try {
+                if (!modals_.dispatch(match, event))
+                    reply_unhandled(event);
+            } catch (...) {
+                errors->add();
+                fail_interaction(event, *span, "modal", route, std::current_exception());
+            }
+        });
     });
 }
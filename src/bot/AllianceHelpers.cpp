@@ -1,18 +1,29 @@
 #include "bot/AllianceHelpers.hpp"
+#include "bot/AllianceIndex.hpp"
+#include "bot/RestScheduler.hpp"
+#include "db/BotSettingsCache.hpp"
+#include "db/DbExecutor.hpp"
+#include "db/TxMetrics.hpp"
+#include "util/env.hpp"
+#include "util/TimeParse.hpp"
+#include "util/TimeZone.hpp"
 
-#include <sstream>
-#include <iomanip>
 #include <algorithm>
+#include <string_view>
 #include <iostream>
 #include <cctype>
 #include <ctime>
 #include <vector>
 #include <cstdlib>
 #include <cstdio>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 
 #include <odb/transaction.hxx>
 #include <odb/query.hxx>
+#include <odb/exceptions.hxx>
 
 namespace alliance_helpers {
 
@@ -34,197 +45,43 @@ std::string trim(const std::string& s) {
 
 bool parse_time_to_hhmm(const std::string& input, std::string& out)
 {
-    std::string s;
-    s.reserve(input.size());
-    for (char c : input) {
-        if (!std::isspace(static_cast<unsigned char>(c))) {
-            char lc = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
-            if (lc == 'h')
-                lc = ':'; // 7h30 -> 7:30, 7h -> 7:
-            s.push_back(lc);
-        }
-    }
-
-    if (s.empty())
+    int h = 0, m = 0;
+    if (!time_parse::parse_hhmm(input, h, m))
         return false;
 
-    int h = 0;
-    int m = 0;
-
-    auto pos = s.find(':');
-    if (pos == std::string::npos) {
-        // "7", "07" -> 7:00
-        for (char c : s) {
-            if (!std::isdigit(static_cast<unsigned char>(c))) {
-                return false;
-            }
-        }
-
-        try {
-            h = std::stoi(s);
-        } catch (...) {
-            return false;
-        }
-        m = 0;
-    } else {
-        std::string h_str = s.substr(0, pos);
-        std::string m_str;
-
-        if (pos + 1 < s.size()) {
-            m_str = s.substr(pos + 1);
-        } else {
-            m_str = "0"; // "7:" -> minutes = 0
-        }
-
-        if (h_str.empty())
-            return false;
-
-        try {
-            h = std::stoi(h_str);
-            m = std::stoi(m_str);
-        } catch (...) {
-            return false;
-        }
-    }
-
-    if (h < 0 || h > 23 || m < 0 || m > 59)
-        return false;
-
-    std::ostringstream oss;
-    oss << std::setw(2) << std::setfill('0') << h
-        << ":"
-        << std::setw(2) << std::setfill('0') << m;
-
-    out = oss.str();
+    char buf[6];
+    time_parse::format_hhmm(h, m, buf);
+    out.assign(buf, 5);
     return true;
 }
 
 bool parse_iso_date(const std::string& iso,
                     int& year, int& month, int& day)
 {
-    std::string s = trim(iso);
-    auto p1 = s.find('-');
-    if (p1 == std::string::npos) return false;
-    auto p2 = s.find('-', p1 + 1);
-    if (p2 == std::string::npos) return false;
-
-    try {
-        year  = std::stoi(s.substr(0, p1));
-        month = std::stoi(s.substr(p1 + 1, p2 - p1 - 1));
-        day   = std::stoi(s.substr(p2 + 1));
-    } catch (...) {
-        return false;
-    }
-
-    if (month < 1 || month > 12 ||
-        day   < 1 || day   > 31)
-        return false;
-
-    return true;
+    return time_parse::parse_iso_date(iso, year, month, day);
 }
 
 bool make_time_t(const std::string& date_iso,
                  const std::string& time_str,
+                 const TimeZone& zone,
                  std::time_t& out)
 {
-    int year = 0, month = 0, day = 0;
-    if (!parse_iso_date(date_iso, year, month, day))
-        return false;
-
-    std::string s;
-    s.reserve(time_str.size());
-    for (char c : time_str) {
-        if (!std::isspace(static_cast<unsigned char>(c))) {
-            s.push_back(c);
-        }
-    }
-    auto pos = s.find(':');
-    if (pos == std::string::npos)
-        return false;
-
-    int hour = 0, minute = 0;
-    try {
-        hour   = std::stoi(s.substr(0, pos));
-        minute = std::stoi(s.substr(pos + 1));
-    } catch (...) {
-        return false;
-    }
-
-    if (hour < 0 || hour > 23 || minute < 0 || minute > 59)
-        return false;
-
-    std::tm tm {};
-    tm.tm_year = year - 1900;
-    tm.tm_mon  = month - 1;
-    tm.tm_mday = day;
-    tm.tm_hour = hour;
-    tm.tm_min  = minute;
-    tm.tm_sec  = 0;
-
-    out = std::mktime(&tm);
-    return true;
+    return time_parse::make_time_t(date_iso, time_str, zone, out);
 }
 
 bool parse_french_date_to_iso(const std::string& input,
+                              const TimeZone& zone,
                               std::string& iso_out)
 {
-    std::string s = trim(input);
-    if (s.empty()) return false;
-
-    auto p1 = s.find('/');
-    if (p1 == std::string::npos) return false;
-    auto p2 = s.find('/', p1 + 1);
-
-    int day = 0, month = 0, year = 0;
-
-    try {
-        day = std::stoi(s.substr(0, p1));
-
-        if (p2 == std::string::npos) {
-            // JJ/MM -> année courante
-            month = std::stoi(s.substr(p1 + 1));
-            std::time_t now = std::time(nullptr);
-            std::tm tm_now {};
-#ifdef _WIN32
-            localtime_s(&tm_now, &now);
-#else
-            tm_now = *std::localtime(&now);
-#endif
-            year = tm_now.tm_year + 1900;
-        } else {
-            // JJ/MM/AAAA, JJ/MM/YY
-            month = std::stoi(s.substr(p1 + 1, p2 - p1 - 1));
-            std::string ystr = s.substr(p2 + 1);
-            year = std::stoi(ystr);
-            if (year < 100) {
-                year += 2000;
-            }
-        }
-    } catch (...) {
-        return false;
-    }
-
-    if (month < 1 || month > 12 || day < 1 || day > 31)
-        return false;
+    // JJ/MM -> année courante dans le fuseau du serveur
+    const int current_year = zone.to_local(std::time(nullptr)).tm_year + 1900;
 
-    std::tm tm {};
-    tm.tm_year = year - 1900;
-    tm.tm_mon  = month - 1;
-    tm.tm_mday = day;
-    tm.tm_hour = 12;
-    tm.tm_min  = 0;
-    tm.tm_sec  = 0;
-    std::time_t t = std::mktime(&tm);
-    if (t == -1)
-        return false;
-    if (tm.tm_year != year - 1900 ||
-        tm.tm_mon  != month - 1   ||
-        tm.tm_mday != day)
+    int year = 0, month = 0, day = 0;
+    if (!time_parse::parse_french_date(input, current_year, year, month, day))
         return false;
 
     char buf[20];
-    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d", year, month, day);
-    iso_out = buf;
+    iso_out.assign(buf, time_parse::format_iso_date(year, month, day, buf));
     return true;
 }
 
@@ -232,42 +89,7 @@ bool parse_date_ddmm(const std::string& input,
                      const std::tm& base_tm,
                      std::tm& out_tm)
 {
-    std::string s = trim(input);
-    if (s.empty())
-        return false;
-
-    int d = 0, m = 0, y = 0;
-
-    std::size_t p1 = s.find('/');
-    if (p1 == std::string::npos)
-        return false;
-
-    std::size_t p2 = s.find('/', p1 + 1);
-
-    try {
-        d = std::stoi(s.substr(0, p1));
-        if (p2 == std::string::npos) {
-            // dd/mm
-            m = std::stoi(s.substr(p1 + 1));
-            y = base_tm.tm_year + 1900;
-        } else {
-            // dd/mm/yyyy
-            m = std::stoi(s.substr(p1 + 1, p2 - (p1 + 1)));
-            y = std::stoi(s.substr(p2 + 1));
-        }
-    } catch (...) {
-        return false;
-    }
-
-    if (d <= 0 || d > 31 || m <= 0 || m > 12 || y < 1970 || y > 2100)
-        return false;
-
-    out_tm = base_tm;
-    out_tm.tm_mday = d;
-    out_tm.tm_mon  = m - 1;
-    out_tm.tm_year = y - 1900;
-
-    return true;
+    return time_parse::parse_date_ddmm(input, base_tm, out_tm);
 }
 
 std::string random_alliance_name() {
@@ -292,326 +114,600 @@ std::string random_alliance_name() {
     return names[std::rand() % names.size()];
 }
 
-
-std::string french_day_name(const std::tm& tm) {
-    static const char* days[] = {
-        "Dimanche", "Lundi", "Mardi", "Mercredi",
-        "Jeudi", "Vendredi", "Samedi"
-    };
-    int idx = tm.tm_wday;
-    if (idx < 0 || idx > 6) idx = 0;
-    return days[idx];
-}
-
-std::string format_hhmm(std::time_t t) {
-    std::tm tm {};
-#ifdef _WIN32
-    localtime_s(&tm, &t);
-#else
-    tm = *std::localtime(&t);
-#endif
-    std::ostringstream oss;
-    oss << tm.tm_hour << 'h'
-        << std::setw(2) << std::setfill('0') << tm.tm_min;
-    return oss.str();
-}
-
-std::string hull_label(HullType h) {
-    switch (h) {
-        case HullType::sloop:   return "Sloop";
-        case HullType::brig:    return "Brigantin";
-        case HullType::galleon: return "Galion";
+namespace {
+
+// Regroupement des éditions du message de roster : une édition par alliance et par fenêtre.
+// Un seul rendu par alliance à la fois : tant que ses appels REST ne sont pas
+// terminés (pages en cours de création), les demandes reçues sont regroupées
+// dans un rendu de suite, lancé à la fin du premier.
+struct PendingRoster {
+    dpp::snowflake thread_id;
+    std::uint64_t  coalesced = 0;
+    std::vector<RenderDone> waiters; // appelés à la fin du prochain rendu
+    bool scheduled = false;          // timer armé ou rendu posté, pas encore commencé
+    bool in_flight = false;          // rendu en cours, jusqu'à sa RenderCompletion
+    bool follow_up = false;          // demande reçue pendant le rendu en cours
+};
+
+std::mutex g_roster_mutex;
+std::unordered_map<std::uint64_t, PendingRoster> g_roster_pending;
+
+std::atomic<std::uint64_t> g_roster_requests {0};
+std::atomic<std::uint64_t> g_roster_renders {0};
+std::atomic<std::uint64_t> g_roster_coalesced {0};
+
+std::atomic<std::uint64_t> g_roster_unchanged {0};
+
+std::uint64_t fnv1a_64(const std::string& data) {
+    std::uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 1099511628211ULL;
     }
-    return "Brigantin";
+    return h;
 }
 
-int hull_capacity(HullType h) {
-    switch (h) {
-        case HullType::sloop:   return 2;
-        case HullType::brig:    return 3;
-        case HullType::galleon: return 4;
-    }
-    return 3;
+std::uint64_t roster_debounce_seconds() {
+    static const std::uint64_t value = []() -> std::uint64_t {
+        try {
+            return std::stoull(getenv_or("ROSTER_DEBOUNCE_SECONDS", "2"));
+        } catch (...) {
+            std::cerr << "Warning : ROSTER_DEBOUNCE_SECONDS invalide, utilisation de 2.\n";
+            return 2;
+        }
+    }();
+    return value;
 }
 
-AllianceRosterData load_alliance_roster_data(
-    const std::shared_ptr<odb::pgsql::database>& db,
-    std::uint64_t alliance_id
+bool fill_roster_from_view(
+    odb::pgsql::database& db,
+    const odb::query<AllianceRosterRow>& cond,
+    AllianceRosterData& out
 )
 {
-    using AllianceQuery = odb::query<Alliance>;
-    using ShipQuery     = odb::query<Ship>;
-    using PartQuery     = odb::query<AllianceParticipant>;
+    using RowQuery  = odb::query<AllianceRosterRow>;
+    using RowResult = odb::result<AllianceRosterRow>;
 
-    AllianceRosterData data;
+    RowQuery q(cond);
+    q += " ORDER BY " + RowQuery::Ship::slot;
+    q += ", " + RowQuery::Ship::id;
+    q += ", " + RowQuery::AllianceParticipant::joined_at;
 
-    odb::transaction t(db->begin());
+    RowResult res(db.query<AllianceRosterRow>(q));
 
-    {
-        std::unique_ptr<Alliance> a(db->load<Alliance>(alliance_id));
-        data.alliance = *a;
-    }
+    bool found = false;
+    std::uint64_t last_ship_id = 0;
 
-    {
-        using ShipResult = odb::result<Ship>;
-        ShipQuery q(ShipQuery::alliance_id == alliance_id);
-        ShipResult sres(
-            db->query<Ship>(q + " ORDER BY " + ShipQuery::slot)
-        );
+    for (auto it = res.begin(); it != res.end(); ++it) {
+        const AllianceRosterRow& row = *it;
 
-        for (const Ship& s : sres) {
-            data.ships.push_back(s);
+        // La vue alloue les objets à chaque ligne : on en prend possession tout de suite.
+        std::unique_ptr<Alliance> a(row.alliance);
+        std::unique_ptr<Ship> s(row.ship);
+        std::unique_ptr<AllianceParticipant> p(row.participant);
+
+        if (!a)
+            continue;
+
+        if (!found) {
+            out.alliance = *a;
+            found = true;
+        } else if (a->id() != out.alliance.id()) {
+            continue;
         }
-    }
 
-    {
-        using PartResult = odb::result<AllianceParticipant>;
-        PartResult pres(
-            db->query<AllianceParticipant>(
-                PartQuery::alliance_id == alliance_id &&
-                PartQuery::left_at == 0
-            )
-        );
+        if (!s)
+            continue;
+
+        // Lignes triées par bateau : un nouveau bateau n'apparaît qu'une fois.
+        if (s->id() != last_ship_id) {
+            out.ships.push_back(*s);
+            last_ship_id = s->id();
+        }
 
-        for (const AllianceParticipant& p : pres) {
-            data.by_ship[p.ship_id()].push_back(p);
+        if (p) {
+            out.by_ship[p->ship_id()].push_back(*p);
         }
     }
 
-    t.commit();
-    return data;
+    return found;
 }
 
-std::vector<dpp::embed> build_alliance_embeds(
-    const AllianceRosterData& data
+} // namespace
+
+bool fetch_alliance_roster(
+    odb::pgsql::database& db,
+    std::uint64_t alliance_id,
+    AllianceRosterData& out
 )
 {
-    const Alliance& alliance = data.alliance;
-    const auto& ships        = data.ships;
-    const auto& by_ship      = data.by_ship;
-
-    std::time_t scheduled_at = alliance.scheduled_at();
-    std::time_t sale_at      = alliance.sale_at();
-
-    std::tm tm_start {};
-#ifdef _WIN32
-    localtime_s(&tm_start, &scheduled_at);
-#else
-    tm_start = *std::localtime(&scheduled_at);
-#endif
-
-    std::string day_name  = french_day_name(tm_start);
-    std::string start_str = format_hhmm(scheduled_at);
-    std::string sale_str  = format_hhmm(sale_at);
-
-    int day   = tm_start.tm_mday;
-    int month = tm_start.tm_mon + 1;
+    using RowQuery = odb::query<AllianceRosterRow>;
+    return fill_roster_from_view(db, RowQuery::Alliance::id == alliance_id, out);
+}
 
-    std::time_t replace_at = scheduled_at + 30 * 60;
-    std::string replace_str = format_hhmm(replace_at);
+bool fetch_alliance_roster_by_thread(
+    odb::pgsql::database& db,
+    std::uint64_t guild_id,
+    std::uint64_t thread_channel_id,
+    AllianceRosterData& out
+)
+{
+    auto entry = alliance_index::resolve(db, guild_id, thread_channel_id);
+    if (!entry)
+        return false;
 
-    std::time_t rdv1 = sale_at - 30 * 60;
-    std::time_t rdv2 = sale_at - 15 * 60;
-    std::string rdv1_str = format_hhmm(rdv1);
-    std::string rdv2_str = format_hhmm(rdv2);
+    return fetch_alliance_roster(db, entry->alliance_id, out);
+}
 
-    std::vector<dpp::embed> embeds;
+AllianceRosterData load_alliance_roster_data(
+    const std::shared_ptr<odb::pgsql::database>& db,
+    std::uint64_t alliance_id
+)
+{
+    AllianceRosterData data;
 
-    dpp::embed e;
-    e.set_color(ALLIANCE_GOLD_COLOR);
-    e.set_title("🏴‍☠️ Alliance programmée");
+    odb::transaction t(db->begin());
+    tx_metrics::track(t, "roster.load");
+    bool found = fetch_alliance_roster(*db, alliance_id, data);
+    t.commit();
 
-    {
-        std::ostringstream desc;
-        desc << "\n";
-        desc << "**Alliance** : **" << alliance.name() << "**\n"
-             << "**Jour/heure** : *" << day_name << " "
-             << std::setw(2) << std::setfill('0') << day
-             << "/"
-             << std::setw(2) << std::setfill('0') << month
-             << "* de " << start_str << " à " << sale_str << "\n";
+    if (!found) {
+        throw odb::object_not_persistent();
+    }
 
-        std::string organizer_mention =
-            "<@" + std::to_string(alliance.organizer_id()) + ">";
+    return data;
+}
 
-        desc << "**Organisateur** : " << organizer_mention << "\n";
+namespace {
 
-        const std::string& bras_droit = alliance.right_hand();
-        desc << "**Bras droit** : "
-             << (bras_droit.empty() ? "_non défini_" : bras_droit) << "\n";
+// Fin d'un rendu : chaque appel REST (édition, chaîne de créations,
+// suppression) en décompte un ; done est appelé une fois, au dernier,
+// avec la première erreur rencontrée.
+struct RenderCompletion {
+    std::mutex  mutex;
+    std::size_t remaining = 1; // le rendu lui-même, libéré après l'envoi des requêtes
+    std::string error;
+    RenderDone  done;
 
-        desc << "**Reprise des bateaux** : "
-             << (alliance.ships_reuse_planned() ? "✅ Prévu" : "❌ Non prévu") << "\n";
+    void add() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++remaining;
+    }
 
-        e.set_description(desc.str());
+    void complete(const std::string& err = {}) {
+        RenderDone cb;
+        std::string first_error;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!err.empty() && error.empty())
+                error = err;
+            if (--remaining != 0)
+                return;
+            cb = std::move(done);
+            first_error = error;
+        }
+        if (cb)
+            cb(first_error.empty(), first_error);
     }
+};
+
+using RenderCompletionPtr = std::shared_ptr<RenderCompletion>;
+
+// Page de roster pas encore publiée.
+struct NewRosterPage {
+    unsigned int  page;
+    dpp::message  msg;
+    std::uint64_t hash;
+};
+
+dpp::message roster_page_message(dpp::snowflake thread_id, const RosterPage& embeds) {
+    dpp::message msg;
+    msg.channel_id = thread_id;
+    for (const auto& e : embeds) {
+        msg.add_embed(e);
+    }
+    return msg;
+}
 
-    {
-        std::ostringstream der;
-        der << "\n";
-        der << "- Début des try à **" << start_str
-            << "**, remplacement des retardataires à **" << replace_str << "**\n"
-            << "- RDV vers **" << rdv1_str << "-" << rdv2_str
-            << "** pour vendre à **" << sale_str << "**";
-
-        e.add_field("📜 Déroulement", der.str(), false);
+// Pages créées l'une après l'autre, pour qu'elles restent dans l'ordre dans le thread.
+// Au premier échec la chaîne s'arrête : le rendu suivant recréera les pages manquantes.
+void create_roster_pages(
+    dpp::cluster* cluster,
+    const std::shared_ptr<odb::pgsql::database>& db,
+    std::uint64_t alliance_id,
+    std::shared_ptr<std::vector<NewRosterPage>> pages,
+    std::size_t next,
+    RenderCompletionPtr completion
+)
+{
+    if (next >= pages->size()) {
+        completion->complete();
+        return;
     }
 
-    if (ships.empty()) {
-        e.add_field(
-            "🚢 FLOTTE",
-            "\n_Aucun bateau configuré pour cette alliance._",
-            false
-        );
-    } else {
-        e.add_field(
-            "🚢 FLOTTE",
-            "\u200b",
-            false
-        );
+    g_roster_renders.fetch_add(1, std::memory_order_relaxed);
+
+    rest_scheduler::message_create(
+        cluster,
+        (*pages)[next].msg,
+        rest_scheduler::Priority::interactive,
+        [cluster, db, alliance_id, pages, next, completion](const dpp::confirmation_callback_t& cb) {
+            if (cb.is_error()) {
+                std::cerr << "[Alliance] Erreur création message flotte (embed): "
+                          << cb.get_error().message << "\n";
+                completion->complete(cb.get_error().message);
+                return;
+            }
 
-        for (const Ship& ship : ships) {
-            std::string hull = hull_label(ship.hull_type());
-            std::string role = ship.crew_role().empty()
-                             ? "Libre"
-                             : ship.crew_role();
-
-            int cap = hull_capacity(ship.hull_type());
-
-            std::vector<AllianceParticipant> participants;
-            auto it = by_ship.find(ship.id());
-            if (it != by_ship.end()) {
-                participants = it->second;
-                std::sort(participants.begin(), participants.end(),
-                          [](const AllianceParticipant& a,
-                             const AllianceParticipant& b) {
-                              return a.joined_at() < b.joined_at();
-                          });
+            const NewRosterPage& page = (*pages)[next];
+            dpp::message created = cb.get<dpp::message>();
+
+            try {
+                odb::transaction t2(db->begin());
+                tx_metrics::track(t2, "roster.page_create");
+                AllianceDiscordObject msg_obj(
+                    alliance_id,
+                    DiscordObjectType::message,
+                    static_cast<std::uint64_t>(created.id),
+                    page.page == 0
+                        ? std::string("Message principal de l'alliance (embed)")
+                        : "Message de l'alliance (page " + std::to_string(page.page + 1) + ")",
+                    false
+                );
+                msg_obj.content_hash(page.hash);
+                msg_obj.page(page.page);
+                db->persist(msg_obj);
+                t2.commit();
+            } catch (const std::exception& ex) {
+                std::cerr << "[Alliance] Erreur DB enregistrement message flotte : "
+                          << ex.what() << "\n";
             }
 
-            std::ostringstream value;
-            int nb = static_cast<int>(participants.size());
+            create_roster_pages(cluster, db, alliance_id, pages, next + 1, completion);
+        }
+    );
+}
 
-            // Slots principaux
-            for (int i = 0; i < cap; ++i) {
-                if (i < nb) {
-                    value << "• <@" << participants[i].user_id() << ">\n";
-                } else {
-                    value << "• _dispo_\n";
-                }
+// Flotte réduite : les pages en trop sont supprimées du thread.
+void delete_roster_page(
+    dpp::cluster* cluster,
+    const std::shared_ptr<odb::pgsql::database>& db,
+    const AllianceDiscordObject& obj,
+    dpp::snowflake thread_id,
+    RenderCompletionPtr completion
+)
+{
+    const std::uint64_t obj_id = obj.id();
+    completion->add();
+
+    rest_scheduler::message_delete(
+        cluster,
+        static_cast<dpp::snowflake>(obj.discord_id()),
+        thread_id,
+        rest_scheduler::Priority::interactive,
+        [db, obj_id, completion](const dpp::confirmation_callback_t& cb) {
+            if (cb.is_error() && !rest_scheduler::is_not_found(cb)) {
+                std::cerr << "[Alliance] Erreur suppression page flotte : "
+                          << cb.get_error().message << "\n";
+                completion->complete(cb.get_error().message);
+                return;
             }
 
-            // Remplaçants : italique, plus discret, pas de ligne vide avant,
-            // pas de double saut de ligne entre bateaux.
-            if (nb > cap) {
-                value << "*Remplaçants :*\n";
-                for (int i = cap; i < nb; ++i) {
-                    value << "• <@" << participants[i].user_id() << ">\n";
+            try {
+                odb::transaction t2(db->begin());
+                tx_metrics::track(t2, "roster.page_delete");
+                std::unique_ptr<AllianceDiscordObject> o(db->find<AllianceDiscordObject>(obj_id));
+                if (o) {
+                    o->mark_deleted_now();
+                    db->update(*o);
                 }
-            } else {
-                value << "*Remplaçants :* _aucun_\n";
+                t2.commit();
+            } catch (const std::exception& ex) {
+                std::cerr << "[Alliance] Erreur DB suppression page flotte : "
+                          << ex.what() << "\n";
             }
 
-            std::ostringstream field_name;
-            field_name << hull << " - " << role
-                       << " [" << std::min(nb, cap) << "/" << cap << "]";
-
-            e.add_field(field_name.str(), value.str(), false);
+            completion->complete();
         }
-    }
-
-    embeds.push_back(e);
-    return embeds;
+    );
 }
 
-void create_or_update_alliance_roster_message(
+} // namespace
+
+void render_alliance_roster_message_now(
     dpp::cluster* cluster,
     const std::shared_ptr<odb::pgsql::database>& db,
     std::uint64_t alliance_id,
-    dpp::snowflake thread_id
+    dpp::snowflake thread_id,
+    RenderDone done
 )
 {
-    if (!cluster) return;
+    if (!cluster) {
+        if (done)
+            done(false, "cluster indisponible");
+        return;
+    }
 
     AllianceRosterData data = load_alliance_roster_data(db, alliance_id);
-    auto embeds = build_alliance_embeds(data);
+    const TimeZone& zone = bot_settings_cache::zone(*db, data.alliance.guild_id());
+    const std::vector<RosterPage> pages = build_alliance_roster_pages(data, zone);
 
     using ObjQuery  = odb::query<AllianceDiscordObject>;
     using ObjResult = odb::result<AllianceDiscordObject>;
 
-    std::unique_ptr<AllianceDiscordObject> roster_obj;
+    std::vector<AllianceDiscordObject> live;
 
     {
-        odb::transaction t(db->begin());
-        ObjResult r = db->query<AllianceDiscordObject>(
-            ObjQuery::alliance_id == alliance_id &&
-            ObjQuery::type == DiscordObjectType::message
-        );
+        ObjQuery q(ObjQuery::alliance_id == alliance_id &&
+                   ObjQuery::type == DiscordObjectType::message &&
+                   ObjQuery::deleted_at == 0);
+        q += " ORDER BY " + ObjQuery::page;
+        q += ", " + ObjQuery::id;
 
-        auto it = r.begin();
-        if (it != r.end()) {
-            roster_obj = std::make_unique<AllianceDiscordObject>(*it);
+        odb::transaction t(db->begin());
+        tx_metrics::track(t, "roster.pages");
+        ObjResult r = db->query<AllianceDiscordObject>(q);
+        for (auto it = r.begin(); it != r.end(); ++it) {
+            live.push_back(*it);
         }
         t.commit();
     }
 
-    if (!roster_obj) {
-        dpp::message msg;
-        msg.channel_id = thread_id;
-        msg.set_flags(0);
-        msg.embeds.clear();
-        for (auto& e : embeds) {
-            msg.add_embed(e);
+    // Message publié pour chaque page ; doublons et pages au-delà de la dernière à supprimer.
+    std::vector<const AllianceDiscordObject*> by_page(pages.size(), nullptr);
+    std::vector<const AllianceDiscordObject*> surplus;
+    for (const auto& obj : live) {
+        if (obj.page() < pages.size() && !by_page[obj.page()])
+            by_page[obj.page()] = &obj;
+        else
+            surplus.push_back(&obj);
+    }
+
+    auto completion = std::make_shared<RenderCompletion>();
+    completion->done = std::move(done);
+
+    auto to_create = std::make_shared<std::vector<NewRosterPage>>();
+
+    for (std::size_t p = 0; p < pages.size(); ++p) {
+        dpp::message msg = roster_page_message(thread_id, pages[p]);
+        const std::uint64_t hash = fnv1a_64(msg.build_json());
+        const AllianceDiscordObject* obj = by_page[p];
+
+        if (!obj) {
+            msg.set_flags(0);
+            to_create->push_back(NewRosterPage{static_cast<unsigned int>(p), std::move(msg), hash});
+            continue;
+        }
+
+        const std::uint64_t obj_id = obj->id();
+
+        // Rien de visible n'a changé sur cette page depuis la dernière édition réussie : pas d'appel REST.
+        // Le hash est celui persisté avec la page (relu à chaque rendu, aucun cache en mémoire).
+        if (obj->content_hash() == hash) {
+            g_roster_unchanged.fetch_add(1, std::memory_order_relaxed);
+            continue;
         }
 
-        cluster->message_create(
+        msg.id = static_cast<dpp::snowflake>(obj->discord_id());
+        g_roster_renders.fetch_add(1, std::memory_order_relaxed);
+        completion->add();
+
+        rest_scheduler::message_edit(
+            cluster,
             msg,
-            [db, alliance_id](const dpp::confirmation_callback_t& cb) {
+            rest_scheduler::Priority::interactive,
+            [db, obj_id, hash, completion](const dpp::confirmation_callback_t& cb) {
                 if (cb.is_error()) {
-                    std::cerr << "[Alliance] Erreur création message flotte (embed): "
+                    std::cerr << "[Alliance] Erreur édition message flotte (embed): "
                               << cb.get_error().message << "\n";
+                    completion->complete(cb.get_error().message);
                     return;
                 }
 
-                dpp::message created = cb.get<dpp::message>();
-                dpp::snowflake msg_id = created.id;
-
                 try {
                     odb::transaction t2(db->begin());
-                    AllianceDiscordObject msg_obj(
-                        alliance_id,
-                        DiscordObjectType::message,
-                        static_cast<std::uint64_t>(msg_id),
-                        "Message principal de l'alliance (embed)",
-                        false
+                    tx_metrics::track(t2, "roster.page_hash");
+                    std::unique_ptr<AllianceDiscordObject> o(
+                        db->find<AllianceDiscordObject>(obj_id)
                     );
-                    db->persist(msg_obj);
+                    if (o) {
+                        o->content_hash(hash);
+                        db->update(*o);
+                    }
                     t2.commit();
                 } catch (const std::exception& ex) {
-                    std::cerr << "[Alliance] Erreur DB enregistrement message flotte : "
+                    std::cerr << "[Alliance] Erreur DB enregistrement hash flotte : "
                               << ex.what() << "\n";
                 }
+
+                completion->complete();
             }
         );
-    } else {
-        dpp::message msg;
-        msg.id         = static_cast<dpp::snowflake>(roster_obj->discord_id());
-        msg.channel_id = thread_id;
-        msg.embeds.clear();
-        for (auto& e : embeds) {
-            msg.add_embed(e);
+    }
+
+    for (const AllianceDiscordObject* obj : surplus) {
+        delete_roster_page(cluster, db, *obj, thread_id, completion);
+    }
+
+    // La chaîne de créations libère la part du rendu lui-même quand elle se termine.
+    create_roster_pages(cluster, db, alliance_id, to_create, 0, completion);
+}
+
+namespace {
+
+void start_roster_render(dpp::cluster* cluster,
+                         const std::shared_ptr<odb::pgsql::database>& db,
+                         std::uint64_t alliance_id);
+
+// Fin du rendu en cours : les demandes reçues entre-temps partent en un seul rendu.
+void finish_roster_render(dpp::cluster* cluster,
+                          const std::shared_ptr<odb::pgsql::database>& db,
+                          std::uint64_t alliance_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_roster_mutex);
+        auto it = g_roster_pending.find(alliance_id);
+        if (it == g_roster_pending.end())
+            return;
+
+        PendingRoster& pending = it->second;
+        pending.in_flight = false;
+
+        if (!pending.follow_up && pending.waiters.empty()) {
+            g_roster_pending.erase(it);
+            return;
         }
 
-        cluster->message_edit(
-            msg,
-            [](const dpp::confirmation_callback_t& cb) {
-                if (cb.is_error()) {
-                    std::cerr << "[Alliance] Erreur édition message flotte (embed): "
-                              << cb.get_error().message << "\n";
+        pending.follow_up = false;
+        pending.scheduled = true;
+    }
+
+    db_executor::post([cluster, db, alliance_id]() { start_roster_render(cluster, db, alliance_id); });
+}
+
+// Sur le pool DB : le rendu ouvre des transactions ODB.
+void start_roster_render(dpp::cluster* cluster,
+                         const std::shared_ptr<odb::pgsql::database>& db,
+                         std::uint64_t alliance_id)
+{
+    PendingRoster pending;
+    {
+        std::lock_guard<std::mutex> lock(g_roster_mutex);
+        auto it = g_roster_pending.find(alliance_id);
+        if (it == g_roster_pending.end())
+            return;
+
+        pending.thread_id = it->second.thread_id;
+        pending.coalesced = it->second.coalesced;
+        pending.waiters   = std::move(it->second.waiters);
+
+        it->second.waiters.clear();
+        it->second.coalesced = 0;
+        it->second.scheduled = false;
+        it->second.in_flight = true;
+    }
+
+    if (pending.coalesced > 0) {
+        g_roster_coalesced.fetch_add(pending.coalesced, std::memory_order_relaxed);
+        std::cout << "[Alliance] Roster " << alliance_id << " : "
+                  << (pending.coalesced + 1) << " modifications regroupées en 1 édition\n";
+    }
+
+    auto waiters = std::make_shared<std::vector<RenderDone>>(std::move(pending.waiters));
+    RenderDone done_all = [cluster, db, alliance_id, waiters](bool ok, const std::string& error) {
+        for (auto& w : *waiters)
+            w(ok, error);
+        finish_roster_render(cluster, db, alliance_id);
+    };
+
+    try {
+        render_alliance_roster_message_now(cluster, db, alliance_id, pending.thread_id, done_all);
+    } catch (const std::exception& ex) {
+        std::cerr << "[Alliance] Erreur rendu roster différé : " << ex.what() << "\n";
+        done_all(false, ex.what());
+    }
+}
+
+} // namespace
+
+void create_or_update_alliance_roster_message(
+    dpp::cluster* cluster,
+    const std::shared_ptr<odb::pgsql::database>& db,
+    std::uint64_t alliance_id,
+    dpp::snowflake thread_id,
+    RenderDone done
+)
+{
+    if (!cluster) {
+        if (done)
+            done(false, "cluster indisponible");
+        return;
+    }
+
+    g_roster_requests.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(g_roster_mutex);
+        PendingRoster& pending = g_roster_pending[alliance_id];
+        pending.thread_id = thread_id;
+        if (done)
+            pending.waiters.push_back(std::move(done));
+
+        if (pending.scheduled || pending.in_flight) {
+            // Un rendu est déjà programmé ou en cours : le suivant lira l'état le plus récent.
+            pending.coalesced++;
+            if (pending.in_flight)
+                pending.follow_up = true;
+            return;
+        }
+
+        pending.scheduled = true;
+    }
+
+    const std::uint64_t window = roster_debounce_seconds();
+    if (window == 0) {
+        db_executor::post([cluster, db, alliance_id]() { start_roster_render(cluster, db, alliance_id); });
+        return;
+    }
+
+    cluster->start_timer(
+        [cluster, db, alliance_id](dpp::timer h) {
+            cluster->stop_timer(h);
+            db_executor::post([cluster, db, alliance_id]() { start_roster_render(cluster, db, alliance_id); });
+        },
+        window
+    );
+}
+
+void rename_thread_with_prefix(
+    dpp::cluster* cluster,
+    dpp::snowflake thread_id,
+    const std::string& prefix,
+    std::function<void(bool ok, const std::string& error)> done
+)
+{
+    cluster->channel_get(
+        thread_id,
+        [cluster, prefix, done](const dpp::confirmation_callback_t& cb) {
+            if (cb.is_error()) {
+                // Thread supprimé à la main : plus rien à renommer.
+                if (rest_scheduler::is_not_found(cb)) {
+                    done(true, {});
+                    return;
                 }
+                done(false, cb.get_error().message);
+                return;
             }
-        );
-    }
+
+            dpp::channel ch = cb.get<dpp::channel>();
+            if (ch.name.compare(0, prefix.size(), prefix) == 0) {
+                done(true, {});
+                return;
+            }
+
+            ch.set_name(prefix + ch.name);
+
+            cluster->channel_edit(
+                ch,
+                [done](const dpp::confirmation_callback_t& cb2) {
+                    if (cb2.is_error()) {
+                        done(false, cb2.get_error().message);
+                        return;
+                    }
+                    done(true, {});
+                }
+            );
+        }
+    );
+}
+
+RosterDebounceStats roster_debounce_stats() {
+    RosterDebounceStats st;
+    st.requests  = g_roster_requests.load(std::memory_order_relaxed);
+    st.renders   = g_roster_renders.load(std::memory_order_relaxed);
+    st.coalesced = g_roster_coalesced.load(std::memory_order_relaxed);
+    st.unchanged = g_roster_unchanged.load(std::memory_order_relaxed);
+    return st;
 }
 
 } // namespace alliance_helpers
@@ -0,0 +1,181 @@
+#include "bot/AllianceIndex.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <odb/pgsql/database.hxx>
+#include <odb/transaction.hxx>
+#include <odb/query.hxx>
+
+#include "alliances-odb.hxx"
+
+#include "db/TxMetrics.hpp"
+
+namespace alliance_index {
+
+namespace {
+
+std::shared_mutex g_mutex;
+std::unordered_map<std::uint64_t, Entry> g_by_thread;
+
+std::atomic<std::uint64_t> g_hits {0};
+std::atomic<std::uint64_t> g_misses {0};
+
+std::optional<Entry> query_db(odb::pgsql::database& db,
+                              std::uint64_t guild_id,
+                              std::uint64_t thread_id)
+{
+    using AllianceQuery  = odb::query<Alliance>;
+    using AllianceResult = odb::result<Alliance>;
+
+    std::optional<Entry> found;
+
+    auto run = [&]() {
+        AllianceResult ares(
+            db.query<Alliance>(
+                AllianceQuery::guild_id == guild_id &&
+                AllianceQuery::thread_channel_id == thread_id
+            )
+        );
+
+        auto ait = ares.begin();
+        if (ait != ares.end()) {
+            found = Entry{ait->id(), ait->guild_id(), ait->status()};
+        }
+    };
+
+    if (odb::transaction::has_current()) {
+        run();
+    } else {
+        odb::transaction t(db.begin());
+        tx_metrics::track(t, "alliance_index.resolve");
+        run();
+        t.commit();
+    }
+
+    return found;
+}
+
+} // namespace
+
+void load(const std::shared_ptr<odb::pgsql::database>& db) {
+    using AllianceQuery  = odb::query<Alliance>;
+    using AllianceResult = odb::result<Alliance>;
+
+    std::unordered_map<std::uint64_t, Entry> loaded;
+
+    try {
+        odb::transaction t(db->begin());
+        tx_metrics::track(t, "alliance_index.load");
+
+        AllianceResult ares(
+            db->query<Alliance>(
+                AllianceQuery::thread_channel_id != 0 &&
+                AllianceQuery::status != AllianceStatus::finished &&
+                AllianceQuery::status != AllianceStatus::cancelled
+            )
+        );
+
+        for (const Alliance& a : ares) {
+            loaded[a.thread_channel_id()] = Entry{a.id(), a.guild_id(), a.status()};
+        }
+
+        t.commit();
+    } catch (const std::exception& ex) {
+        std::cerr << "[AllianceIndex] Erreur DB au chargement : " << ex.what() << "\n";
+        return;
+    }
+
+    std::size_t count = loaded.size();
+    {
+        std::unique_lock<std::shared_mutex> lock(g_mutex);
+        g_by_thread.swap(loaded);
+    }
+
+    std::cout << "[AllianceIndex] " << count << " alliance(s) active(s) indexée(s)\n";
+}
+
+void put(std::uint64_t thread_id, const Entry& entry) {
+    if (thread_id == 0)
+        return;
+
+    std::unique_lock<std::shared_mutex> lock(g_mutex);
+    g_by_thread[thread_id] = entry;
+}
+
+void set_status(std::uint64_t thread_id, AllianceStatus status) {
+    std::unique_lock<std::shared_mutex> lock(g_mutex);
+    auto it = g_by_thread.find(thread_id);
+    if (it != g_by_thread.end()) {
+        it->second.status = status;
+    }
+}
+
+void erase(std::uint64_t thread_id) {
+    std::unique_lock<std::shared_mutex> lock(g_mutex);
+    g_by_thread.erase(thread_id);
+}
+
+std::optional<Entry> find(std::uint64_t guild_id, std::uint64_t thread_id) {
+    std::shared_lock<std::shared_mutex> lock(g_mutex);
+    auto it = g_by_thread.find(thread_id);
+    if (it == g_by_thread.end() || it->second.guild_id != guild_id)
+        return std::nullopt;
+    return it->second;
+}
+
+std::optional<Entry> resolve(odb::pgsql::database& db,
+                             std::uint64_t guild_id,
+                             std::uint64_t thread_id)
+{
+    if (auto e = find(guild_id, thread_id)) {
+        g_hits.fetch_add(1, std::memory_order_relaxed);
+        return e;
+    }
+
+    g_misses.fetch_add(1, std::memory_order_relaxed);
+
+    auto e = query_db(db, guild_id, thread_id);
+    if (e) {
+        put(thread_id, *e);
+    }
+    return e;
+}
+
+std::unique_ptr<Alliance> load_alliance(odb::pgsql::database& db,
+                                        std::uint64_t guild_id,
+                                        std::uint64_t thread_id)
+{
+    auto e = resolve(db, guild_id, thread_id);
+    if (!e)
+        return nullptr;
+
+    std::unique_ptr<Alliance> a(db.find<Alliance>(e->alliance_id));
+    if (!a) {
+        // Ligne supprimée entre-temps : on oublie l'entrée.
+        erase(thread_id);
+        return nullptr;
+    }
+
+    // Le statut en base fait foi (modifications hors de ce process).
+    if (a->status() != e->status) {
+        set_status(thread_id, a->status());
+    }
+
+    return a;
+}
+
+Stats stats() {
+    Stats s;
+    s.hits   = g_hits.load(std::memory_order_relaxed);
+    s.misses = g_misses.load(std::memory_order_relaxed);
+
+    std::shared_lock<std::shared_mutex> lock(g_mutex);
+    s.entries = g_by_thread.size();
+    return s;
+}
+
+} // namespace alliance_index
@@ -0,0 +1,316 @@
+#include "bot/CleanupQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <unordered_set>
+
+#include <odb/pgsql/database.hxx>
+#include <odb/transaction.hxx>
+#include <odb/query.hxx>
+
+#include "model/alliance_discord_objects.hxx"
+#include "alliance_discord_objects-odb.hxx"
+
+#include "model/alliance_cleanup_view.hxx"
+#include "alliance_cleanup_view-odb.hxx"
+
+#include "bot/RestScheduler.hpp"
+#include "db/DbExecutor.hpp"
+#include "db/TxMetrics.hpp"
+
+namespace cleanup_queue {
+
+namespace {
+
+constexpr std::time_t   BACKOFF_BASE_S = 10;
+constexpr std::time_t   BACKOFF_MAX_S  = 3600;
+constexpr unsigned int  MAX_ATTEMPTS   = 12;
+
+// Suppressions lancées par tick ; le scheduler REST lisse ensuite le débit.
+constexpr std::size_t   MAX_PER_TICK   = 20;
+
+struct Entry {
+    std::time_t   next_at    = 0;
+    int           rank       = 0; // à échéance égale : salons, puis catégories, puis rôles
+    std::uint64_t object_id  = 0;
+    DiscordObjectType type   = DiscordObjectType::role;
+    std::uint64_t guild_id   = 0;
+    std::uint64_t discord_id = 0;
+    unsigned int  attempts   = 0;
+};
+
+struct Later {
+    bool operator()(const Entry& a, const Entry& b) const {
+        if (a.next_at != b.next_at) return a.next_at > b.next_at;
+        if (a.rank != b.rank)       return a.rank > b.rank;
+        return a.object_id > b.object_id;
+    }
+};
+
+std::mutex g_mutex;
+dpp::cluster* g_cluster = nullptr;
+std::shared_ptr<odb::pgsql::database> g_db;
+
+std::priority_queue<Entry, std::vector<Entry>, Later> g_heap;
+std::unordered_set<std::uint64_t> g_known; // objets en file ou en cours
+std::size_t g_in_flight = 0;
+
+std::atomic<std::uint64_t> g_deleted {0};
+std::atomic<std::uint64_t> g_retried {0};
+std::atomic<std::uint64_t> g_abandoned {0};
+
+int rank_of(DiscordObjectType type) {
+    switch (type) {
+        case DiscordObjectType::voice_channel:
+        case DiscordObjectType::text_channel:
+            return 0;
+        case DiscordObjectType::category:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+std::time_t backoff_for(unsigned int attempts) {
+    const unsigned int shift = std::min(attempts > 0 ? attempts - 1 : 0u, 10u);
+    return std::min(BACKOFF_BASE_S << shift, BACKOFF_MAX_S);
+}
+
+// Sous verrou.
+void push_locked(Entry e) {
+    if (!g_known.insert(e.object_id).second)
+        return;
+    e.rank = rank_of(e.type);
+    g_heap.push(e);
+}
+
+Entry entry_from_row(const PendingCleanupRow& row) {
+    Entry e;
+    e.next_at    = row.cleanup_at;
+    e.object_id  = row.object_id;
+    e.type       = row.type;
+    e.guild_id   = row.guild_id;
+    e.discord_id = row.discord_id;
+    e.attempts   = row.attempts;
+    return e;
+}
+
+void persist_state(std::uint64_t object_id, bool deleted, unsigned int attempts, std::time_t next_at) {
+    try {
+        odb::transaction t(g_db->begin());
+        tx_metrics::track(t, "cleanup.persist");
+        std::unique_ptr<AllianceDiscordObject> obj(
+            g_db->find<AllianceDiscordObject>(object_id)
+        );
+        if (obj) {
+            if (deleted)
+                obj->mark_deleted_now();
+            obj->cleanup_attempts(attempts);
+            obj->cleanup_at(next_at);
+            g_db->update(*obj);
+        }
+        t.commit();
+    } catch (const std::exception& ex) {
+        std::cerr << "[Cleanup] Erreur DB objet " << object_id << " : " << ex.what() << "\n";
+    }
+}
+
+void on_result(Entry e, const dpp::confirmation_callback_t& cb) {
+    // Un 404 signifie que l'objet a déjà été supprimé à la main.
+    if (!cb.is_error() || rest_scheduler::is_not_found(cb)) {
+        persist_state(e.object_id, true, e.attempts, 0);
+        g_deleted.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_in_flight--;
+        g_known.erase(e.object_id);
+        return;
+    }
+
+    e.attempts++;
+
+    if (e.attempts >= MAX_ATTEMPTS) {
+        std::cerr << "[Cleanup] Abandon de la suppression de " << e.discord_id
+                  << " après " << e.attempts << " tentatives : "
+                  << cb.get_error().message << "\n";
+        persist_state(e.object_id, false, e.attempts, 0);
+        g_abandoned.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_in_flight--;
+        g_known.erase(e.object_id);
+        return;
+    }
+
+    e.next_at = std::time(nullptr) + backoff_for(e.attempts);
+
+    std::cerr << "[Cleanup] Échec suppression " << e.discord_id << " ("
+              << cb.get_error().message << "), nouvel essai dans "
+              << (e.next_at - std::time(nullptr)) << " s\n";
+
+    persist_state(e.object_id, false, e.attempts, e.next_at);
+    g_retried.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_in_flight--;
+    g_heap.push(e); // reste dans g_known
+}
+
+void dispatch(const Entry& e) {
+    // Appelé depuis le callback REST : l'état est persisté sur le pool DB,
+    // l'entrée ne repart qu'une fois la transaction faite.
+    auto done = [e](const dpp::confirmation_callback_t& cb) {
+        db_executor::post([e, cb]() { on_result(e, cb); });
+    };
+
+    if (e.type == DiscordObjectType::role) {
+        rest_scheduler::role_delete(
+            g_cluster,
+            static_cast<dpp::snowflake>(e.guild_id),
+            static_cast<dpp::snowflake>(e.discord_id),
+            rest_scheduler::Priority::background,
+            done
+        );
+    } else {
+        rest_scheduler::channel_delete(
+            g_cluster,
+            static_cast<dpp::snowflake>(e.discord_id),
+            rest_scheduler::Priority::background,
+            done
+        );
+    }
+}
+
+void tick() {
+    std::vector<Entry> due;
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (!g_cluster)
+            return;
+
+        const std::time_t now = std::time(nullptr);
+
+        // Le sommet du tas suffit à savoir s'il y a quelque chose à faire.
+        while (!g_heap.empty() && g_heap.top().next_at <= now && due.size() < MAX_PER_TICK) {
+            due.push_back(g_heap.top());
+            g_heap.pop();
+        }
+        g_in_flight += due.size();
+    }
+
+    for (const Entry& e : due) {
+        dispatch(e);
+    }
+}
+
+} // namespace
+
+bool handles(DiscordObjectType type) {
+    return type == DiscordObjectType::role          ||
+           type == DiscordObjectType::voice_channel ||
+           type == DiscordObjectType::text_channel  ||
+           type == DiscordObjectType::category;
+}
+
+void init(dpp::cluster* cluster, const std::shared_ptr<odb::pgsql::database>& db) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_cluster)
+            return;
+        g_cluster = cluster;
+        g_db      = db;
+    }
+
+    using RowQuery  = odb::query<PendingCleanupRow>;
+    using RowResult = odb::result<PendingCleanupRow>;
+
+    std::size_t resumed = 0;
+
+    try {
+        odb::transaction t(db->begin());
+        tx_metrics::track(t, "cleanup.resume");
+
+        RowResult res(db->query<PendingCleanupRow>(
+            RowQuery::AllianceDiscordObject::cleanup_at > 0 &&
+            RowQuery::AllianceDiscordObject::deleted_at == 0
+        ));
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (const PendingCleanupRow& row : res) {
+            if (!handles(row.type))
+                continue;
+
+            push_locked(entry_from_row(row));
+            ++resumed;
+        }
+
+        t.commit();
+    } catch (const std::exception& ex) {
+        std::cerr << "[Cleanup] Erreur DB au chargement de la file : " << ex.what() << "\n";
+    }
+
+    if (resumed > 0) {
+        std::cout << "[Cleanup] " << resumed << " suppression(s) en attente reprise(s)\n";
+    }
+
+    cluster->start_timer([](dpp::timer) { tick(); }, 1);
+}
+
+void schedule(odb::pgsql::database& db, AllianceDiscordObject& obj) {
+    obj.cleanup_at(std::time(nullptr));
+    obj.cleanup_attempts(0);
+    db.update(obj);
+}
+
+void enqueue(std::uint64_t guild_id, const std::vector<AllianceDiscordObject>& objects) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (const AllianceDiscordObject& obj : objects) {
+            if (!handles(obj.type()) || obj.deleted_at() != 0 || obj.cleanup_at() == 0)
+                continue;
+
+            Entry e;
+            e.next_at    = obj.cleanup_at();
+            e.object_id  = obj.id();
+            e.type       = obj.type();
+            e.guild_id   = guild_id;
+            e.discord_id = obj.discord_id();
+            e.attempts   = obj.cleanup_attempts();
+            push_locked(e);
+        }
+    }
+
+    // Pas d'attente du prochain tick pour une demande interactive.
+    tick();
+}
+
+void enqueue(const std::vector<PendingCleanupRow>& rows) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (const PendingCleanupRow& row : rows) {
+            if (handles(row.type) && row.cleanup_at != 0)
+                push_locked(entry_from_row(row));
+        }
+    }
+
+    tick();
+}
+
+Stats stats() {
+    Stats s;
+    s.deleted   = g_deleted.load(std::memory_order_relaxed);
+    s.retried   = g_retried.load(std::memory_order_relaxed);
+    s.abandoned = g_abandoned.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    s.queued    = g_heap.size();
+    s.in_flight = g_in_flight;
+    return s;
+}
+
+} // namespace cleanup_queue
@@ -0,0 +1,72 @@
+#include "bot/ComponentRouter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+RouteTable::RouteTable()
+    : nodes_(1)
+{
+}
+
+void RouteTable::add_exact(const std::string& id, std::size_t target) {
+    if (!exact_.emplace(id, target).second)
+        throw std::logic_error("Route déjà enregistrée : " + id);
+}
+
+void RouteTable::add_prefix(const std::string& prefix, std::size_t target) {
+    if (prefix.empty())
+        throw std::logic_error("Préfixe de route vide");
+
+    std::uint32_t node = 0;
+    for (char c : prefix) {
+        auto& children = nodes_[node].children;
+        auto it = std::lower_bound(
+            children.begin(), children.end(), c,
+            [](const std::pair<char, std::uint32_t>& child, char key) { return child.first < key; }
+        );
+
+        if (it != children.end() && it->first == c) {
+            node = it->second;
+            continue;
+        }
+
+        const auto next = static_cast<std::uint32_t>(nodes_.size());
+        children.insert(it, {c, next});
+        nodes_.emplace_back(); // invalide `children`, qui n'est plus utilisé
+        node = next;
+    }
+
+    if (nodes_[node].target != npos)
+        throw std::logic_error("Préfixe déjà enregistré : " + prefix);
+
+    nodes_[node].target = target;
+    prefixes_++;
+}
+
+std::size_t RouteTable::find(const std::string& id, bool& prefix_match) const {
+    prefix_match = false;
+
+    auto exact = exact_.find(id);
+    if (exact != exact_.end())
+        return exact->second;
+
+    // Descente du trie en retenant le dernier (donc le plus long) préfixe complet.
+    std::size_t best = npos;
+    std::uint32_t node = 0;
+    for (char c : id) {
+        const auto& children = nodes_[node].children;
+        auto it = std::lower_bound(
+            children.begin(), children.end(), c,
+            [](const std::pair<char, std::uint32_t>& child, char key) { return child.first < key; }
+        );
+        if (it == children.end() || it->first != c)
+            break;
+
+        node = it->second;
+        if (nodes_[node].target != npos)
+            best = nodes_[node].target;
+    }
+
+    prefix_match = best != npos;
+    return best;
+}
@@ -0,0 +1,548 @@
+#include "bot/Deferral.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+
+#include "util/Metrics.hpp"
+#include "util/Trace.hpp"
+#include "util/env.hpp"
+
+namespace deferral {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Délai accordé par Discord pour la première réponse.
+constexpr auto DISCORD_DEADLINE = std::chrono::milliseconds(3000);
+
+// Le jeton d'interaction expire après 15 minutes : au-delà, plus d'édition possible.
+constexpr auto RESULT_TIMEOUT = std::chrono::minutes(14);
+
+constexpr double        EWMA_ALPHA  = 0.2;
+constexpr std::uint64_t MIN_SAMPLES = 5; // avant de reporter d'emblée sur la moyenne
+
+constexpr auto LOG_INTERVAL = std::chrono::seconds(60);
+
+std::chrono::milliseconds defer_threshold() {
+    static const std::chrono::milliseconds value = []() {
+        try {
+            return std::chrono::milliseconds(std::stoul(getenv_or("DEFER_THRESHOLD_MS", "1500")));
+        } catch (...) {
+            std::cerr << "Warning : DEFER_THRESHOLD_MS invalide, utilisation de 1500.\n";
+            return std::chrono::milliseconds(1500);
+        }
+    }();
+    return value;
+}
+
+enum class Phase {
+    pending,   // aucune réponse envoyée
+    replied,   // réponse directe du handler
+    deferring, // acquittement différé envoyé, pas encore confirmé
+    deferred,  // acquitté, en attente du résultat du handler
+    done
+};
+
+struct Result {
+    bool has_message = false;
+    bool update      = false; // ir_update_message
+    dpp::message message;
+    dpp::command_completion_event_t callback;
+};
+
+struct State {
+    explicit State(const dpp::interaction_create_t& e) : event(e) {}
+
+    std::mutex mutex;
+    dpp::interaction_create_t event;
+    std::string path;
+    Clock::time_point started;
+    Phase phase = Phase::pending;
+    bool update_kind = false; // deferred update plutôt que thinking
+    std::optional<Result> queued;
+    trace::Context trace; // span de l'interaction (AllianceBot)
+};
+
+// Séries /metrics d'un chemin ("slash:creer" -> kind="slash", route="creer").
+struct PathMetrics {
+    metrics::Histogram* latency  = nullptr;
+    metrics::Counter*   upfront  = nullptr;
+    metrics::Counter*   watchdog = nullptr;
+    metrics::Counter*   late     = nullptr;
+};
+
+PathMetrics path_metrics(const std::string& path) {
+    const auto colon = path.find(':');
+    const std::string_view kind  = std::string_view(path).substr(0, colon);
+    const std::string_view route = colon == std::string::npos ? std::string_view() : std::string_view(path).substr(colon + 1);
+
+    PathMetrics m;
+    m.latency  = &metrics::histogram("sot_interaction_duration_seconds", {{"kind", kind}, {"route", route}});
+    m.upfront  = &metrics::counter("sot_interaction_deferred_total", {{"kind", kind}, {"route", route}, {"reason", "average"}});
+    m.watchdog = &metrics::counter("sot_interaction_deferred_total", {{"kind", kind}, {"route", route}, {"reason", "threshold"}});
+    m.late     = &metrics::counter("sot_interaction_late_total", {{"kind", kind}, {"route", route}});
+    return m;
+}
+
+struct Path {
+    PathStats stats;
+    PathMetrics metrics; // résolues à la première interaction du chemin
+    std::uint64_t samples = 0;
+    bool opens_dialog = false;
+    bool component    = false; // dernière réponse : acquittement ou mise à jour du message
+    bool ephemeral    = true;
+    Clock::time_point last_log {};
+};
+
+std::mutex g_mutex;
+std::unordered_map<std::uint64_t, std::shared_ptr<State>> g_states; // interaction id -> état
+std::unordered_map<std::string, Path> g_paths;
+
+struct Deadline {
+    Clock::time_point at;
+    bool expire = false; // sinon : seuil de report
+    std::weak_ptr<State> state;
+};
+
+struct Later {
+    bool operator()(const Deadline& a, const Deadline& b) const { return a.at > b.at; }
+};
+
+std::mutex g_wd_mutex;
+std::condition_variable g_wd_cv;
+std::priority_queue<Deadline, std::vector<Deadline>, Later> g_deadlines;
+std::once_flag g_wd_once;
+
+std::shared_ptr<State> find_state(const dpp::interaction_create_t& event) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_states.find(static_cast<std::uint64_t>(event.command.id));
+    return it == g_states.end() ? nullptr : it->second;
+}
+
+void forget(const State& st) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_states.erase(static_cast<std::uint64_t>(st.event.command.id));
+}
+
+void record(const State& st, const Result& result, bool was_deferred) {
+    const auto elapsed = Clock::now() - st.started;
+    const std::uint64_t us = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()
+    );
+    const std::uint64_t ms = us / 1000;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    Path& p = g_paths[st.path];
+
+    p.stats.ewma_ms = (p.samples == 0)
+                    ? static_cast<double>(ms)
+                    : EWMA_ALPHA * static_cast<double>(ms) + (1.0 - EWMA_ALPHA) * p.stats.ewma_ms;
+    p.samples++;
+    p.stats.max_ms = std::max(p.stats.max_ms, ms);
+    p.metrics.latency->observe_us(us);
+
+    if (!was_deferred && elapsed > DISCORD_DEADLINE) {
+        p.stats.late++;
+        p.metrics.late->add();
+    }
+
+    p.component = !result.has_message || result.update;
+    if (result.has_message && !result.update)
+        p.ephemeral = (result.message.flags & dpp::m_ephemeral) != 0;
+}
+
+// Résultat du handler après acquittement différé.
+void send_result(const State& st, const Result& result) {
+    const dpp::interaction_create_t& event = st.event;
+
+    if (!st.update_kind) {
+        // Après un thinking, une mise à jour devient le nouveau message.
+        if (result.has_message) {
+            event.edit_original_response(result.message, result.callback);
+        } else {
+            // Sélecteur acquitté après un thinking : on retire le message d'attente.
+            event.delete_original_response();
+        }
+        return;
+    }
+
+    // Deferred update : la réponse d'origine est le message du composant,
+    // un nouveau message passe donc par un followup.
+    if (result.update) {
+        event.edit_original_response(result.message, result.callback);
+    } else if (result.has_message) {
+        dpp::cluster* cluster = event.from() ? event.from()->creator : nullptr;
+        if (cluster) {
+            cluster->interaction_followup_create(event.command.token, result.message, result.callback);
+        }
+    }
+}
+
+// Span de la réponse envoyée à Discord, clos à sa confirmation.
+void trace_result(const State& st, Result& result) {
+    if (!result.has_message || !st.trace.valid())
+        return;
+
+    auto span = std::make_shared<trace::Span>(
+        result.update ? "discord.interaction.update" : "discord.interaction.reply",
+        trace::Span::Kind::client,
+        st.trace
+    );
+    span->attr("deferral.path", st.path);
+
+    result.callback = [span, callback = std::move(result.callback)](const dpp::confirmation_callback_t& cb) {
+        if (cb.is_error())
+            span->error(cb.get_error().message);
+        span->end();
+        if (callback)
+            callback(cb);
+    };
+}
+
+void respond(const std::shared_ptr<State>& st, Result result) {
+    trace_result(*st, result);
+
+    std::unique_lock<std::mutex> lock(st->mutex);
+
+    switch (st->phase) {
+        case Phase::pending: {
+            st->phase = Phase::replied;
+            lock.unlock();
+
+            if (result.update) {
+                st->event.reply(dpp::ir_update_message, result.message, result.callback);
+            } else if (result.has_message) {
+                st->event.reply(result.message, result.callback);
+            } else {
+                st->event.reply();
+            }
+
+            record(*st, result, false);
+            forget(*st);
+            return;
+        }
+
+        case Phase::deferring:
+            // Envoyé dès que Discord aura confirmé l'acquittement.
+            st->queued = std::move(result);
+            return;
+
+        case Phase::deferred: {
+            st->phase = Phase::done;
+            lock.unlock();
+
+            send_result(*st, result);
+            record(*st, result, true);
+            forget(*st);
+            return;
+        }
+
+        case Phase::replied:
+        case Phase::done:
+            break;
+    }
+
+    // Seconde réponse du même handler : comportement d'origine.
+    lock.unlock();
+    if (result.has_message) {
+        st->event.reply(result.message, result.callback);
+    }
+}
+
+void defer(const std::shared_ptr<State>& st, bool upfront) {
+    bool update_kind = false;
+    bool ephemeral   = true;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        Path& p = g_paths[st->path];
+
+        // Un modal ne peut pas suivre un acquittement : ces chemins ne sont jamais reportés.
+        if (p.opens_dialog)
+            return;
+
+        update_kind = p.component;
+        ephemeral   = p.ephemeral;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(st->mutex);
+        if (st->phase != Phase::pending)
+            return;
+        st->phase       = Phase::deferring;
+        st->update_kind = update_kind;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        Path& p = g_paths[st->path];
+        if (upfront) {
+            p.stats.deferred_upfront++;
+            p.metrics.upfront->add();
+        } else {
+            p.stats.deferred_watchdog++;
+            p.metrics.watchdog->add();
+        }
+
+        const auto now = Clock::now();
+        if (now - p.last_log >= LOG_INTERVAL) {
+            p.last_log = now;
+            std::cout << "[Interaction] Réponse différée (" << (upfront ? "moyenne" : "seuil")
+                      << ") : " << st->path << " ("
+                      << p.stats.deferred_upfront + p.stats.deferred_watchdog << "/"
+                      << p.stats.calls << ", moyenne " << static_cast<std::uint64_t>(p.stats.ewma_ms)
+                      << " ms)\n";
+        }
+    }
+
+    auto on_ack = [st](const dpp::confirmation_callback_t& cb) {
+        if (cb.is_error()) {
+            std::cerr << "[Interaction] Échec de l'acquittement différé (" << st->path << ") : "
+                      << cb.get_error().message << "\n";
+        }
+
+        std::optional<Result> result;
+        {
+            std::lock_guard<std::mutex> lock(st->mutex);
+            st->phase = Phase::deferred;
+            result.swap(st->queued);
+            if (result)
+                st->phase = Phase::done;
+        }
+
+        if (result) {
+            send_result(*st, *result);
+            record(*st, *result, true);
+            forget(*st);
+        }
+    };
+
+    if (update_kind) {
+        st->event.reply(dpp::ir_deferred_update_message, dpp::message(), on_ack);
+    } else {
+        st->event.thinking(ephemeral, on_ack);
+    }
+}
+
+void expire(const std::shared_ptr<State>& st) {
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(st->mutex);
+        notify = (st->phase == Phase::deferred && !st->update_kind);
+        st->phase = Phase::done;
+    }
+
+    if (notify) {
+        dpp::message msg("⌛ Le traitement a pris trop de temps, réessaie plus tard.");
+        msg.set_flags(dpp::m_ephemeral);
+        st->event.edit_original_response(msg);
+    }
+
+    forget(*st);
+}
+
+void watchdog_loop() {
+    std::unique_lock<std::mutex> lock(g_wd_mutex);
+
+    for (;;) {
+        if (g_deadlines.empty()) {
+            g_wd_cv.wait(lock);
+            continue;
+        }
+
+        const Clock::time_point next = g_deadlines.top().at;
+        if (Clock::now() < next) {
+            g_wd_cv.wait_until(lock, next);
+            continue;
+        }
+
+        Deadline d = g_deadlines.top();
+        g_deadlines.pop();
+        lock.unlock();
+
+        if (auto st = d.state.lock()) {
+            if (d.expire)
+                expire(st);
+            else
+                defer(st, false);
+        }
+
+        lock.lock();
+    }
+}
+
+void schedule(Clock::time_point at, bool is_expire, const std::shared_ptr<State>& st) {
+    std::call_once(g_wd_once, []() { std::thread(watchdog_loop).detach(); });
+
+    {
+        std::lock_guard<std::mutex> lock(g_wd_mutex);
+        g_deadlines.push(Deadline{at, is_expire, st});
+    }
+    g_wd_cv.notify_one();
+}
+
+} // namespace
+
+void begin(const dpp::interaction_create_t& event, const std::string& path) {
+    auto st = std::make_shared<State>(event);
+    st->path    = path;
+    st->started = Clock::now();
+    st->trace   = trace::current();
+
+    const std::chrono::milliseconds threshold = defer_threshold();
+    bool upfront = false;
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_states[static_cast<std::uint64_t>(event.command.id)] = st;
+
+        Path& p = g_paths[path];
+        if (!p.metrics.latency) {
+            p.stats.path = path;
+            p.metrics = path_metrics(path);
+        }
+        p.stats.calls++;
+
+        upfront = threshold.count() > 0 &&
+                  !p.opens_dialog &&
+                  p.samples >= MIN_SAMPLES &&
+                  p.stats.ewma_ms >= static_cast<double>(threshold.count());
+    }
+
+    if (upfront) {
+        defer(st, true);
+    } else if (threshold.count() > 0) {
+        schedule(st->started + threshold, false, st);
+    }
+
+    schedule(st->started + RESULT_TIMEOUT, true, st);
+}
+
+void reply(const dpp::interaction_create_t& event,
+           const dpp::message& msg,
+           dpp::command_completion_event_t callback)
+{
+    auto st = find_state(event);
+    if (!st) {
+        event.reply(msg, callback);
+        return;
+    }
+
+    Result r;
+    r.has_message = true;
+    r.message     = msg;
+    r.callback    = std::move(callback);
+    respond(st, std::move(r));
+}
+
+void ack(const dpp::interaction_create_t& event) {
+    auto st = find_state(event);
+    if (!st) {
+        event.reply();
+        return;
+    }
+
+    respond(st, Result{});
+}
+
+void update(const dpp::interaction_create_t& event,
+            const dpp::message& msg,
+            dpp::command_completion_event_t callback)
+{
+    auto st = find_state(event);
+    if (!st) {
+        event.reply(dpp::ir_update_message, msg, callback);
+        return;
+    }
+
+    Result r;
+    r.has_message = true;
+    r.update      = true;
+    r.message     = msg;
+    r.callback    = std::move(callback);
+    respond(st, std::move(r));
+}
+
+void dialog(const dpp::interaction_create_t& event, const dpp::interaction_modal_response& modal) {
+    auto st = find_state(event);
+
+    if (!st) {
+        event.dialog(modal);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_paths[st->path].opens_dialog = true;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(st->mutex);
+        if (st->phase == Phase::pending) {
+            st->phase = Phase::replied;
+            lock.unlock();
+
+            event.dialog(modal);
+
+            Result r;
+            r.has_message = true; // un modal compte comme une vraie réponse
+            record(*st, r, false);
+            forget(*st);
+            return;
+        }
+    }
+
+    // Reporté avant l'ouverture du modal (premier passage sur ce chemin).
+    std::cerr << "[Interaction] Modal impossible après acquittement : " << st->path << "\n";
+
+    Result r;
+    r.has_message = true;
+    r.message     = dpp::message("⌛ Le formulaire n'a pas pu s'ouvrir à temps, réessaie.");
+    r.message.set_flags(dpp::m_ephemeral);
+    respond(st, std::move(r));
+}
+
+#ifdef DPP_CORO
+// La coroutine reprend dans le callback, sur un thread DPP : trace::bind la
+// rattache au contexte de l'interaction.
+dpp::async<dpp::confirmation_callback_t> co_reply(const dpp::interaction_create_t& event,
+                                                  const dpp::message& msg)
+{
+    return dpp::async<dpp::confirmation_callback_t>{
+        [&event, &msg](auto&& cb) { reply(event, msg, trace::bind(std::forward<decltype(cb)>(cb))); }
+    };
+}
+
+dpp::async<dpp::confirmation_callback_t> co_update(const dpp::interaction_create_t& event,
+                                                   const dpp::message& msg)
+{
+    return dpp::async<dpp::confirmation_callback_t>{
+        [&event, &msg](auto&& cb) { update(event, msg, trace::bind(std::forward<decltype(cb)>(cb))); }
+    };
+}
+#endif
+
+std::vector<PathStats> stats() {
+    std::vector<PathStats> out;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        out.reserve(g_paths.size());
+        for (const auto& [path, p] : g_paths) {
+            out.push_back(p.stats);
+        }
+    }
+
+    std::sort(out.begin(), out.end(),
+              [](const PathStats& a, const PathStats& b) { return a.path < b.path; });
+    return out;
+}
+
+} // namespace deferral
@@ -0,0 +1,72 @@
+#include "bot/InteractionTrace.hpp"
+
+#include <utility>
+
+#include "util/Metrics.hpp"
+
+namespace interaction_trace {
+
+namespace {
+
+thread_local Dispatch* t_dispatch = nullptr;
+
+} // namespace
+
+Handle::Handle(std::shared_ptr<trace::Span> span, metrics::Counter* errors)
+    : span_(std::move(span)), errors_(errors)
+{
+}
+
+Handle::Handle(Handle&& other) noexcept
+    : span_(std::move(other.span_)), errors_(other.errors_)
+{
+    other.errors_ = nullptr;
+}
+
+Handle& Handle::operator=(Handle&& other) noexcept {
+    if (this != &other) {
+        end();
+        span_   = std::move(other.span_);
+        errors_ = other.errors_;
+        other.errors_ = nullptr;
+    }
+    return *this;
+}
+
+Handle::~Handle() {
+    end();
+}
+
+trace::Context Handle::context() const {
+    return span_ ? span_->context() : trace::Context{};
+}
+
+void Handle::fail(std::string_view message) {
+    if (errors_)
+        errors_->add();
+    if (span_)
+        span_->error(message);
+}
+
+void Handle::end() {
+    if (span_)
+        span_->end();
+}
+
+Dispatch::Dispatch(std::shared_ptr<trace::Span> span, metrics::Counter* errors)
+    : handle_(std::move(span), errors), previous_(t_dispatch)
+{
+    t_dispatch = this;
+}
+
+Dispatch::~Dispatch() {
+    t_dispatch = previous_;
+}
+
+Handle take() {
+    if (!t_dispatch)
+        return {};
+    return std::move(t_dispatch->handle_);
+}
+
+} // namespace interaction_trace
@@ -0,0 +1,370 @@
+#include "bot/Outbox.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <odb/pgsql/database.hxx>
+#include <odb/transaction.hxx>
+#include <odb/query.hxx>
+
+#include "discord_outbox-odb.hxx"
+
+#include "db/DbExecutor.hpp"
+#include "db/TxMetrics.hpp"
+
+namespace outbox {
+
+namespace {
+
+constexpr std::size_t  BATCH_SIZE     = 50;
+constexpr unsigned int MAX_ATTEMPTS   = 8;
+constexpr std::time_t  BACKOFF_BASE_S = 5;
+constexpr std::time_t  BACKOFF_MAX_S  = 600;
+
+// Sans événement connu, la table est relue au plus une fois par minute.
+constexpr std::time_t  IDLE_RESCAN_S  = 60;
+
+// Un événement réservé (in_progress) appartient à l'instance qui l'a pris
+// jusqu'à locked_until ; la réservation est prolongée tant que le handler
+// tourne. Passé ce délai (instance arrêtée), une autre instance le reprend.
+constexpr std::time_t  LEASE_S        = 60;
+constexpr std::time_t  LEASE_RENEW_S  = 20;
+
+std::mutex g_mutex;
+dpp::cluster* g_cluster = nullptr;
+std::shared_ptr<odb::pgsql::database> g_db;
+
+std::unordered_map<OutboxKind, Handler> g_handlers;
+std::unordered_map<OutboxKind, Abandoned> g_abandoned;
+std::unordered_set<std::uint64_t> g_in_flight;
+
+// Prochaine lecture utile de la table (0 : dès le prochain drain).
+std::time_t g_next_scan = 0;
+std::time_t g_next_renew = 0;
+std::uint64_t g_kicks = 0; // kick() reçus, pour ne pas en perdre un pendant un drain
+std::atomic<bool> g_draining {false};
+
+std::atomic<std::uint64_t> g_dispatched {0};
+std::atomic<std::uint64_t> g_succeeded {0};
+std::atomic<std::uint64_t> g_retried {0};
+std::atomic<std::uint64_t> g_failed {0};
+
+std::time_t backoff_for(unsigned int attempts) {
+    const unsigned int shift = std::min(attempts > 0 ? attempts - 1 : 0u, 10u);
+    return std::min(BACKOFF_BASE_S << shift, BACKOFF_MAX_S);
+}
+
+void record_result(std::uint64_t id, bool ok, const std::string& error) {
+    const std::time_t now = std::time(nullptr);
+    std::time_t retry_at = 0;
+    std::unique_ptr<OutboxEvent> abandoned;
+
+    try {
+        odb::transaction t(g_db->begin());
+        tx_metrics::track(t, "outbox.finish");
+        std::unique_ptr<OutboxEvent> ev(g_db->find<OutboxEvent>(id));
+
+        if (ev) {
+            ev->locked_until(0);
+
+            if (ok) {
+                ev->status(OutboxStatus::done);
+                ev->done_at(now);
+                ev->last_error({});
+            } else {
+                ev->attempts(ev->attempts() + 1);
+                ev->last_error(error);
+
+                if (ev->attempts() >= MAX_ATTEMPTS) {
+                    ev->status(OutboxStatus::failed);
+                    ev->done_at(now);
+                    std::cerr << "[Outbox] Abandon de " << ev->idempotency_key() << " après "
+                              << ev->attempts() << " tentatives : " << error << "\n";
+                    abandoned = std::make_unique<OutboxEvent>(*ev);
+                } else {
+                    retry_at = now + backoff_for(ev->attempts());
+                    ev->status(OutboxStatus::pending);
+                    ev->next_attempt_at(retry_at);
+                    std::cerr << "[Outbox] Échec de " << ev->idempotency_key() << " ("
+                              << error << "), nouvel essai dans " << (retry_at - now) << " s\n";
+                }
+            }
+            g_db->update(*ev);
+        }
+
+        t.commit();
+    } catch (const std::exception& ex) {
+        abandoned.reset();
+        // L'événement reste réservé : il sera repris à l'expiration de locked_until.
+        std::cerr << "[Outbox] Erreur DB sur l'événement " << id << " : " << ex.what() << "\n";
+        retry_at = now + LEASE_S;
+    }
+
+    if (ok) {
+        g_succeeded.fetch_add(1, std::memory_order_relaxed);
+    } else if (retry_at != 0) {
+        g_retried.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        g_failed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Abandoned on_abandoned;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_in_flight.erase(id);
+        if (retry_at != 0 && g_next_scan != 0) {
+            g_next_scan = std::min(g_next_scan, retry_at);
+        }
+        if (abandoned) {
+            auto it = g_abandoned.find(abandoned->kind());
+            if (it != g_abandoned.end())
+                on_abandoned = it->second;
+        }
+    }
+
+    if (on_abandoned)
+        on_abandoned(*abandoned);
+}
+
+// Appelé depuis les callbacks REST : la transaction passe par le pool DB.
+void finish(std::uint64_t id, bool ok, const std::string& error) {
+    db_executor::post([id, ok, error]() { record_result(id, ok, error); });
+}
+
+void dispatch(const OutboxEvent& ev) {
+    Handler handler;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_handlers.find(ev.kind());
+        if (it != g_handlers.end())
+            handler = it->second;
+    }
+
+    const std::uint64_t id = ev.id();
+    g_dispatched.fetch_add(1, std::memory_order_relaxed);
+
+    if (!handler) {
+        finish(id, false, "aucun handler pour ce type d'événement");
+        return;
+    }
+
+    // Un handler ne doit conclure qu'une fois, même s'il rappelle done par erreur.
+    auto called = std::make_shared<std::atomic<bool>>(false);
+    Done done = [id, called](bool ok, const std::string& error) {
+        if (!called->exchange(true))
+            finish(id, ok, error);
+    };
+
+    try {
+        handler(g_cluster, g_db, ev, done);
+    } catch (const std::exception& ex) {
+        done(false, ex.what());
+    }
+}
+
+// Prolonge la réservation des événements encore traités par cette instance.
+void renew_leases(const std::vector<std::uint64_t>& ids, std::time_t now) {
+    if (ids.empty())
+        return;
+
+    std::string list;
+    for (std::uint64_t id : ids) {
+        if (!list.empty())
+            list += ",";
+        list += std::to_string(id);
+    }
+
+    odb::transaction t(g_db->begin());
+    tx_metrics::track(t, "outbox.renew");
+    g_db->execute(
+        "UPDATE discord_outbox SET locked_until = " + std::to_string(now + LEASE_S)
+        + " WHERE status = " + std::to_string(static_cast<int>(OutboxStatus::in_progress))
+        + " AND id IN (" + list + ")"
+    );
+    t.commit();
+}
+
+// Réserve jusqu'à BATCH_SIZE événements dus : FOR UPDATE SKIP LOCKED écarte
+// ceux qu'une autre instance est en train de réserver, le statut
+// in_progress ceux déjà réservés, et la liste locale ceux que cette instance
+// traite encore (réservation expirée pendant un handler lent).
+std::vector<OutboxEvent> claim(std::time_t now, const std::vector<std::uint64_t>& local) {
+    using Query  = odb::query<OutboxEvent>;
+    using Result = odb::result<OutboxEvent>;
+
+    std::vector<OutboxEvent> claimed;
+
+    odb::transaction t(g_db->begin());
+    tx_metrics::track(t, "outbox.claim");
+
+    Query q((Query::status == OutboxStatus::pending && Query::next_attempt_at <= now) ||
+            (Query::status == OutboxStatus::in_progress && Query::locked_until <= now));
+    if (!local.empty()) {
+        q = q && !Query::id.in_range(local.begin(), local.end());
+    }
+    q += " ORDER BY " + Query::next_attempt_at + ", " + Query::id;
+    q += " LIMIT " + std::to_string(BATCH_SIZE);
+    q += " FOR UPDATE SKIP LOCKED";
+
+    Result res(g_db->query<OutboxEvent>(q));
+    for (const OutboxEvent& ev : res) {
+        claimed.push_back(ev);
+    }
+
+    for (OutboxEvent& ev : claimed) {
+        ev.status(OutboxStatus::in_progress);
+        ev.locked_until(now + LEASE_S);
+        g_db->update(ev);
+    }
+
+    t.commit();
+    return claimed;
+}
+
+void drain_now() {
+    std::vector<OutboxEvent> due;
+    const std::time_t now = std::time(nullptr);
+    std::uint64_t kicks = 0;
+    std::vector<std::uint64_t> local;
+    bool renew = false;
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        kicks = g_kicks;
+        local.assign(g_in_flight.begin(), g_in_flight.end());
+        if (!local.empty() && now >= g_next_renew) {
+            renew = true;
+            g_next_renew = now + LEASE_RENEW_S;
+        }
+    }
+
+    try {
+        if (renew) {
+            renew_leases(local, now);
+        }
+
+        bool scan = false;
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            scan = now >= g_next_scan;
+        }
+
+        if (scan) {
+            due = claim(now, local);
+
+            std::lock_guard<std::mutex> lock(g_mutex);
+            for (const OutboxEvent& ev : due) {
+                g_in_flight.insert(ev.id());
+            }
+
+            // Lot plein (il reste sans doute des événements dus) ou kick() reçu
+            // pendant la lecture : on relit au prochain tick. Sinon, les
+            // nouvelles tentatives locales avancent g_next_scan (finish), et
+            // celles des autres instances sont vues au plus tard après IDLE_RESCAN_S.
+            g_next_scan = (due.size() == BATCH_SIZE || kicks != g_kicks) ? 0 : now + IDLE_RESCAN_S;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "[Outbox] Erreur DB lecture : " << ex.what() << "\n";
+    }
+
+    g_draining = false;
+
+    for (const OutboxEvent& ev : due) {
+        dispatch(ev);
+    }
+}
+
+// Depuis le timer DPP ou kick() : la lecture et les handlers tournent sur le pool DB.
+void drain() {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (!g_cluster)
+            return;
+
+        const std::time_t now = std::time(nullptr);
+        const bool renew_due = !g_in_flight.empty() && now >= g_next_renew;
+        if (now < g_next_scan && !renew_due)
+            return;
+    }
+
+    bool expected = false;
+    if (!g_draining.compare_exchange_strong(expected, true))
+        return;
+
+    db_executor::post(drain_now);
+}
+
+} // namespace
+
+void register_handler(OutboxKind kind, Handler handler, Abandoned abandoned) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_handlers[kind] = std::move(handler);
+    if (abandoned)
+        g_abandoned[kind] = std::move(abandoned);
+    else
+        g_abandoned.erase(kind);
+}
+
+void init(dpp::cluster* cluster, const std::shared_ptr<odb::pgsql::database>& db) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_cluster)
+            return;
+        g_cluster   = cluster;
+        g_db        = db;
+        g_next_scan = 0;
+    }
+
+    cluster->start_timer([](dpp::timer) { drain(); }, 1);
+}
+
+bool add(odb::pgsql::database& db,
+         const std::string& idempotency_key,
+         OutboxKind kind,
+         std::uint64_t guild_id,
+         std::uint64_t alliance_id,
+         std::uint64_t channel_id,
+         const std::string& payload)
+{
+    using Query = odb::query<OutboxEvent>;
+
+    std::unique_ptr<OutboxEvent> existing(
+        db.query_one<OutboxEvent>(Query::idempotency_key == idempotency_key)
+    );
+    if (existing)
+        return false;
+
+    // L'index unique reste la garantie en cas de course : la transaction échoue.
+    OutboxEvent ev(idempotency_key, kind, guild_id, alliance_id, channel_id, payload);
+    db.persist(ev);
+    return true;
+}
+
+void kick() {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_next_scan = 0;
+        g_kicks++;
+    }
+    drain();
+}
+
+Stats stats() {
+    Stats s;
+    s.dispatched = g_dispatched.load(std::memory_order_relaxed);
+    s.succeeded  = g_succeeded.load(std::memory_order_relaxed);
+    s.retried    = g_retried.load(std::memory_order_relaxed);
+    s.failed     = g_failed.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    s.in_flight = g_in_flight.size();
+    return s;
+}
+
+} // namespace outbox
@@ -0,0 +1,247 @@
+#include "bot/Reconciler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <odb/pgsql/database.hxx>
+#include <odb/transaction.hxx>
+#include <odb/query.hxx>
+
+#include "model/alliance_cleanup_view.hxx"
+#include "alliance_cleanup_view-odb.hxx"
+
+#include "bot/CleanupQueue.hpp"
+#include "bot/RestScheduler.hpp"
+#include "db/DbExecutor.hpp"
+#include "db/TxMetrics.hpp"
+
+#include "util/env.hpp"
+
+namespace reconciler {
+
+namespace {
+
+constexpr std::size_t BATCH_SIZE = 200;
+
+// Première passe après le démarrage : laisse le temps aux GUILD_CREATE de remplir le cache.
+constexpr int STARTUP_DELAY_S = 60;
+
+// Au-delà, la passe s'arrête : les suppressions déjà en file passent d'abord.
+constexpr std::size_t MAX_REST_BACKLOG = 200;
+
+std::mutex g_report_mutex;
+Report g_last_report;
+std::atomic<bool> g_running {false};
+
+std::uint64_t reconcile_interval_seconds() {
+    static const std::uint64_t value = []() -> std::uint64_t {
+        try {
+            return std::stoull(getenv_or("RECONCILE_INTERVAL_SECONDS", "3600"));
+        } catch (...) {
+            std::cerr << "Warning : RECONCILE_INTERVAL_SECONDS invalide, utilisation de 3600.\n";
+            return 3600;
+        }
+    }();
+    return value;
+}
+
+std::string id_list(const std::vector<PendingCleanupRow>& rows) {
+    std::ostringstream oss;
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        if (i) oss << ",";
+        oss << rows[i].object_id;
+    }
+    return oss.str();
+}
+
+enum class CacheState { present, missing, unknown };
+
+CacheState check_cache(const PendingCleanupRow& row) {
+    if (!dpp::find_guild(static_cast<dpp::snowflake>(row.guild_id)))
+        return CacheState::unknown;
+
+    const dpp::snowflake id(row.discord_id);
+    const bool present = (row.type == DiscordObjectType::role)
+                       ? dpp::find_role(id) != nullptr
+                       : dpp::find_channel(id) != nullptr;
+
+    return present ? CacheState::present : CacheState::missing;
+}
+
+void log_report(const Report& r) {
+    if (r.queued == 0 && r.missing == 0 && !r.deferred)
+        return;
+
+    std::cout << "[Reconcile] " << r.scanned << " objet(s) examiné(s) en " << r.batches
+              << " lot(s) : " << r.queued << " à supprimer, " << r.missing
+              << " déjà absent(s), " << r.unknown << " guild(s) hors cache, en "
+              << r.elapsed_ms << " ms" << (r.deferred ? " (interrompue, file REST chargée)" : "")
+              << "\n";
+}
+
+// Appelé depuis le timer DPP : la passe (plusieurs lots, deux transactions
+// chacun) tourne sur le pool DB pour ne pas bloquer les autres timers.
+void schedule_run(const std::shared_ptr<odb::pgsql::database>& db) {
+    bool expected = false;
+    if (!g_running.compare_exchange_strong(expected, true))
+        return;
+
+    db_executor::post([db]() {
+        Report r;
+        try {
+            r = run_once(db);
+        } catch (...) {
+            g_running = false;
+            throw;
+        }
+        g_running = false;
+        log_report(r);
+    });
+}
+
+} // namespace
+
+Report run_once(const std::shared_ptr<odb::pgsql::database>& db) {
+    using RowQuery  = odb::query<PendingCleanupRow>;
+    using RowResult = odb::result<PendingCleanupRow>;
+
+    const auto start = std::chrono::steady_clock::now();
+    Report report;
+    std::uint64_t last_id = 0;
+
+    try {
+        for (;;) {
+            if (rest_scheduler::stats().queued > MAX_REST_BACKLOG) {
+                report.deferred = true;
+                break;
+            }
+
+            std::vector<PendingCleanupRow> batch;
+            batch.reserve(BATCH_SIZE);
+
+            {
+                odb::transaction t(db->begin());
+                tx_metrics::track(t, "reconciler.batch");
+
+                // Pagination par clé : chaque lot reprend après le dernier id vu.
+                RowQuery q(
+                    RowQuery::AllianceDiscordObject::id > last_id &&
+                    RowQuery::Alliance::status.in(AllianceStatus::finished, AllianceStatus::cancelled) &&
+                    RowQuery::AllianceDiscordObject::auto_delete == true &&
+                    RowQuery::AllianceDiscordObject::deleted_at == 0 &&
+                    RowQuery::AllianceDiscordObject::cleanup_at == 0 &&
+                    RowQuery::AllianceDiscordObject::cleanup_attempts == 0
+                );
+                q += " ORDER BY " + RowQuery::AllianceDiscordObject::id;
+                q += " LIMIT " + std::to_string(BATCH_SIZE);
+
+                RowResult res(db->query<PendingCleanupRow>(q));
+                for (const PendingCleanupRow& row : res) {
+                    batch.push_back(row);
+                }
+
+                t.commit();
+            }
+
+            if (batch.empty())
+                break;
+
+            report.batches++;
+            report.scanned += batch.size();
+            last_id = batch.back().object_id;
+
+            std::vector<PendingCleanupRow> present;
+            std::vector<PendingCleanupRow> missing;
+
+            for (const PendingCleanupRow& row : batch) {
+                if (!cleanup_queue::handles(row.type))
+                    continue;
+
+                switch (check_cache(row)) {
+                    case CacheState::present: present.push_back(row); break;
+                    case CacheState::missing: missing.push_back(row); break;
+                    case CacheState::unknown: report.unknown++;       break;
+                }
+            }
+
+            const std::time_t now = std::time(nullptr);
+
+            if (!present.empty() || !missing.empty()) {
+                odb::transaction t(db->begin());
+                tx_metrics::track(t, "reconciler.mark_missing");
+
+                if (!missing.empty()) {
+                    db->execute(
+                        "UPDATE alliance_discord_objects SET deleted_at = " + std::to_string(now)
+                        + " WHERE deleted_at = 0 AND id IN (" + id_list(missing) + ")"
+                    );
+                }
+                if (!present.empty()) {
+                    db->execute(
+                        "UPDATE alliance_discord_objects SET cleanup_at = " + std::to_string(now)
+                        + ", cleanup_attempts = 0"
+                        + " WHERE deleted_at = 0 AND id IN (" + id_list(present) + ")"
+                    );
+                }
+
+                t.commit();
+            }
+
+            report.missing += missing.size();
+            report.queued  += present.size();
+
+            if (!present.empty()) {
+                for (PendingCleanupRow& row : present) {
+                    row.cleanup_at = now;
+                }
+                cleanup_queue::enqueue(present);
+            }
+
+            if (batch.size() < BATCH_SIZE)
+                break;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "[Reconcile] Erreur DB : " << ex.what() << "\n";
+    }
+
+    report.elapsed_ms = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start
+        ).count()
+    );
+
+    {
+        std::lock_guard<std::mutex> lock(g_report_mutex);
+        g_last_report = report;
+    }
+
+    return report;
+}
+
+void init(dpp::cluster* cluster, const std::shared_ptr<odb::pgsql::database>& db) {
+    const std::uint64_t interval = reconcile_interval_seconds();
+    if (interval == 0)
+        return;
+
+    cluster->start_timer(
+        [cluster, db](dpp::timer h) {
+            cluster->stop_timer(h);
+            schedule_run(db);
+        },
+        STARTUP_DELAY_S
+    );
+
+    cluster->start_timer([db](dpp::timer) { schedule_run(db); }, interval);
+}
+
+Report last_report() {
+    std::lock_guard<std::mutex> lock(g_report_mutex);
+    return g_last_report;
+}
+
+} // namespace reconciler
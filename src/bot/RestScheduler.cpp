@@ -0,0 +1,508 @@
+#include "bot/RestScheduler.hpp"
+#include "util/Metrics.hpp"
+#include "util/Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rest_scheduler {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto BACKOFF_BASE = std::chrono::milliseconds(500);
+constexpr auto BACKOFF_MAX  = std::chrono::seconds(30);
+constexpr auto JITTER_MAX   = std::chrono::milliseconds(250);
+
+// Nombre max de jobs examinés par passage, pour borner le temps sous verrou.
+constexpr std::size_t PUMP_SCAN_LIMIT = 256;
+
+struct Job {
+    std::string route;
+    Priority prio;
+    std::uint64_t seq;
+    Dispatch dispatch;
+    dpp::command_completion_event_t on_done;
+    int attempts = 0;
+    int max_attempts = 5;
+    Retry retry = Retry::transient;
+    Clock::time_point not_before {};
+    std::string bucket_key; // bucket utilisé au moment de l'envoi
+
+    // Durée de submit() à la réponse définitive (file et reprises comprises), par type de route.
+    Clock::time_point submitted_at {};
+    metrics::Histogram* latency = nullptr;
+    metrics::Counter*   errors  = nullptr;
+
+    // Span client rattaché à l'interaction (ou au job) qui a soumis l'appel ;
+    // trace : contexte de l'appelant, rétabli pendant on_done.
+    trace::Span span;
+    trace::Context trace;
+};
+
+using JobPtr = std::shared_ptr<Job>;
+
+struct JobOrder {
+    bool operator()(const JobPtr& a, const JobPtr& b) const {
+        if (a->prio != b->prio)
+            return a->prio > b->prio;
+        return a->seq > b->seq;
+    }
+};
+
+struct Bucket {
+    long long limit     = -1; // -1 : inconnu tant qu'aucune réponse n'est arrivée
+    long long remaining = -1;
+    Clock::time_point reset_at {};
+    Clock::time_point blocked_until {};
+    int in_flight = 0;
+};
+
+std::mutex g_mutex;
+dpp::cluster* g_cluster = nullptr;
+
+std::priority_queue<JobPtr, std::vector<JobPtr>, JobOrder> g_queue;
+std::uint64_t g_seq = 0;
+
+// route -> hash de bucket Discord (appris depuis X-RateLimit-Bucket)
+std::unordered_map<std::string, std::string> g_route_bucket;
+std::unordered_map<std::string, Bucket> g_buckets;
+Clock::time_point g_global_until {};
+
+std::atomic<std::uint64_t> g_submitted {0};
+std::atomic<std::uint64_t> g_completed {0};
+std::atomic<std::uint64_t> g_failed {0};
+std::atomic<std::uint64_t> g_retried {0};
+std::atomic<std::uint64_t> g_rate_limited {0};
+
+std::string major_param(const std::string& route) {
+    auto pos = route.find(':');
+    return pos == std::string::npos ? std::string() : route.substr(pos + 1);
+}
+
+// Deux routes partageant le même bucket Discord (et le même paramètre majeur) partagent l'état.
+std::string bucket_key_for(const std::string& route) {
+    auto it = g_route_bucket.find(route);
+    if (it == g_route_bucket.end())
+        return route;
+    return it->second + ":" + major_param(route);
+}
+
+bool bucket_allows(Bucket& b, Clock::time_point now) {
+    if (b.blocked_until > now)
+        return false;
+
+    if (b.limit >= 0 && b.reset_at <= now) {
+        b.remaining = b.limit;
+    }
+
+    // Bucket inconnu : une requête à la fois jusqu'à la première réponse.
+    if (b.remaining < 0)
+        return b.in_flight == 0;
+
+    return b.in_flight < b.remaining;
+}
+
+Clock::duration backoff_for(int attempts) {
+    static thread_local std::mt19937 rng(std::random_device{}());
+
+    auto delay = BACKOFF_BASE * (1LL << std::min(attempts, 6));
+    if (delay > BACKOFF_MAX)
+        delay = std::chrono::duration_cast<std::chrono::milliseconds>(BACKOFF_MAX);
+
+    std::uniform_int_distribution<long long> jitter(0, JITTER_MAX.count());
+    return delay + std::chrono::milliseconds(jitter(rng));
+}
+
+void pump();
+
+// Callback de l'appelant, dans le contexte de trace qui a soumis l'appel.
+void notify_done(const JobPtr& job, const dpp::confirmation_callback_t& cb) {
+    if (!job->on_done)
+        return;
+
+    // Les appels enchaînés depuis le callback restent dans la même trace.
+    const trace::Scope scope(job->trace);
+    try {
+        job->on_done(cb);
+    } catch (const std::exception& ex) {
+        std::cerr << "[REST] Exception dans le callback " << job->route
+                  << " : " << ex.what() << "\n";
+    }
+}
+
+// Réponse d'erreur synthétique (l'appel n'a pas pu partir) : is_error() et
+// get_error().message la voient comme une erreur Discord, statut 0.
+dpp::confirmation_callback_t local_error(const std::string& message) {
+    dpp::http_request_completion_t http;
+    http.status = 0;
+    http.body = dpp::json({
+        {"code", 0},
+        {"message", message},
+        {"errors", dpp::json::object()}
+    }).dump();
+
+    dpp::confirmation_callback_t cb;
+    cb.bot = g_cluster;
+    cb.http_info = http;
+    return cb;
+}
+
+void on_complete(const JobPtr& job, const dpp::confirmation_callback_t& cb) {
+    const auto now = Clock::now();
+    const auto& http = cb.http_info;
+
+    bool retry = false;
+    Clock::duration wait {};
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+
+        {
+            Bucket& sent = g_buckets[job->bucket_key];
+            if (sent.in_flight > 0)
+                sent.in_flight--;
+        }
+
+        if (!http.ratelimit_bucket.empty()) {
+            g_route_bucket[job->route] = http.ratelimit_bucket;
+        }
+
+        Bucket& b = g_buckets[bucket_key_for(job->route)];
+
+        if (http.ratelimit_limit > 0) {
+            b.limit     = static_cast<long long>(http.ratelimit_limit);
+            b.remaining = static_cast<long long>(http.ratelimit_remaining);
+            b.reset_at  = now + std::chrono::seconds(http.ratelimit_reset_after);
+        }
+
+        if (http.status == 429) {
+            g_rate_limited.fetch_add(1, std::memory_order_relaxed);
+
+            wait = std::chrono::seconds(std::max<std::uint64_t>(http.ratelimit_retry_after, 1));
+            if (http.ratelimit_global) {
+                g_global_until = std::max(g_global_until, now + wait);
+            } else {
+                b.blocked_until = std::max(b.blocked_until, now + wait);
+                b.remaining = 0;
+            }
+            retry = true;
+        } else if (cb.is_error() && (http.status >= 500 || http.status == 0) &&
+                   job->retry == Retry::transient) {
+            // Erreur serveur ou réseau : on retente, le reste est définitif.
+            // Pas pour les créations : Discord a pu créer l'objet avant l'erreur.
+            retry = true;
+        }
+
+        if (retry && job->attempts + 1 < job->max_attempts) {
+            job->attempts++;
+            job->not_before = now + std::max(wait, backoff_for(job->attempts));
+            g_queue.push(job);
+            g_retried.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            retry = false;
+        }
+    }
+
+    if (!retry) {
+        job->latency->observe_since(job->submitted_at);
+
+        job->span.attr("http.status_code", static_cast<std::int64_t>(http.status));
+        job->span.attr("discord.attempts", static_cast<std::int64_t>(job->attempts + 1));
+        if (cb.is_error())
+            job->span.error(cb.get_error().message);
+        job->span.end();
+
+        if (cb.is_error()) {
+            g_failed.fetch_add(1, std::memory_order_relaxed);
+            job->errors->add();
+            if (http.status == 429 || http.status >= 500 || http.status == 0) {
+                std::cerr << "[REST] Abandon " << job->route << " après "
+                          << (job->attempts + 1) << " tentative(s) : "
+                          << cb.get_error().message << "\n";
+            }
+        } else {
+            g_completed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        notify_done(job, cb);
+    }
+
+    pump();
+}
+
+void pump() {
+    std::vector<JobPtr> ready;
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        const auto now = Clock::now();
+
+        if (g_global_until > now)
+            return;
+
+        std::vector<JobPtr> held;
+        std::size_t scanned = 0;
+
+        while (!g_queue.empty() && scanned < PUMP_SCAN_LIMIT) {
+            JobPtr job = g_queue.top();
+            g_queue.pop();
+            ++scanned;
+
+            if (job->not_before > now) {
+                held.push_back(std::move(job));
+                continue;
+            }
+
+            std::string key = bucket_key_for(job->route);
+            Bucket& b = g_buckets[key];
+            if (!bucket_allows(b, now)) {
+                held.push_back(std::move(job));
+                continue;
+            }
+
+            b.in_flight++;
+            job->bucket_key = std::move(key);
+            ready.push_back(std::move(job));
+        }
+
+        for (auto& job : held) {
+            g_queue.push(std::move(job));
+        }
+    }
+
+    for (auto& job : ready) {
+        try {
+            job->dispatch([job](const dpp::confirmation_callback_t& cb) {
+                on_complete(job, cb);
+            });
+        } catch (const std::exception& ex) {
+            std::cerr << "[REST] Erreur envoi " << job->route << " : " << ex.what() << "\n";
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                Bucket& b = g_buckets[job->bucket_key];
+                if (b.in_flight > 0)
+                    b.in_flight--;
+            }
+            g_failed.fetch_add(1, std::memory_order_relaxed);
+            job->errors->add();
+            job->span.error(ex.what());
+            job->span.end();
+
+            // L'appelant attend une réponse (co_role_create...) : elle vient d'ici.
+            notify_done(job, local_error(ex.what()));
+        }
+    }
+}
+
+} // namespace
+
+void init(dpp::cluster* cluster) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_cluster)
+            return;
+        g_cluster = cluster;
+    }
+
+    // Les timers DPP sont à la seconde : le tick sert aux reprises différées,
+    // les envois immédiats partent dès submit() ou dès qu'une réponse libère le bucket.
+    cluster->start_timer([](dpp::timer) { pump(); }, 1);
+}
+
+void submit(const std::string& route,
+            Priority prio,
+            Dispatch dispatch,
+            dpp::command_completion_event_t on_done,
+            int max_attempts,
+            Retry retry)
+{
+    auto job = std::make_shared<Job>();
+    job->route        = route;
+    job->prio         = prio;
+    job->dispatch     = std::move(dispatch);
+    job->on_done      = std::move(on_done);
+    job->max_attempts = std::max(1, max_attempts);
+    job->retry        = retry;
+
+    // "message_edit:<channel_id>" -> "message_edit" : une série par type d'appel.
+    const std::string_view kind = std::string_view(route).substr(0, route.find(':'));
+    job->submitted_at = Clock::now();
+    job->latency      = &metrics::histogram("sot_rest_request_duration_seconds", {{"route", kind}});
+    job->errors       = &metrics::counter("sot_rest_request_errors_total", {{"route", kind}});
+
+    job->trace = trace::current();
+    job->span  = trace::Span("discord.rest " + std::string(kind), trace::Span::Kind::client);
+    job->span.attr("discord.route", route);
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        job->seq = g_seq++;
+        g_queue.push(std::move(job));
+    }
+
+    g_submitted.fetch_add(1, std::memory_order_relaxed);
+    pump();
+}
+
+Stats stats() {
+    Stats s;
+    s.submitted    = g_submitted.load(std::memory_order_relaxed);
+    s.completed    = g_completed.load(std::memory_order_relaxed);
+    s.failed       = g_failed.load(std::memory_order_relaxed);
+    s.retried      = g_retried.load(std::memory_order_relaxed);
+    s.rate_limited = g_rate_limited.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    s.queued = g_queue.size();
+    for (const auto& [key, b] : g_buckets) {
+        s.in_flight += static_cast<std::size_t>(std::max(b.in_flight, 0));
+    }
+    return s;
+}
+
+void role_create(dpp::cluster* cluster, const dpp::role& r, Priority prio,
+                 dpp::command_completion_event_t on_done)
+{
+    submit("role_create:" + std::to_string(r.guild_id), prio,
+           [cluster, r](dpp::command_completion_event_t done) { cluster->role_create(r, done); },
+           std::move(on_done), 5, Retry::rate_limit_only);
+}
+
+void role_delete(dpp::cluster* cluster, dpp::snowflake guild_id, dpp::snowflake role_id,
+                 Priority prio, dpp::command_completion_event_t on_done)
+{
+    submit("role_delete:" + std::to_string(guild_id), prio,
+           [cluster, guild_id, role_id](dpp::command_completion_event_t done) {
+               cluster->role_delete(guild_id, role_id, done);
+           },
+           std::move(on_done));
+}
+
+void channel_create(dpp::cluster* cluster, const dpp::channel& ch, Priority prio,
+                    dpp::command_completion_event_t on_done)
+{
+    submit("channel_create:" + std::to_string(ch.guild_id), prio,
+           [cluster, ch](dpp::command_completion_event_t done) { cluster->channel_create(ch, done); },
+           std::move(on_done), 5, Retry::rate_limit_only);
+}
+
+void channel_delete(dpp::cluster* cluster, dpp::snowflake channel_id, Priority prio,
+                    dpp::command_completion_event_t on_done)
+{
+    submit("channel_delete:" + std::to_string(channel_id), prio,
+           [cluster, channel_id](dpp::command_completion_event_t done) {
+               cluster->channel_delete(channel_id, done);
+           },
+           std::move(on_done));
+}
+
+void member_add_role(dpp::cluster* cluster, dpp::snowflake guild_id, dpp::snowflake user_id,
+                     dpp::snowflake role_id, Priority prio,
+                     dpp::command_completion_event_t on_done)
+{
+    submit("member_role:" + std::to_string(guild_id), prio,
+           [cluster, guild_id, user_id, role_id](dpp::command_completion_event_t done) {
+               cluster->guild_member_add_role(guild_id, user_id, role_id, done);
+           },
+           std::move(on_done));
+}
+
+void member_remove_role(dpp::cluster* cluster, dpp::snowflake guild_id, dpp::snowflake user_id,
+                        dpp::snowflake role_id, Priority prio,
+                        dpp::command_completion_event_t on_done)
+{
+    submit("member_role:" + std::to_string(guild_id), prio,
+           [cluster, guild_id, user_id, role_id](dpp::command_completion_event_t done) {
+               cluster->guild_member_remove_role(guild_id, user_id, role_id, done);
+           },
+           std::move(on_done));
+}
+
+void member_edit(dpp::cluster* cluster, const dpp::guild_member& member, Priority prio,
+                 dpp::command_completion_event_t on_done)
+{
+    submit("member_edit:" + std::to_string(member.guild_id), prio,
+           [cluster, member](dpp::command_completion_event_t done) {
+               cluster->guild_edit_member(member, done);
+           },
+           std::move(on_done));
+}
+
+void member_get(dpp::cluster* cluster, dpp::snowflake guild_id, dpp::snowflake user_id,
+                Priority prio, dpp::command_completion_event_t on_done)
+{
+    submit("member_get:" + std::to_string(guild_id), prio,
+           [cluster, guild_id, user_id](dpp::command_completion_event_t done) {
+               cluster->guild_get_member(guild_id, user_id, done);
+           },
+           std::move(on_done));
+}
+
+void message_create(dpp::cluster* cluster, const dpp::message& msg, Priority prio,
+                    dpp::command_completion_event_t on_done)
+{
+    submit("message_create:" + std::to_string(msg.channel_id), prio,
+           [cluster, msg](dpp::command_completion_event_t done) { cluster->message_create(msg, done); },
+           std::move(on_done), 5, Retry::rate_limit_only);
+}
+
+void message_edit(dpp::cluster* cluster, const dpp::message& msg, Priority prio,
+                  dpp::command_completion_event_t on_done)
+{
+    submit("message_edit:" + std::to_string(msg.channel_id), prio,
+           [cluster, msg](dpp::command_completion_event_t done) { cluster->message_edit(msg, done); },
+           std::move(on_done));
+}
+
+void message_delete(dpp::cluster* cluster, dpp::snowflake message_id, dpp::snowflake channel_id,
+                    Priority prio, dpp::command_completion_event_t on_done)
+{
+    submit("message_delete:" + std::to_string(channel_id), prio,
+           [cluster, message_id, channel_id](dpp::command_completion_event_t done) {
+               cluster->message_delete(message_id, channel_id, done);
+           },
+           std::move(on_done));
+}
+
+#ifdef DPP_CORO
+dpp::async<dpp::confirmation_callback_t> co_role_create(dpp::cluster* cluster, const dpp::role& r,
+                                                        Priority prio)
+{
+    return dpp::async<dpp::confirmation_callback_t>{
+        [cluster, &r, prio](auto&& cb) { role_create(cluster, r, prio, std::forward<decltype(cb)>(cb)); }
+    };
+}
+
+dpp::async<dpp::confirmation_callback_t> co_channel_create(dpp::cluster* cluster, const dpp::channel& ch,
+                                                           Priority prio)
+{
+    return dpp::async<dpp::confirmation_callback_t>{
+        [cluster, &ch, prio](auto&& cb) { channel_create(cluster, ch, prio, std::forward<decltype(cb)>(cb)); }
+    };
+}
+
+dpp::async<dpp::confirmation_callback_t> co_message_create(dpp::cluster* cluster, const dpp::message& msg,
+                                                           Priority prio)
+{
+    return dpp::async<dpp::confirmation_callback_t>{
+        [cluster, &msg, prio](auto&& cb) { message_create(cluster, msg, prio, std::forward<decltype(cb)>(cb)); }
+    };
+}
+#endif
+
+bool is_not_found(const dpp::confirmation_callback_t& cb) {
+    return cb.is_error() && cb.http_info.status == 404;
+}
+
+} // namespace rest_scheduler
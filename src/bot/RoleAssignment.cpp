@@ -0,0 +1,246 @@
+#include "bot/RoleAssignment.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace role_assignment {
+
+namespace {
+
+// Éditions de membre simultanées pour un même lot ; le scheduler REST
+// gère ensuite le bucket Discord.
+constexpr std::size_t MAX_PARALLEL_EDITS = 4;
+
+struct Batch {
+    dpp::cluster* cluster = nullptr;
+    dpp::snowflake guild_id = 0;
+    rest_scheduler::Priority prio = rest_scheduler::Priority::normal;
+    Callback on_finished;
+
+    std::vector<std::pair<std::uint64_t, std::vector<std::uint64_t>>> users;
+
+    std::mutex mutex;
+    std::size_t next = 0;
+    std::size_t in_flight = 0;
+    std::size_t done = 0;
+    std::size_t next_progress = 0;
+    Report report;
+    std::chrono::steady_clock::time_point start;
+};
+
+using BatchPtr = std::shared_ptr<Batch>;
+
+void pump(const BatchPtr& batch);
+
+void finish_user(const BatchPtr& batch,
+                 std::uint64_t user_id,
+                 bool fallback,
+                 const std::string& error)
+{
+    bool finished = false;
+    Report report;
+
+    {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+
+        if (!error.empty()) {
+            batch->report.failed++;
+            batch->report.errors.emplace_back(user_id, error);
+        } else if (fallback) {
+            batch->report.fallback++;
+        } else {
+            batch->report.applied++;
+        }
+
+        batch->in_flight--;
+        batch->done++;
+
+        if (batch->done >= batch->next_progress && batch->done < batch->users.size()) {
+            std::cout << "[Roles] Guild " << batch->guild_id << " : "
+                      << batch->done << "/" << batch->users.size() << " joueur(s) traité(s)\n";
+            batch->next_progress += std::max<std::size_t>(1, batch->users.size() / 4);
+        }
+
+        if (batch->done == batch->users.size()) {
+            batch->report.elapsed_ms = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - batch->start
+                ).count()
+            );
+            report = batch->report;
+            finished = true;
+        }
+    }
+
+    if (finished) {
+        if (batch->on_finished)
+            batch->on_finished(report);
+        return;
+    }
+
+    pump(batch);
+}
+
+// Un appel par rôle : utilisé quand on ne connaît pas les rôles actuels du membre.
+void add_roles_one_by_one(const BatchPtr& batch,
+                          std::uint64_t user_id,
+                          const std::vector<std::uint64_t>& roles)
+{
+    struct Pending {
+        std::mutex mutex;
+        std::size_t remaining = 0;
+        std::string error;
+    };
+    auto pending = std::make_shared<Pending>();
+    pending->remaining = roles.size();
+
+    for (std::uint64_t role_id : roles) {
+        rest_scheduler::member_add_role(
+            batch->cluster,
+            batch->guild_id,
+            static_cast<dpp::snowflake>(user_id),
+            static_cast<dpp::snowflake>(role_id),
+            batch->prio,
+            [batch, user_id, pending](const dpp::confirmation_callback_t& cb) {
+                std::string error;
+                {
+                    std::lock_guard<std::mutex> lock(pending->mutex);
+                    if (cb.is_error() && pending->error.empty()) {
+                        pending->error = cb.get_error().message;
+                    }
+                    if (--pending->remaining != 0)
+                        return;
+                    error = pending->error;
+                }
+                finish_user(batch, user_id, true, error);
+            }
+        );
+    }
+}
+
+// member doit être lu juste avant l'appel : le PATCH remplace la liste complète
+// des rôles, un instantané ancien annulerait les changements faits entre-temps.
+void edit_member(const BatchPtr& batch,
+                 dpp::guild_member member,
+                 std::uint64_t user_id,
+                 const std::vector<std::uint64_t>& roles)
+{
+    bool changed = false;
+    for (std::uint64_t role_id : roles) {
+        dpp::snowflake r(role_id);
+        if (std::find(member.roles.begin(), member.roles.end(), r) == member.roles.end()) {
+            member.roles.push_back(r);
+            changed = true;
+        }
+    }
+
+    if (!changed) {
+        finish_user(batch, user_id, false, {});
+        return;
+    }
+
+    member.guild_id = batch->guild_id;
+
+    rest_scheduler::member_edit(
+        batch->cluster,
+        member,
+        batch->prio,
+        [batch, user_id, roles](const dpp::confirmation_callback_t& cb) {
+            if (!cb.is_error()) {
+                finish_user(batch, user_id, false, {});
+                return;
+            }
+
+            // Édition refusée (permissions sur un autre champ, membre parti...) :
+            // on retombe sur les ajouts unitaires, qui ne touchent qu'aux rôles.
+            std::cerr << "[Roles] Édition du membre " << user_id << " refusée ("
+                      << cb.get_error().message << "), ajout rôle par rôle.\n";
+            add_roles_one_by_one(batch, user_id, roles);
+        }
+    );
+}
+
+void apply_user(const BatchPtr& batch,
+                std::uint64_t user_id,
+                const std::vector<std::uint64_t>& roles)
+{
+    // Rôles actuels relus juste avant l'édition, toujours par un GET du membre :
+    // le bot n'a pas l'intent GUILD_MEMBERS, le cache DPP ne reçoit donc pas
+    // les GUILD_MEMBER_UPDATE et ses rôles peuvent être périmés. L'édition
+    // envoie la liste complète : partir d'un cache périmé retirerait les rôles
+    // donnés depuis.
+    rest_scheduler::member_get(
+        batch->cluster,
+        batch->guild_id,
+        static_cast<dpp::snowflake>(user_id),
+        batch->prio,
+        [batch, user_id, roles](const dpp::confirmation_callback_t& cb) {
+            if (cb.is_error()) {
+                // Membre introuvable : les ajouts unitaires ne dépendent pas de ses rôles actuels.
+                std::cerr << "[Roles] Membre " << user_id << " indisponible ("
+                          << cb.get_error().message << "), ajout rôle par rôle.\n";
+                add_roles_one_by_one(batch, user_id, roles);
+                return;
+            }
+
+            edit_member(batch, cb.get<dpp::guild_member>(), user_id, roles);
+        }
+    );
+}
+
+void pump(const BatchPtr& batch) {
+    std::vector<std::size_t> to_start;
+
+    {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        while (batch->in_flight < MAX_PARALLEL_EDITS && batch->next < batch->users.size()) {
+            to_start.push_back(batch->next++);
+            batch->in_flight++;
+        }
+    }
+
+    for (std::size_t i : to_start) {
+        const auto& [user_id, roles] = batch->users[i];
+        apply_user(batch, user_id, roles);
+    }
+}
+
+} // namespace
+
+void assign(dpp::cluster* cluster,
+            std::uint64_t guild_id,
+            Targets targets,
+            rest_scheduler::Priority prio,
+            Callback on_finished)
+{
+    auto batch = std::make_shared<Batch>();
+    batch->cluster     = cluster;
+    batch->guild_id    = static_cast<dpp::snowflake>(guild_id);
+    batch->prio        = prio;
+    batch->on_finished = std::move(on_finished);
+    batch->start       = std::chrono::steady_clock::now();
+
+    for (auto& [user_id, roles] : targets) {
+        std::sort(roles.begin(), roles.end());
+        roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+        roles.erase(std::remove(roles.begin(), roles.end(), 0), roles.end());
+        if (user_id != 0 && !roles.empty()) {
+            batch->users.emplace_back(user_id, std::move(roles));
+        }
+    }
+    batch->report.users  = batch->users.size();
+    batch->next_progress = std::max<std::size_t>(1, batch->users.size() / 4);
+
+    if (!cluster || batch->users.empty()) {
+        if (batch->on_finished)
+            batch->on_finished(batch->report);
+        return;
+    }
+
+    pump(batch);
+}
+
+} // namespace role_assignment
@@ -0,0 +1,329 @@
+#include "bot/RosterRender.hpp"
+#include "util/TimeZone.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+
+namespace alliance_helpers {
+
+namespace {
+
+// "7h05" : heure sans zéro, minutes sur deux chiffres.
+std::size_t hhmm_chars(std::time_t t, const TimeZone& zone, char (&out)[8]) {
+    const std::tm tm = zone.to_local(t);
+    char* p = std::to_chars(out, out + 2, tm.tm_hour).ptr;
+    *p++ = 'h';
+    *p++ = static_cast<char>('0' + tm.tm_min / 10);
+    *p++ = static_cast<char>('0' + tm.tm_min % 10);
+    return static_cast<std::size_t>(p - out);
+}
+
+// Tampon de rendu des embeds, un par thread et réutilisé d'un rendu à l'autre :
+// chaque champ y est composé puis copié dans l'embed, sans flux ni chaînes
+// intermédiaires. Après le premier rendu, sa capacité suffit.
+class RenderBuffer {
+public:
+    RenderBuffer() { out_.reserve(1024); } // limite Discord d'une valeur de champ
+
+    RenderBuffer& clear() {
+        out_.clear();
+        return *this;
+    }
+
+    RenderBuffer& operator<<(std::string_view s) {
+        out_.append(s.data(), s.size());
+        return *this;
+    }
+
+    RenderBuffer& operator<<(char c) {
+        out_.push_back(c);
+        return *this;
+    }
+
+    RenderBuffer& operator<<(std::uint64_t v) {
+        char buf[20];
+        return *this << std::string_view(buf, static_cast<std::size_t>(std::to_chars(buf, buf + sizeof(buf), v).ptr - buf));
+    }
+
+    RenderBuffer& operator<<(int v) {
+        char buf[12];
+        return *this << std::string_view(buf, static_cast<std::size_t>(std::to_chars(buf, buf + sizeof(buf), v).ptr - buf));
+    }
+
+    // Deux chiffres au moins : 05, 12.
+    RenderBuffer& pad2(int v) {
+        if (v >= 0 && v < 10)
+            out_.push_back('0');
+        return *this << v;
+    }
+
+    RenderBuffer& mention(std::uint64_t user_id) {
+        return *this << "<@" << user_id << '>';
+    }
+
+    RenderBuffer& hhmm(std::time_t t, const TimeZone& zone) {
+        char buf[8];
+        return *this << std::string_view(buf, hhmm_chars(t, zone, buf));
+    }
+
+    const std::string& str() const { return out_; }
+
+private:
+    std::string out_;
+};
+
+struct RenderBuffers {
+    RenderBuffer text;
+    RenderBuffer name; // nom de champ, composé pendant que text tient la valeur
+};
+
+RenderBuffers& render_buffers() {
+    thread_local RenderBuffers buffers;
+    return buffers;
+}
+
+} // namespace
+
+std::string french_day_name(const std::tm& tm) {
+    static const char* days[] = {
+        "Dimanche", "Lundi", "Mardi", "Mercredi",
+        "Jeudi", "Vendredi", "Samedi"
+    };
+    int idx = tm.tm_wday;
+    if (idx < 0 || idx > 6) idx = 0;
+    return days[idx];
+}
+
+std::string format_hhmm(std::time_t t, const TimeZone& zone) {
+    char buf[8];
+    return std::string(buf, hhmm_chars(t, zone, buf));
+}
+
+std::string hull_label(HullType h) {
+    switch (h) {
+        case HullType::sloop:   return "Sloop";
+        case HullType::brig:    return "Brigantin";
+        case HullType::galleon: return "Galion";
+    }
+    return "Brigantin";
+}
+
+int hull_capacity(HullType h) {
+    switch (h) {
+        case HullType::sloop:   return 2;
+        case HullType::brig:    return 3;
+        case HullType::galleon: return 4;
+    }
+    return 3;
+}
+
+namespace {
+
+// Limites Discord d'un message (longueurs en unités UTF-16, comme l'API).
+constexpr std::size_t EMBED_MAX_FIELDS        = 25;
+constexpr std::size_t EMBED_MAX_FIELD_NAME    = 256;
+constexpr std::size_t EMBED_MAX_FIELD_VALUE   = 1024;
+constexpr std::size_t MESSAGE_MAX_EMBEDS      = 10;
+constexpr std::size_t MESSAGE_MAX_EMBED_CHARS = 6000; // titres, descriptions et champs cumulés
+
+// Une ligne "• <@id>\n" au plus, et la ligne de résumé des remplaçants non listés.
+constexpr std::size_t MENTION_LINE_MAX  = 28;
+constexpr std::size_t OVERFLOW_LINE_MAX = 32;
+
+const char* const FLEET_CONTINUED_TITLE = "🚢 FLOTTE (suite)";
+
+// Longueur comptée par Discord : 1 par caractère, 2 hors du plan de base (emojis).
+std::size_t discord_length(std::string_view s) {
+    std::size_t n = 0;
+    for (unsigned char c : s) {
+        if ((c & 0xC0) != 0x80)
+            n += c >= 0xF0 ? 2 : 1;
+    }
+    return n;
+}
+
+// Répartit les champs du roster en embeds puis en messages. Chaque champ est
+// compté avant d'être placé : au-delà de 25 champs, l'embed suivant prend la
+// suite ; au-delà de 6000 caractères ou de 10 embeds, un nouveau message.
+class RosterLayout {
+public:
+    RosterLayout(std::vector<RosterPage>& pages, dpp::embed first)
+        : pages_(pages)
+    {
+        page_chars_ = embed_chars(first);
+        pages_.emplace_back();
+        pages_.back().push_back(std::move(first));
+    }
+
+    void add_field(const std::string& name, const std::string& value) {
+        const std::size_t cost =
+            std::min(discord_length(name), EMBED_MAX_FIELD_NAME) +
+            std::min(discord_length(value), EMBED_MAX_FIELD_VALUE);
+
+        if (page_chars_ + cost > MESSAGE_MAX_EMBED_CHARS) {
+            open_continuation(true);
+        } else if (pages_.back().back().fields.size() >= EMBED_MAX_FIELDS) {
+            open_continuation(pages_.back().size() >= MESSAGE_MAX_EMBEDS ||
+                              page_chars_ + title_chars() + cost > MESSAGE_MAX_EMBED_CHARS);
+        }
+
+        pages_.back().back().add_field(name, value, false);
+        page_chars_ += cost;
+    }
+
+private:
+    static std::size_t title_chars() {
+        static const std::size_t n = discord_length(FLEET_CONTINUED_TITLE);
+        return n;
+    }
+
+    static std::size_t embed_chars(const dpp::embed& e) {
+        std::size_t n = discord_length(e.title) + discord_length(e.description);
+        for (const auto& f : e.fields)
+            n += discord_length(f.name) + discord_length(f.value);
+        return n;
+    }
+
+    void open_continuation(bool new_page) {
+        if (new_page) {
+            pages_.emplace_back();
+            page_chars_ = 0;
+        }
+
+        dpp::embed e;
+        e.set_color(ALLIANCE_GOLD_COLOR);
+        e.set_title(FLEET_CONTINUED_TITLE);
+        pages_.back().push_back(std::move(e));
+        page_chars_ += title_chars();
+    }
+
+    std::vector<RosterPage>& pages_;
+    std::size_t page_chars_ = 0;
+};
+
+} // namespace
+
+std::vector<RosterPage> build_alliance_roster_pages(
+    const AllianceRosterData& data,
+    const TimeZone& zone
+)
+{
+    const Alliance& alliance = data.alliance;
+    const auto& ships        = data.ships;
+    const auto& by_ship      = data.by_ship;
+
+    std::time_t scheduled_at = alliance.scheduled_at();
+    std::time_t sale_at      = alliance.sale_at();
+
+    const std::tm tm_start = zone.to_local(scheduled_at);
+
+    const std::time_t replace_at = scheduled_at + 30 * 60;
+    const std::time_t rdv1       = sale_at - 30 * 60;
+    const std::time_t rdv2       = sale_at - 15 * 60;
+
+    RenderBuffers& buffers = render_buffers();
+    RenderBuffer& buf = buffers.text;
+
+    dpp::embed e;
+    e.set_color(ALLIANCE_GOLD_COLOR);
+    e.set_title("🏴‍☠️ Alliance programmée");
+
+    {
+        const std::string& bras_droit = alliance.right_hand();
+
+        buf.clear()
+            << "\n"
+            << "**Alliance** : **" << alliance.name() << "**\n"
+            << "**Jour/heure** : *" << french_day_name(tm_start) << ' ';
+        buf.pad2(tm_start.tm_mday) << '/';
+        buf.pad2(tm_start.tm_mon + 1) << "* de ";
+        buf.hhmm(scheduled_at, zone) << " à ";
+        buf.hhmm(sale_at, zone) << "\n";
+
+        buf << "**Organisateur** : ";
+        buf.mention(alliance.organizer_id()) << "\n";
+
+        buf << "**Bras droit** : "
+            << (bras_droit.empty() ? std::string_view("_non défini_") : std::string_view(bras_droit)) << "\n";
+
+        buf << "**Reprise des bateaux** : "
+            << (alliance.ships_reuse_planned() ? "✅ Prévu" : "❌ Non prévu") << "\n";
+
+        e.set_description(buf.str());
+    }
+
+    std::vector<RosterPage> pages;
+    RosterLayout layout(pages, std::move(e));
+
+    {
+        buf.clear() << "\n" << "- Début des try à **";
+        buf.hhmm(scheduled_at, zone) << "**, remplacement des retardataires à **";
+        buf.hhmm(replace_at, zone) << "**\n" << "- RDV vers **";
+        buf.hhmm(rdv1, zone) << '-';
+        buf.hhmm(rdv2, zone) << "** pour vendre à **";
+        buf.hhmm(sale_at, zone) << "**";
+
+        layout.add_field("📜 Déroulement", buf.str());
+    }
+
+    if (ships.empty()) {
+        layout.add_field("🚢 FLOTTE", "\n_Aucun bateau configuré pour cette alliance._");
+        return pages;
+    }
+
+    layout.add_field("🚢 FLOTTE", "\u200b");
+
+    static const std::vector<AllianceParticipant> no_participants;
+
+    for (const Ship& ship : ships) {
+        const int cap = hull_capacity(ship.hull_type());
+
+        // Déjà triés par date d'inscription au chargement (ORDER BY joined_at).
+        auto it = by_ship.find(ship.id());
+        const std::vector<AllianceParticipant>& participants =
+            it != by_ship.end() ? it->second : no_participants;
+        const int nb = static_cast<int>(participants.size());
+
+        buf.clear();
+
+        // Slots principaux
+        for (int i = 0; i < cap; ++i) {
+            if (i < nb) {
+                buf << "• ";
+                buf.mention(participants[i].user_id()) << "\n";
+            } else {
+                buf << "• _dispo_\n";
+            }
+        }
+
+        // Remplaçants : italique, plus discret, pas de ligne vide avant,
+        // pas de double saut de ligne entre bateaux.
+        if (nb > cap) {
+            buf << "*Remplaçants :*\n";
+            for (int i = cap; i < nb; ++i) {
+                // Valeur limitée à 1024 caractères : les derniers inscrits sont résumés.
+                if (buf.str().size() + MENTION_LINE_MAX + OVERFLOW_LINE_MAX > EMBED_MAX_FIELD_VALUE) {
+                    buf << "• _+" << (nb - i) << " autres_\n";
+                    break;
+                }
+                buf << "• ";
+                buf.mention(participants[i].user_id()) << "\n";
+            }
+        } else {
+            buf << "*Remplaçants :* _aucun_\n";
+        }
+
+        const std::string& role = ship.crew_role();
+        buffers.name.clear()
+            << hull_label(ship.hull_type()) << " - "
+            << (role.empty() ? std::string_view("Libre") : std::string_view(role))
+            << " [" << std::min(nb, cap) << '/' << cap << ']';
+
+        layout.add_field(buffers.name.str(), buf.str());
+    }
+
+    return pages;
+}
+
+} // namespace alliance_helpers
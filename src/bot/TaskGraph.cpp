@@ -0,0 +1,198 @@
+#include "bot/TaskGraph.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+enum class State { waiting, running, succeeded, failed, skipped };
+
+struct Node {
+    std::string name;
+    TaskGraph::Run run;
+    bool always_run = false;
+
+    std::size_t unmet = 0;           // dépendances non terminées
+    bool dep_failed = false;
+    std::vector<TaskGraph::Id> dependents;
+    State state = State::waiting;
+};
+
+} // namespace
+
+struct TaskGraph::Impl : std::enable_shared_from_this<TaskGraph::Impl> {
+    std::size_t max_parallel = 1;
+
+    std::mutex mutex;
+    std::vector<Node> nodes;
+    std::deque<Id> ready;
+    bool started = false;
+    bool finished = false;
+    Progress progress;
+    std::chrono::steady_clock::time_point start;
+
+    ProgressCallback on_progress;
+    ProgressCallback on_finished;
+
+    std::uint64_t elapsed_ms() const {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start
+            ).count()
+        );
+    }
+
+    // Sous verrou : propage la fin de `id` à ses dépendants.
+    void settle(Id id, State state) {
+        std::vector<std::pair<Id, State>> stack { { id, state } };
+
+        while (!stack.empty()) {
+            auto [cur, st] = stack.back();
+            stack.pop_back();
+
+            Node& n = nodes[cur];
+            n.state = st;
+
+            switch (st) {
+                case State::succeeded: progress.succeeded++; break;
+                case State::failed:    progress.failed++;    progress.failures.push_back(n.name); break;
+                case State::skipped:   progress.skipped++;   progress.failures.push_back(n.name); break;
+                default: break;
+            }
+
+            for (Id d : n.dependents) {
+                Node& dep = nodes[d];
+                if (st != State::succeeded)
+                    dep.dep_failed = true;
+                if (--dep.unmet != 0)
+                    continue;
+
+                if (dep.dep_failed && !dep.always_run) {
+                    stack.emplace_back(d, State::skipped);
+                } else {
+                    ready.push_back(d);
+                }
+            }
+        }
+    }
+
+    void pump() {
+        std::vector<Id> to_run;
+        bool done = false;
+        Progress snapshot;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            while (progress.running < max_parallel && !ready.empty()) {
+                Id id = ready.front();
+                ready.pop_front();
+                nodes[id].state = State::running;
+                progress.running++;
+                to_run.push_back(id);
+            }
+
+            if (!finished && progress.running == 0 && ready.empty() &&
+                progress.finished() == progress.total)
+            {
+                finished = true;
+                done = true;
+                progress.elapsed_ms = elapsed_ms();
+                snapshot = progress;
+            }
+        }
+
+        if (done) {
+            if (on_finished)
+                on_finished(snapshot);
+            return;
+        }
+
+        for (Id id : to_run) {
+            auto self = shared_from_this();
+            try {
+                nodes[id].run([self, id](bool ok) { self->complete(id, ok); });
+            } catch (const std::exception& ex) {
+                std::cerr << "[TaskGraph] Tâche '" << nodes[id].name
+                          << "' : " << ex.what() << "\n";
+                complete(id, false);
+            }
+        }
+    }
+
+    void complete(Id id, bool ok) {
+        Progress snapshot;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (nodes[id].state != State::running)
+                return; // Done appelé deux fois
+
+            progress.running--;
+            settle(id, ok ? State::succeeded : State::failed);
+            progress.elapsed_ms = elapsed_ms();
+            snapshot = progress;
+        }
+
+        if (on_progress)
+            on_progress(snapshot);
+
+        pump();
+    }
+};
+
+TaskGraph::TaskGraph(std::size_t max_parallel)
+    : impl_(std::make_shared<Impl>())
+{
+    impl_->max_parallel = std::max<std::size_t>(1, max_parallel);
+}
+
+TaskGraph::Id TaskGraph::add(std::string name, std::vector<Id> deps, Run run, bool always_run) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (impl_->started)
+        throw std::logic_error("TaskGraph::add après start()");
+
+    const Id id = impl_->nodes.size();
+
+    Node n;
+    n.name       = std::move(name);
+    n.run        = std::move(run);
+    n.always_run = always_run;
+
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+    for (Id d : deps) {
+        if (d >= id)
+            throw std::logic_error("TaskGraph::add : dépendance inconnue");
+        impl_->nodes[d].dependents.push_back(id);
+    }
+    n.unmet = deps.size();
+
+    impl_->nodes.push_back(std::move(n));
+    impl_->progress.total++;
+    return id;
+}
+
+void TaskGraph::start(ProgressCallback on_progress, ProgressCallback on_finished) {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (impl_->started)
+            return;
+
+        impl_->started     = true;
+        impl_->start       = std::chrono::steady_clock::now();
+        impl_->on_progress = std::move(on_progress);
+        impl_->on_finished = std::move(on_finished);
+
+        for (Id id = 0; id < impl_->nodes.size(); ++id) {
+            if (impl_->nodes[id].unmet == 0)
+                impl_->ready.push_back(id);
+        }
+    }
+
+    impl_->pump();
+}
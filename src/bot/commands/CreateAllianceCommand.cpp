@@ -10,15 +10,17 @@
 #include "bot_settings-odb.hxx"
 
 #include "bot/ui/CreateAllianceUI.hpp"
+#include "bot/Deferral.hpp"
+#include "db/BotSettingsCache.hpp"
 
-void CreateAllianceCommand::handle(const dpp::slashcommand_t& event,
-                                   const std::shared_ptr<odb::pgsql::database>& db) const
+dpp::task<void> CreateAllianceCommand::co_handle(dpp::slashcommand_t event,
+                                                 std::shared_ptr<odb::pgsql::database> db) const
 {
     if (event.command.guild_id == 0) {
         dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
-        return;
+        deferral::reply(event, msg);
+        co_return;
     }
 
     const std::uint64_t guild_id   = static_cast<std::uint64_t>(event.command.guild_id);
@@ -27,24 +29,18 @@ void CreateAllianceCommand::handle(const dpp::slashcommand_t& event,
     std::uint64_t commands_channel_id = 0;
 
     try {
-        odb::transaction t(db->begin());
-
-        std::unique_ptr<BotSettings> settings;
-        try {
-            settings.reset(db->load<BotSettings>(guild_id));
-        } catch (const odb::object_not_persistent&) {
-            t.commit();
+        auto settings = bot_settings_cache::get(*db, guild_id);
+        if (!settings) {
             dpp::message msg(
                 "❌ Ce serveur n'est pas encore configuré.\n"
                 "Lance d'abord `/setup` pour définir les salons et rôles."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
-            return;
+            deferral::reply(event, msg);
+            co_return;
         }
 
         commands_channel_id = settings->command_channel_id();
-        t.commit();
     }
     catch (const std::exception& ex) {
         dpp::message msg(
@@ -52,8 +48,8 @@ void CreateAllianceCommand::handle(const dpp::slashcommand_t& event,
             + ex.what()
         );
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
-        return;
+        deferral::reply(event, msg);
+        co_return;
     }
 
     if (commands_channel_id == 0) {
@@ -62,8 +58,8 @@ void CreateAllianceCommand::handle(const dpp::slashcommand_t& event,
             "Va dans `/setup` → **Salons** pour définir le salon utilisé par le bot."
         );
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
-        return;
+        deferral::reply(event, msg);
+        co_return;
     }
 
     if (channel_id != commands_channel_id) {
@@ -73,9 +69,9 @@ void CreateAllianceCommand::handle(const dpp::slashcommand_t& event,
             + mention + "."
         );
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
-        return;
+        deferral::reply(event, msg);
+        co_return;
     }
 
-    CreateAllianceUI::open_modal(event);
+    co_await CreateAllianceUI::open_modal(event, bot_settings_cache::zone(*db, guild_id));
 }
@@ -2,6 +2,7 @@
 
 #include <dpp/dpp.h>
 
+#include "bot/Deferral.hpp"
 #include "bot/ui/JoinAllianceUI.hpp"
 
 void JoinAllianceCommand::handle(const dpp::slashcommand_t& event,
@@ -10,7 +11,7 @@ void JoinAllianceCommand::handle(const dpp::slashcommand_t& event,
     if (event.command.guild_id == 0) {
         dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
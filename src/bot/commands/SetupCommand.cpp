@@ -2,13 +2,15 @@
 
 #include <dpp/dpp.h>
 
+#include "bot/Deferral.hpp"
+
 void SetupCommand::handle(const dpp::slashcommand_t& event,
                           const std::shared_ptr<odb::pgsql::database>& /*db*/) const
 {
     if (event.command.guild_id == 0) {
         dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
@@ -32,7 +34,7 @@ void SetupCommand::handle(const dpp::slashcommand_t& event,
             "❌ Tu dois être administrateur du serveur pour utiliser `/setup`."
         );
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
@@ -72,6 +74,6 @@ void SetupCommand::handle(const dpp::slashcommand_t& event,
 
     m.add_component(row);
 
-    event.reply(m);
+    deferral::reply(event, m);
 }
 
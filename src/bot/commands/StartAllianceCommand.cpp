@@ -3,6 +3,11 @@
 #include <sstream>
 #include <unordered_map>
 #include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <iostream>
+#include <mutex>
 #include <random>
 
 #include <dpp/dpp.h>
@@ -24,6 +29,17 @@
 #include "alliance_discord_objects-odb.hxx"
 
 #include "bot/AllianceHelpers.hpp"
+#include "bot/AllianceIndex.hpp"
+#include "bot/Deferral.hpp"
+#include "bot/Outbox.hpp"
+#include "bot/RestScheduler.hpp"
+#include "bot/RoleAssignment.hpp"
+#include "bot/TaskGraph.hpp"
+#include "db/DbExecutor.hpp"
+#include "db/TxMetrics.hpp"
+
+#include "util/Trace.hpp"
+#include "util/env.hpp"
 
 namespace {
 
@@ -33,6 +49,121 @@ struct CrewEntry {
     std::uint64_t ship_id;
 };
 
+// Identifiants produits par les tâches de /demarrer, lus par les tâches dépendantes.
+struct StartContext {
+    std::mutex mutex;
+    std::uint64_t member_role_id = 0;
+    std::uint64_t category_id    = 0;
+    role_assignment::Targets targets;
+    role_assignment::Report  roles;
+
+    // Objets déjà créés par une exécution précédente (événement d'outbox
+    // rejoué) : réutilisés au lieu d'être recréés.
+    std::multimap<std::pair<DiscordObjectType, std::string>, std::uint64_t> existing;
+};
+
+static std::uint64_t take_existing(
+    const std::shared_ptr<StartContext>& ctx,
+    DiscordObjectType type,
+    const std::string& name
+)
+{
+    std::lock_guard<std::mutex> lock(ctx->mutex);
+    auto it = ctx->existing.find({ type, name });
+    if (it == ctx->existing.end())
+        return 0;
+
+    std::uint64_t id = it->second;
+    ctx->existing.erase(it);
+    return id;
+}
+
+// Progression de /demarrer vers la réponse éphémère de l'interaction, tant
+// que le bot n'a pas redémarré entre-temps. Enregistré avant le commit de
+// l'événement d'outbox : le provisioning peut commencer avant que la réponse
+// soit envoyée, son dernier message est alors gardé jusqu'à l'envoi.
+struct StartWatcher {
+    std::function<void(const std::string&)> edit;
+    std::chrono::steady_clock::time_point last_edit {};
+    bool replied = false;
+    std::string pending;
+    bool pending_final = false;
+};
+
+std::mutex g_watchers_mutex;
+std::unordered_map<std::uint64_t, StartWatcher> g_watchers; // alliance_id -> watcher
+
+static void notify_watcher(std::uint64_t alliance_id, const std::string& content, bool final) {
+    std::function<void(const std::string&)> edit;
+
+    {
+        std::lock_guard<std::mutex> lock(g_watchers_mutex);
+        auto it = g_watchers.find(alliance_id);
+        if (it == g_watchers.end())
+            return;
+
+        if (!it->second.replied) {
+            it->second.pending = content;
+            it->second.pending_final = it->second.pending_final || final;
+            return;
+        }
+
+        // Un webhook d'interaction est limité en débit : au plus une édition par seconde.
+        const auto now = std::chrono::steady_clock::now();
+        if (!final && now - it->second.last_edit < std::chrono::seconds(1))
+            return;
+
+        it->second.last_edit = now;
+        edit = it->second.edit;
+        if (final)
+            g_watchers.erase(it);
+    }
+
+    edit(content);
+}
+
+static void watch_provision(std::uint64_t alliance_id, const dpp::slashcommand_t& event) {
+    std::lock_guard<std::mutex> lock(g_watchers_mutex);
+    StartWatcher& w = g_watchers[alliance_id];
+    w = StartWatcher {};
+    w.edit = [event](const std::string& content) {
+        dpp::message msg(content);
+        msg.set_flags(dpp::m_ephemeral);
+        event.edit_original_response(msg);
+    };
+}
+
+static void forget_watcher(std::uint64_t alliance_id) {
+    std::lock_guard<std::mutex> lock(g_watchers_mutex);
+    g_watchers.erase(alliance_id);
+}
+
+// Réponse envoyée : la progression reçue entre-temps part maintenant.
+static void watcher_replied(std::uint64_t alliance_id) {
+    std::function<void(const std::string&)> edit;
+    std::string content;
+
+    {
+        std::lock_guard<std::mutex> lock(g_watchers_mutex);
+        auto it = g_watchers.find(alliance_id);
+        if (it == g_watchers.end())
+            return;
+
+        it->second.replied = true;
+        if (it->second.pending.empty())
+            return;
+
+        edit = it->second.edit;
+        content = std::move(it->second.pending);
+        it->second.pending.clear();
+        it->second.last_edit = std::chrono::steady_clock::now();
+        if (it->second.pending_final)
+            g_watchers.erase(it);
+    }
+
+    edit(content);
+}
+
 static std::uint64_t parse_mention_id(const std::string& mention) {
     std::string digits;
     digits.reserve(mention.size());
@@ -59,6 +190,7 @@ static void persist_discord_object(
 ){
     try {
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "start.persist_object");
         AllianceDiscordObject obj(
             alliance_id,
             type,
@@ -74,17 +206,22 @@ static void persist_discord_object(
     }
 }
 
-template<typename F>
-static void create_role_and_record(
+// Coroutines de création : chacune réutilise l'objet d'une exécution
+// précédente s'il existe, sinon le crée via le scheduler REST et l'enregistre.
+// Retournent l'id Discord, ou 0 en cas d'échec.
+
+static dpp::task<std::uint64_t> co_create_role(
     dpp::cluster* cluster,
-    const std::shared_ptr<odb::pgsql::database>& db,
+    std::shared_ptr<odb::pgsql::database> db,
+    std::shared_ptr<StartContext> ctx,
     std::uint64_t guild_id,
     std::uint64_t alliance_id,
-    const std::string& role_name,
-    F&& on_created
+    std::string role_name
 )
 {
-    if (!cluster) return;
+    if (std::uint64_t id = take_existing(ctx, DiscordObjectType::role, role_name)) {
+        co_return id;
+    }
 
     dpp::role r;
     r.set_name(role_name);
@@ -103,86 +240,81 @@ static void create_role_and_record(
         r.flags |= dpp::r_mentionable;
     }
 
-    cluster->role_create(
-        r,
-        [db, alliance_id, role_name, on_created](const dpp::confirmation_callback_t& cb) mutable {
-            if (cb.is_error()) {
-                std::cerr << "[StartAlliance] Erreur création rôle '" << role_name
-                          << "' : " << cb.get_error().message << "\n";
-                return;
-            }
+    dpp::confirmation_callback_t cb =
+        co_await rest_scheduler::co_role_create(cluster, r, rest_scheduler::Priority::normal);
 
-            dpp::role created = cb.get<dpp::role>();
-            std::uint64_t role_id = static_cast<std::uint64_t>(created.id);
+    if (cb.is_error()) {
+        std::cerr << "[StartAlliance] Erreur création rôle '" << role_name
+                  << "' : " << cb.get_error().message << "\n";
+        co_return 0;
+    }
 
-            persist_discord_object(
-                db,
-                alliance_id,
-                DiscordObjectType::role,
-                role_id,
-                role_name
-            );
+    const std::uint64_t role_id = static_cast<std::uint64_t>(cb.get<dpp::role>().id);
 
-            on_created(role_id);
-        }
-    );
-}
+    co_await db_executor::run([&]() {
+        persist_discord_object(db, alliance_id, DiscordObjectType::role, role_id, role_name);
+    });
 
+    co_return role_id;
+}
 
-template<typename F>
-static void create_category_and_record(
+static dpp::task<std::uint64_t> co_create_category(
     dpp::cluster* cluster,
-    const std::shared_ptr<odb::pgsql::database>& db,
+    std::shared_ptr<odb::pgsql::database> db,
+    std::shared_ptr<StartContext> ctx,
     std::uint64_t guild_id,
     std::uint64_t alliance_id,
-    const std::string& name,
-    F&& on_created
+    std::string name
 )
 {
-    if (!cluster) return;
+    if (std::uint64_t id = take_existing(ctx, DiscordObjectType::category, name)) {
+        co_return id;
+    }
 
     dpp::channel cat;
     cat.set_name(name);
     cat.set_type(dpp::CHANNEL_CATEGORY);
     cat.set_guild_id(static_cast<dpp::snowflake>(guild_id));
 
-    cluster->channel_create(
-        cat,
-        [db, alliance_id, name, on_created](const dpp::confirmation_callback_t& cb) mutable {
-            if (cb.is_error()) {
-                std::cerr << "[StartAlliance] Erreur création catégorie '" << name
-                          << "' : " << cb.get_error().message << "\n";
-                return;
-            }
+    dpp::confirmation_callback_t cb =
+        co_await rest_scheduler::co_channel_create(cluster, cat, rest_scheduler::Priority::normal);
 
-            dpp::channel created = cb.get<dpp::channel>();
-            std::uint64_t cat_id = static_cast<std::uint64_t>(created.id);
+    if (cb.is_error()) {
+        std::cerr << "[StartAlliance] Erreur création catégorie '" << name
+                  << "' : " << cb.get_error().message << "\n";
+        co_return 0;
+    }
 
-            persist_discord_object(
-                db,
-                alliance_id,
-                DiscordObjectType::category,
-                cat_id,
-                name
-            );
+    const std::uint64_t cat_id = static_cast<std::uint64_t>(cb.get<dpp::channel>().id);
 
-            on_created(cat_id);
-        }
-    );
+    co_await db_executor::run([&]() {
+        persist_discord_object(db, alliance_id, DiscordObjectType::category, cat_id, name);
+    });
+
+    co_return cat_id;
 }
 
-static void create_generic_voice_channel(
+// Salon vocal de la catégorie, visible et joignable par le seul rôle membre.
+static dpp::task<std::uint64_t> co_create_voice_channel(
     dpp::cluster* cluster,
-    const std::shared_ptr<odb::pgsql::database>& db,
+    std::shared_ptr<odb::pgsql::database> db,
+    std::shared_ptr<StartContext> ctx,
     std::uint64_t guild_id,
     std::uint64_t alliance_id,
-    std::uint64_t category_id,
-    std::uint64_t member_role_id,
-    const std::string& vc_name,
+    std::string vc_name,
     std::uint16_t position
 )
 {
-    if (!cluster) return;
+    if (std::uint64_t id = take_existing(ctx, DiscordObjectType::voice_channel, vc_name)) {
+        co_return id;
+    }
+
+    std::uint64_t category_id, member_role_id;
+    {
+        std::lock_guard<std::mutex> lock(ctx->mutex);
+        category_id    = ctx->category_id;
+        member_role_id = ctx->member_role_id;
+    }
 
     dpp::channel vc;
     vc.set_name(vc_name);
@@ -205,42 +337,25 @@ static void create_generic_voice_channel(
     vc.permission_overwrites.push_back(po_everyone);
     vc.permission_overwrites.push_back(po_member);
 
-    cluster->channel_create(
-        vc,
-        [db, alliance_id, vc_name](const dpp::confirmation_callback_t& cb) {
-            if (cb.is_error()) {
-                std::cerr << "[StartAlliance] Erreur création salon vocal '"
-                          << vc_name << "' : " << cb.get_error().message << "\n";
-                return;
-            }
+    dpp::confirmation_callback_t cb =
+        co_await rest_scheduler::co_channel_create(cluster, vc, rest_scheduler::Priority::normal);
 
-            dpp::channel created = cb.get<dpp::channel>();
-            std::uint64_t ch_id = static_cast<std::uint64_t>(created.id);
+    if (cb.is_error()) {
+        std::cerr << "[StartAlliance] Erreur création salon vocal '"
+                  << vc_name << "' : " << cb.get_error().message << "\n";
+        co_return 0;
+    }
 
-            persist_discord_object(
-                db,
-                alliance_id,
-                DiscordObjectType::voice_channel,
-                ch_id,
-                vc_name
-            );
-        }
-    );
-}
+    const std::uint64_t ch_id = static_cast<std::uint64_t>(cb.get<dpp::channel>().id);
 
-static void create_voice_for_ship(
-    dpp::cluster* cluster,
-    const std::shared_ptr<odb::pgsql::database>& db,
-    std::uint64_t guild_id,
-    std::uint64_t alliance_id,
-    std::uint64_t category_id,
-    std::uint64_t member_role_id,
-    const Ship& ship,
-    std::uint16_t position 
-)
-{
-    if (!cluster) return;
+    co_await db_executor::run([&]() {
+        persist_discord_object(db, alliance_id, DiscordObjectType::voice_channel, ch_id, vc_name);
+    });
+
+    co_return ch_id;
+}
 
+static std::string ship_voice_name(const Ship& ship) {
     std::string hull = alliance_helpers::hull_label(ship.hull_type());
     std::string role = ship.crew_role().empty()
                      ? "Libre"
@@ -248,212 +363,349 @@ static void create_voice_for_ship(
 
     std::ostringstream name_oss;
     name_oss << hull << " - " << role;
-    std::string vc_name = name_oss.str();
+    return name_oss.str();
+}
 
-    dpp::channel vc;
-    vc.set_name(vc_name);
-    vc.set_type(dpp::CHANNEL_VOICE);
-    vc.set_parent_id(static_cast<dpp::snowflake>(category_id));
-    vc.set_guild_id(static_cast<dpp::snowflake>(guild_id));
-    vc.set_position(position);
+// Limite de créations Discord simultanées pendant /demarrer.
+static std::size_t start_concurrency() {
+    static const std::size_t value = []() -> std::size_t {
+        try {
+            return std::max<std::size_t>(1, std::stoul(getenv_or("START_CONCURRENCY", "4")));
+        } catch (...) {
+            std::cerr << "Warning : START_CONCURRENCY invalide, utilisation de 4.\n";
+            return 4;
+        }
+    }();
+    return value;
+}
 
-    dpp::permission_overwrite po_everyone;
-    po_everyone.id   = static_cast<dpp::snowflake>(guild_id); // @everyone
-    po_everyone.type = dpp::ot_role;
-    po_everyone.deny = dpp::p_connect | dpp::p_view_channel;
+// Étape du graphe portée par une coroutine ; true si elle a réussi.
+using Step = std::function<dpp::task<bool>()>;
 
-    dpp::permission_overwrite po_member;
-    po_member.id   = static_cast<dpp::snowflake>(member_role_id);
-    po_member.type = dpp::ot_role;
-    po_member.allow = dpp::p_connect | dpp::p_view_channel;
+static dpp::job run_step(Step step, TaskGraph::Done done) {
+    bool ok = false;
+    try {
+        ok = co_await step();
+    } catch (const std::exception& ex) {
+        std::cerr << "[StartAlliance] Exception dans une étape : " << ex.what() << "\n";
+    }
+    done(ok);
+}
 
-    vc.permission_overwrites.clear();
-    vc.permission_overwrites.push_back(po_everyone);
-    vc.permission_overwrites.push_back(po_member);
+static TaskGraph::Run coro_step(Step step) {
+    return [step](TaskGraph::Done done) { run_step(step, done); };
+}
 
-    cluster->channel_create(
-        vc,
-        [db, alliance_id, vc_name](const dpp::confirmation_callback_t& cb) {
-            if (cb.is_error()) {
-                std::cerr << "[StartAlliance] Erreur création salon vocal '"
-                          << vc_name << "' : " << cb.get_error().message << "\n";
-                return;
-            }
+// Création d'un rôle : les joueurs listés le recevront à l'étape d'attribution.
+static dpp::task<bool> co_role_step(
+    dpp::cluster* cluster,
+    std::shared_ptr<odb::pgsql::database> db,
+    std::uint64_t guild_id,
+    std::uint64_t alliance_id,
+    std::shared_ptr<StartContext> ctx,
+    std::string role_name,
+    std::vector<std::uint64_t> user_ids,
+    bool is_member_role
+)
+{
+    const std::uint64_t role_id =
+        co_await co_create_role(cluster, db, ctx, guild_id, alliance_id, role_name);
 
-            dpp::channel created = cb.get<dpp::channel>();
-            std::uint64_t ch_id = static_cast<std::uint64_t>(created.id);
+    if (role_id == 0)
+        co_return false;
 
-            persist_discord_object(
-                db,
-                alliance_id,
-                DiscordObjectType::voice_channel,
-                ch_id,
-                vc_name
-            );
-        }
-    );
+    std::lock_guard<std::mutex> lock(ctx->mutex);
+    if (is_member_role)
+        ctx->member_role_id = role_id;
+    for (std::uint64_t uid : user_ids) {
+        ctx->targets[uid].push_back(role_id);
+    }
+    co_return true;
 }
 
+static dpp::task<bool> co_category_step(
+    dpp::cluster* cluster,
+    std::shared_ptr<odb::pgsql::database> db,
+    std::uint64_t guild_id,
+    std::uint64_t alliance_id,
+    std::shared_ptr<StartContext> ctx,
+    std::string name
+)
+{
+    const std::uint64_t category_id =
+        co_await co_create_category(cluster, db, ctx, guild_id, alliance_id, name);
+
+    if (category_id == 0)
+        co_return false;
+
+    std::lock_guard<std::mutex> lock(ctx->mutex);
+    ctx->category_id = category_id;
+    co_return true;
+}
 
-static void add_role_to_users(
+static dpp::task<bool> co_voice_step(
     dpp::cluster* cluster,
+    std::shared_ptr<odb::pgsql::database> db,
     std::uint64_t guild_id,
-    std::uint64_t role_id,
-    const std::vector<std::uint64_t>& user_ids
+    std::uint64_t alliance_id,
+    std::shared_ptr<StartContext> ctx,
+    std::string name,
+    std::uint16_t position
 )
 {
-    if (!cluster) return;
+    co_return co_await co_create_voice_channel(cluster, db, ctx, guild_id, alliance_id, name, position) != 0;
+}
 
-    for (std::uint64_t uid : user_ids) {
-        cluster->guild_member_add_role(
-            guild_id,
-            static_cast<dpp::snowflake>(uid),
-            static_cast<dpp::snowflake>(role_id),
-            [](const dpp::confirmation_callback_t& cb) {
-                if (cb.is_error()) {
-                    // nothing
-                }
-            }
-        );
+static dpp::task<bool> co_assign_step(
+    dpp::cluster* cluster,
+    std::uint64_t guild_id,
+    std::shared_ptr<StartContext> ctx
+)
+{
+    role_assignment::Targets targets;
+    {
+        std::lock_guard<std::mutex> lock(ctx->mutex);
+        targets.swap(ctx->targets);
+    }
+
+    role_assignment::Report report = co_await dpp::async<role_assignment::Report>{
+        [&](auto&& cb) {
+            role_assignment::assign(cluster, guild_id, std::move(targets),
+                                    rest_scheduler::Priority::normal,
+                                    trace::bind(std::forward<decltype(cb)>(cb)));
+        }
+    };
+
+    std::cout << "[StartAlliance] Rôles : " << report.applied << " édition(s) groupée(s), "
+              << report.fallback << " en ajout unitaire, " << report.failed
+              << " échec(s) sur " << report.users << " joueur(s) en "
+              << report.elapsed_ms << " ms\n";
+
+    std::lock_guard<std::mutex> lock(ctx->mutex);
+    ctx->roles = report;
+
+    // Non bloquant : les échecs par joueur (membre parti...) figurent
+    // dans le rapport, rejouer tout le provisioning n'y changerait rien.
+    co_return true;
+}
+
+static std::string format_start_report(
+    const TaskGraph::Progress& progress,
+    const role_assignment::Report& roles
+)
+{
+    std::ostringstream oss;
+
+    if (progress.failed == 0 && progress.skipped == 0 && roles.failed == 0) {
+        oss << "✅ Alliance démarrée en " << progress.elapsed_ms / 1000 << "."
+            << (progress.elapsed_ms % 1000) / 100 << " s : "
+            << progress.total << " étape(s), rôles attribués à " << roles.users << " joueur(s).";
+        return oss.str();
+    }
+
+    oss << "⚠️ Alliance démarrée en " << progress.elapsed_ms / 1000 << "."
+        << (progress.elapsed_ms % 1000) / 100 << " s avec des erreurs : "
+        << progress.succeeded << "/" << progress.total << " étape(s) réussie(s).";
+
+    for (const std::string& name : progress.failures) {
+        oss << "\n- " << name;
     }
+    for (const auto& [uid, error] : roles.errors) {
+        oss << "\n- Rôles de <@" << uid << "> : " << error;
+    }
+
+    return oss.str();
 }
 
 } // namespace
 
 
-void StartAllianceCommand::handle(
-    const dpp::slashcommand_t& event,
-    const std::shared_ptr<odb::pgsql::database>& db
+dpp::task<void> StartAllianceCommand::co_handle(
+    dpp::slashcommand_t event,
+    std::shared_ptr<odb::pgsql::database> db
 ) const
 {
     if (event.command.guild_id == 0) {
         dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
-        return;
-    }
-
-    dpp::cluster* cluster = event.from()->creator;
-    if (!cluster) {
-        dpp::message msg("❌ Erreur interne (cluster Discord indisponible).");
-        msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
-        return;
+        co_await deferral::co_reply(event, msg);
+        co_return;
     }
 
     const std::uint64_t guild_id   = static_cast<std::uint64_t>(event.command.guild_id);
     const std::uint64_t channel_id = static_cast<std::uint64_t>(event.command.channel_id);
     const std::uint64_t user_id    = static_cast<std::uint64_t>(event.command.usr.id);
 
-    try {
-        using AllianceQuery  = odb::query<Alliance>;
-        using AllianceResult = odb::result<Alliance>;
-
-        using ShipQuery  = odb::query<Ship>;
-        using ShipResult = odb::result<Ship>;
+    dpp::message reply;
+    reply.set_flags(dpp::m_ephemeral);
 
-        using PartQuery  = odb::query<AllianceParticipant>;
-        using PartResult = odb::result<AllianceParticipant>;
+    std::uint64_t alliance_id = 0;
+    bool started = false;
 
+    // Exécuté sur le worker DB qui a lancé la commande.
+    try {
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "start.load");
 
-        AllianceResult ares(
-            db->query<Alliance>(
-                AllianceQuery::guild_id == guild_id &&
-                AllianceQuery::thread_channel_id == channel_id
-            )
-        );
-
-        auto ait = ares.begin();
-        if (ait == ares.end()) {
+        alliance_helpers::AllianceRosterData roster;
+        if (!alliance_helpers::fetch_alliance_roster_by_thread(*db, guild_id, channel_id, roster)) {
             t.commit();
-            dpp::message msg(
+            reply.set_content(
                 "❌ Ce thread n'est pas associé à une alliance connue.\n"
                 "La commande `/start` ne peut être utilisée que dans un thread d'alliance créé par le bot."
             );
-            msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
-            return;
-        }
+        } else {
+            Alliance& alliance = roster.alliance;
+            alliance_id = alliance.id();
+            std::uint64_t organizer_id = alliance.organizer_id();
+            std::uint64_t right_hand_id = 0;
+
+            if (!alliance.right_hand().empty()) {
+                right_hand_id = parse_mention_id(alliance.right_hand());
+            }
 
-        Alliance alliance = *ait;
-        std::uint64_t alliance_id  = alliance.id();
-        std::uint64_t organizer_id = alliance.organizer_id();
-        std::uint64_t right_hand_id = 0;
+            if (user_id != organizer_id && user_id != right_hand_id) {
+                reply.set_content(
+                    "❌ Seul l'organisateur ou le bras droit peuvent lancer `/start` pour cette alliance."
+                );
+            } else if (alliance.status() == AllianceStatus::matching ||
+                       alliance.status() == AllianceStatus::in_game) {
+                reply.set_content(
+                    "⚠️ Cette alliance est déjà démarrée. "
+                    "(Les rôles et salons ont déjà été créés.)"
+                );
+            } else if (alliance.status() == AllianceStatus::finished ||
+                       alliance.status() == AllianceStatus::cancelled) {
+                reply.set_content(
+                    "❌ Cette alliance est terminée ou annulée, tu ne peux plus la démarrer."
+                );
+            } else if (roster.ships.empty()) {
+                reply.set_content(
+                    "❌ Aucun bateau n'est configuré pour cette alliance.\n"
+                    "Impossible de créer les salons vocaux."
+                );
+            } else {
+                alliance.status(AllianceStatus::matching);
+                db->update(alliance);
+
+                // Rôles et salons sont créés par le dispatcher de l'outbox après le
+                // commit : un crash entre les deux est rattrapé au redémarrage.
+                outbox::add(
+                    *db,
+                    "alliance_provision:" + std::to_string(alliance_id),
+                    OutboxKind::alliance_provision,
+                    guild_id,
+                    alliance_id,
+                    channel_id
+                );
+                started = true;
+                watch_provision(alliance_id, event);
 
-        if (!alliance.right_hand().empty()) {
-            right_hand_id = parse_mention_id(alliance.right_hand());
-        }
+                reply.set_content(
+                    "🛠️ Initialisation de l'alliance en cours...\n"
+                    "Création des rôles et des salons vocaux."
+                );
+            }
 
-        if (user_id != organizer_id && user_id != right_hand_id) {
             t.commit();
-            dpp::message msg(
-                "❌ Seul l'organisateur ou le bras droit peuvent lancer `/start` pour cette alliance."
-            );
-            msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
-            return;
         }
+    }
+    catch (const std::exception& ex) {
+        std::cerr << "[StartAlliance] Erreur DB : " << ex.what() << "\n";
+        reply.set_content("❌ Erreur interne lors du démarrage de l'alliance.");
+        if (started)
+            forget_watcher(alliance_id);
+        started = false;
+    }
 
-        switch (alliance.status()) {
-            case AllianceStatus::planned:
-                break;
+    if (started) {
+        alliance_index::set_status(channel_id, AllianceStatus::matching);
+    }
 
-            case AllianceStatus::matching:
-            case AllianceStatus::in_game: {
-                t.commit();
-                dpp::message msg(
-                    "⚠️ Cette alliance est déjà démarrée. "
-                    "(Les rôles et salons ont déjà été créés.)"
-                );
-                msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
-                return;
-            }
+    // La progression édite cette réponse : elle doit exister avant le provisioning.
+    co_await deferral::co_reply(event, reply);
 
-            case AllianceStatus::finished:
-            case AllianceStatus::cancelled: {
-                t.commit();
-                dpp::message msg(
-                    "❌ Cette alliance est terminée ou annulée, tu ne peux plus la démarrer."
+    if (!started)
+        co_return;
+
+    watcher_replied(alliance_id);
+    outbox::kick();
+}
+
+static dpp::job run_provision(
+    dpp::cluster* cluster,
+    std::shared_ptr<odb::pgsql::database> db,
+    std::uint64_t alliance_id,
+    std::function<void(bool ok, const std::string& error)> done
+)
+{
+    using ObjQuery  = odb::query<AllianceDiscordObject>;
+    using ObjResult = odb::result<AllianceDiscordObject>;
+
+    alliance_helpers::AllianceRosterData roster;
+    auto ctx = std::make_shared<StartContext>();
+    bool found = false;
+    std::string load_error;
+
+    co_await db_executor::run([&]() {
+        try {
+            odb::transaction t(db->begin());
+            tx_metrics::track(t, "start.provision_load");
+
+            found = alliance_helpers::fetch_alliance_roster(*db, alliance_id, roster);
+            if (found) {
+                ObjResult ores(
+                    db->query<AllianceDiscordObject>(
+                        ObjQuery::alliance_id == alliance_id &&
+                        ObjQuery::deleted_at == 0
+                    )
                 );
-                msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
-                return;
+                for (const AllianceDiscordObject& o : ores) {
+                    ctx->existing.emplace(std::make_pair(o.type(), o.name()), o.discord_id());
+                }
             }
+
+            t.commit();
+        } catch (const std::exception& ex) {
+            load_error = ex.what();
         }
+    });
 
-        ShipQuery sq(ShipQuery::alliance_id == alliance_id);
-        sq += " ORDER BY " + ShipQuery::slot;
+    if (!load_error.empty()) {
+        std::cerr << "[StartAlliance] Erreur DB provisioning : " << load_error << "\n";
+        done(false, load_error);
+        co_return;
+    }
 
-        ShipResult sres(db->query<Ship>(sq));
+    const Alliance& alliance = roster.alliance;
 
-        std::vector<Ship> ships;
-        for (const Ship& s : sres) {
-            ships.push_back(s);
-        }
+    // Supprimée, terminée ou annulée avant que l'événement ne soit traité : plus rien à créer.
+    if (!found ||
+        (alliance.status() != AllianceStatus::matching &&
+         alliance.status() != AllianceStatus::in_game))
+    {
+        done(true, {});
+        co_return;
+    }
 
-        if (ships.empty()) {
-            t.commit();
-            dpp::message msg(
-                "❌ Aucun bateau n'est configuré pour cette alliance.\n"
-                "Impossible de créer les salons vocaux."
-            );
-            msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
-            return;
-        }
+    const std::uint64_t guild_id     = alliance.guild_id();
+    const std::uint64_t organizer_id = alliance.organizer_id();
+    std::uint64_t right_hand_id = 0;
 
-        PartResult pres(
-            db->query<AllianceParticipant>(
-                PartQuery::alliance_id == alliance_id &&
-                PartQuery::left_at == 0
-            )
-        );
+    if (!alliance.right_hand().empty()) {
+        right_hand_id = parse_mention_id(alliance.right_hand());
+    }
 
-        std::vector<CrewEntry> crew;
-        std::vector<std::uint64_t> all_member_ids;
-        for (const AllianceParticipant& p : pres) {
+    const std::vector<Ship>& ships = roster.ships;
+
+    std::vector<CrewEntry> crew;
+    std::vector<std::uint64_t> all_member_ids;
+    for (const Ship& s : ships) {
+        auto it = roster.by_ship.find(s.id());
+        if (it == roster.by_ship.end())
+            continue;
+
+        for (const AllianceParticipant& p : it->second) {
             CrewEntry e;
             e.user_id = p.user_id();
             e.ship_id = p.ship_id();
@@ -461,192 +713,200 @@ void StartAllianceCommand::handle(
 
             all_member_ids.push_back(p.user_id());
         }
+    }
 
-        if (std::find(all_member_ids.begin(), all_member_ids.end(), organizer_id) == all_member_ids.end()) {
-            all_member_ids.push_back(organizer_id);
+    if (std::find(all_member_ids.begin(), all_member_ids.end(), organizer_id) == all_member_ids.end()) {
+        all_member_ids.push_back(organizer_id);
+    }
+    if (right_hand_id != 0 &&
+        std::find(all_member_ids.begin(), all_member_ids.end(), right_hand_id) == all_member_ids.end())
+    {
+        all_member_ids.push_back(right_hand_id);
+    }
+
+    std::sort(all_member_ids.begin(), all_member_ids.end());
+    all_member_ids.erase(
+        std::unique(all_member_ids.begin(), all_member_ids.end()),
+        all_member_ids.end()
+    );
+
+    const std::string member_role = alliance.name();
+    const std::string orga_role   = "Organisateur";
+    const std::string bras_role   = "Bras droit";
+
+    // Rôles et catégorie en parallèle ; les salons attendent la catégorie
+    // et le rôle membre ; l'attribution attend tous les rôles.
+    TaskGraph graph(start_concurrency());
+    std::vector<TaskGraph::Id> role_tasks;
+
+    const TaskGraph::Id member_task = graph.add(
+        "Rôle " + member_role, {},
+        coro_step([=]() {
+            return co_role_step(cluster, db, guild_id, alliance_id, ctx, member_role, all_member_ids, true);
+        })
+    );
+    role_tasks.push_back(member_task);
+
+    role_tasks.push_back(graph.add(
+        "Rôle " + orga_role, {},
+        coro_step([=]() {
+            return co_role_step(cluster, db, guild_id, alliance_id, ctx, orga_role, { organizer_id }, false);
+        })
+    ));
+
+    if (right_hand_id != 0) {
+        role_tasks.push_back(graph.add(
+            "Rôle " + bras_role, {},
+            coro_step([=]() {
+                return co_role_step(cluster, db, guild_id, alliance_id, ctx, bras_role, { right_hand_id }, false);
+            })
+        ));
+    }
+
+    for (const Ship& ship : ships) {
+        std::string hull = alliance_helpers::hull_label(ship.hull_type());
+        std::string role = ship.crew_role().empty()
+                         ? "Libre"
+                         : ship.crew_role();
+
+        std::ostringstream rn;
+        rn << hull << " " << role; // ex: "Brigantin FDD"
+        const std::string ship_role_name = rn.str();
+
+        std::vector<std::uint64_t> ship_users;
+        for (const auto& c : crew) {
+            if (c.ship_id == ship.id()) {
+                ship_users.push_back(c.user_id);
+            }
+        }
+
+        role_tasks.push_back(graph.add(
+            "Rôle " + ship_role_name, {},
+            coro_step([=]() {
+                return co_role_step(cluster, db, guild_id, alliance_id, ctx, ship_role_name, ship_users, false);
+            })
+        ));
+    }
+
+    const std::string category_name = alliance.name();
+    const TaskGraph::Id category_task = graph.add(
+        "Catégorie " + category_name, {},
+        coro_step([=]() {
+            return co_category_step(cluster, db, guild_id, alliance_id, ctx, category_name);
+        })
+    );
+
+    std::uint16_t position = 0;
+
+    {
+        static const std::vector<std::string> avant_postes = {
+            "Avant-poste Golden Sands",
+            "Avant-poste Sanctuary",
+            "Avant-poste Ancient Spire",
+            "Avant-poste Plunder",
+            "Avant-poste Dagger Tooth",
+            "Avant-poste Galleon's Grave",
+            "Avant-poste Morrow's Peak"
+        };
+
+        // Événement rejoué : on garde l'avant-poste déjà tiré.
+        std::string hub_name;
+        for (const std::string& name : avant_postes) {
+            if (ctx->existing.count({ DiscordObjectType::voice_channel, name })) {
+                hub_name = name;
+                break;
+            }
         }
-        if (right_hand_id != 0 &&
-            std::find(all_member_ids.begin(), all_member_ids.end(), right_hand_id) == all_member_ids.end())
-        {
-            all_member_ids.push_back(right_hand_id);
+
+        if (hub_name.empty()) {
+            std::random_device rd;
+            std::mt19937 gen(rd());
+            std::uniform_int_distribution<std::size_t> dist(0, avant_postes.size() - 1);
+
+            hub_name = avant_postes[dist(gen)];
         }
 
-        std::sort(all_member_ids.begin(), all_member_ids.end());
-        all_member_ids.erase(
-            std::unique(all_member_ids.begin(), all_member_ids.end()),
-            all_member_ids.end()
+        const std::uint16_t hub_position = position++;
+
+        graph.add(
+            "Salon " + hub_name, { category_task, member_task },
+            coro_step([=]() {
+                return co_voice_step(cluster, db, guild_id, alliance_id, ctx, hub_name, hub_position);
+            })
         );
+    }
 
-        alliance.status(AllianceStatus::matching);
-        db->update(alliance);
+    for (const Ship& ship : ships) {
+        const std::uint16_t ship_position = position++;
+        const std::string vc_name = ship_voice_name(ship);
 
-        t.commit();
+        graph.add(
+            "Salon " + alliance_helpers::hull_label(ship.hull_type()) + " #" + std::to_string(ship.slot()),
+            { category_task, member_task },
+            coro_step([=]() {
+                return co_voice_step(cluster, db, guild_id, alliance_id, ctx, vc_name, ship_position);
+            })
+        );
+    }
+
+    // Lancée même si un rôle a échoué : les joueurs reçoivent ceux qui existent.
+    graph.add(
+        "Attribution des rôles", role_tasks,
+        coro_step([=]() { return co_assign_step(cluster, guild_id, ctx); }),
+        true
+    );
 
-        {
-            dpp::message msg;
-            msg.set_flags(dpp::m_ephemeral);
-            msg.set_content(
-                "🛠️ Initialisation de l'alliance en cours...\n"
-                "Création des rôles et des salons vocaux."
+    const TaskGraph::Progress progress = co_await dpp::async<TaskGraph::Progress>{
+        [&](auto&& cb) {
+            graph.start(
+                [alliance_id](const TaskGraph::Progress& p) {
+                    std::ostringstream oss;
+                    oss << "🛠️ Initialisation de l'alliance en cours... ("
+                        << p.finished() << "/" << p.total << " étapes)";
+
+                    notify_watcher(alliance_id, oss.str(), false);
+                },
+                trace::bind(std::forward<decltype(cb)>(cb))
             );
-            event.reply(msg);
         }
+    };
 
-        std::string base_name   = alliance.name();
-        std::string member_role = base_name;
-        std::string orga_role   = "Organisateur";
-        std::string bras_role   = "Bras droit";
-
-        create_role_and_record(
-            cluster,
-            db,
-            guild_id,
-            alliance_id,
-            member_role,
-            [cluster,
-             db,
-             guild_id,
-             alliance_id,
-             alliance,
-             ships,
-             crew,
-             all_member_ids,
-             organizer_id,
-             right_hand_id,
-             orga_role,
-             bras_role](std::uint64_t member_role_id)
-            {
-                add_role_to_users(cluster, guild_id, member_role_id, all_member_ids);
-
-                if (!orga_role.empty()) {
-                    create_role_and_record(
-                        cluster,
-                        db,
-                        guild_id,
-                        alliance_id,
-                        orga_role,
-                        [cluster, guild_id, organizer_id](std::uint64_t orga_role_id) {
-                            std::vector<std::uint64_t> v { organizer_id };
-                            add_role_to_users(cluster, guild_id, orga_role_id, v);
-                        }
-                    );
-                }
-
-                if (right_hand_id != 0 && !bras_role.empty()) {
-                    create_role_and_record(
-                        cluster,
-                        db,
-                        guild_id,
-                        alliance_id,
-                        bras_role,
-                        [cluster, guild_id, right_hand_id](std::uint64_t bras_role_id) {
-                            std::vector<std::uint64_t> v { right_hand_id };
-                            add_role_to_users(cluster, guild_id, bras_role_id, v);
-                        }
-                    );
-                }
+    role_assignment::Report roles;
+    {
+        std::lock_guard<std::mutex> lock(ctx->mutex);
+        roles = ctx->roles;
+    }
 
-                for (const Ship& ship : ships) {
-                    std::string hull = alliance_helpers::hull_label(ship.hull_type());
-                    std::string role = ship.crew_role().empty()
-                                     ? "Libre"
-                                     : ship.crew_role();
-
-                    std::ostringstream rn;
-                    rn << hull << " " << role; // ex: "Brigantin FDD"
-                    std::string ship_role_name = rn.str();
-                    std::uint64_t ship_id = ship.id();
-
-                    std::vector<std::uint64_t> ship_users;
-                    for (const auto& c : crew) {
-                        if (c.ship_id == ship_id) {
-                            ship_users.push_back(c.user_id);
-                        }
-                    }
-
-                    create_role_and_record(
-                        cluster,
-                        db,
-                        guild_id,
-                        alliance_id,
-                        ship_role_name,
-                        [cluster, guild_id, ship_users](std::uint64_t ship_role_id) {
-                            if (!ship_users.empty()) {
-                                add_role_to_users(cluster, guild_id, ship_role_id, ship_users);
-                            }
-                        }
-                    );
-                }
+    std::cout << "[StartAlliance] Alliance " << alliance_id << " provisionnée : "
+              << progress.succeeded << "/" << progress.total << " étape(s) en "
+              << progress.elapsed_ms << " ms\n";
 
-                create_category_and_record(
-                    cluster,
-                    db,
-                    guild_id,
-                    alliance_id,
-                    alliance.name(),
-                    [cluster,
-                    db,
-                    guild_id,
-                    alliance_id,
-                    member_role_id,
-                    ships](std::uint64_t category_id)
-                    {
-                        std::uint16_t position = 0;
-
-                        {
-                            static const std::vector<std::string> avant_postes = {
-                                "Avant-poste Golden Sands",
-                                "Avant-poste Sanctuary",
-                                "Avant-poste Ancient Spire",
-                                "Avant-poste Plunder",
-                                "Avant-poste Dagger Tooth",
-                                "Avant-poste Galleon's Grave",
-                                "Avant-poste Morrow's Peak"
-                            };
-
-                            if (!avant_postes.empty()) {
-                                std::random_device rd;
-                                std::mt19937 gen(rd());
-                                std::uniform_int_distribution<std::size_t> dist(0, avant_postes.size() - 1);
-
-                                std::string hub_name = avant_postes[dist(gen)];
-
-                                create_generic_voice_channel(
-                                    cluster,
-                                    db,
-                                    guild_id,
-                                    alliance_id,
-                                    category_id,
-                                    member_role_id,
-                                    hub_name,
-                                    position++
-                                );
-                            }
-                        }
-
-                        for (const Ship& ship : ships) {
-                            create_voice_for_ship(
-                                cluster,
-                                db,
-                                guild_id,
-                                alliance_id,
-                                category_id,
-                                member_role_id,
-                                ship,
-                                position++
-                            );
-                        }
-                    }
-                );
+    notify_watcher(alliance_id, format_start_report(progress, roles), true);
 
-            }
-        );
+    if (progress.failed == 0 && progress.skipped == 0) {
+        done(true, {});
+        co_return;
     }
-    catch (const std::exception& ex) {
-        std::cerr << "[StartAlliance] Erreur DB : " << ex.what() << "\n";
-        dpp::message msg("❌ Erreur interne lors du démarrage de l'alliance.");
-        msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
-        return;
+
+    // Rejoué par l'outbox : les objets déjà créés seront réutilisés.
+    std::string error;
+    for (const std::string& name : progress.failures) {
+        if (!error.empty()) error += ", ";
+        error += name;
     }
+    done(false, error);
+}
+
+void StartAllianceCommand::provision(
+    dpp::cluster* cluster,
+    const std::shared_ptr<odb::pgsql::database>& db,
+    std::uint64_t alliance_id,
+    std::function<void(bool ok, const std::string& error)> done
+)
+{
+    run_provision(cluster, db, alliance_id, std::move(done));
+}
+
+void StartAllianceCommand::provision_abandoned(std::uint64_t alliance_id) {
+    forget_watcher(alliance_id);
 }
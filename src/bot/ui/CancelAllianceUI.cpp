@@ -13,7 +13,10 @@
 #include "model/alliances.hxx"
 #include "alliances-odb.hxx"
 
-#include "bot/AllianceHelpers.hpp"
+#include "bot/AllianceIndex.hpp"
+#include "bot/Deferral.hpp"
+#include "bot/Outbox.hpp"
+#include "db/TxMetrics.hpp"
 
 namespace {
 
@@ -43,7 +46,7 @@ static void perform_cancel_alliance(
     if (event.command.guild_id == 0) {
         dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
@@ -51,7 +54,7 @@ static void perform_cancel_alliance(
     if (!cluster) {
         dpp::message msg("❌ Erreur interne (cluster Discord indisponible).");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
@@ -62,31 +65,25 @@ static void perform_cancel_alliance(
     std::uint64_t alliance_id = 0;
 
     try {
-        using AllianceQuery  = odb::query<Alliance>;
-        using AllianceResult = odb::result<Alliance>;
-
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "cancel.perform");
 
-        AllianceResult ares(
-            db->query<Alliance>(
-                AllianceQuery::guild_id == guild_id &&
-                AllianceQuery::thread_channel_id == channel_id
-            )
+        std::unique_ptr<Alliance> alliance_ptr(
+            alliance_index::load_alliance(*db, guild_id, channel_id)
         );
 
-        auto ait = ares.begin();
-        if (ait == ares.end()) {
+        if (!alliance_ptr) {
             t.commit();
             dpp::message msg(
                 "❌ Ce thread n'est pas associé à une alliance connue.\n"
                 "La commande `/cancel` ne peut être utilisée que dans un thread d'alliance créé par le bot."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
-        Alliance alliance = *ait;
+        Alliance alliance = *alliance_ptr;
         alliance_id = alliance.id();
 
         std::uint64_t organizer_id  = alliance.organizer_id();
@@ -102,7 +99,7 @@ static void perform_cancel_alliance(
                 "❌ Seul l'organisateur ou le bras droit peuvent lancer `/cancel` pour cette alliance."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
@@ -118,7 +115,7 @@ static void perform_cancel_alliance(
                     "Utilise plutôt `/end` pour la terminer et supprimer les rôles/salons."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return;
             }
 
@@ -129,7 +126,7 @@ static void perform_cancel_alliance(
                     "❌ Cette alliance est déjà terminée ou annulée."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return;
             }
         }
@@ -137,13 +134,22 @@ static void perform_cancel_alliance(
         alliance.status(AllianceStatus::cancelled);
         db->update(alliance);
 
+        // Renommage du thread et roster : rejoués par l'outbox jusqu'à succès.
+        const std::string key = std::to_string(alliance_id);
+        outbox::add(*db, "thread_rename:cancel:" + key, OutboxKind::thread_rename,
+                    guild_id, alliance_id, channel_id, "❌ [Annulé] ");
+        outbox::add(*db, "roster_refresh:cancel:" + key, OutboxKind::roster_refresh,
+                    guild_id, alliance_id, channel_id);
+
         t.commit();
+
+        alliance_index::set_status(channel_id, AllianceStatus::cancelled);
     }
     catch (const std::exception& ex) {
         std::cerr << "[CancelAlliance] Erreur DB : " << ex.what() << "\n";
         dpp::message msg("❌ Erreur interne lors de l'annulation de l'alliance.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
@@ -154,51 +160,12 @@ static void perform_cancel_alliance(
             "✅ Alliance annulée.\n"
             "Le thread a été marqué comme annulé et le message d'annonce mis à jour."
         );
-        event.reply(msg);
+        deferral::reply(event, msg);
     }
 
-    if (cluster && alliance_id != 0) {
-        dpp::snowflake thread_id(static_cast<dpp::snowflake>(channel_id));
-
-        cluster->channel_get(
-            thread_id,
-            [cluster](const dpp::confirmation_callback_t& cb) {
-                if (cb.is_error()) {
-                    std::cerr << "[CancelAlliance] Erreur récupération thread pour renommage : "
-                              << cb.get_error().message << "\n";
-                    return;
-                }
-
-                dpp::channel ch = cb.get<dpp::channel>();
-                std::string old_name = ch.name;
-                const std::string prefix = "❌ [Annulé] ";
-
-                if (old_name.compare(0, prefix.size(), prefix) != 0) {
-                    ch.set_name(prefix + old_name);
-
-                    cluster->channel_edit(
-                        ch,
-                        [](const dpp::confirmation_callback_t& cb2) {
-                            if (cb2.is_error()) {
-                                std::cerr << "[CancelAlliance] Erreur renommage thread : "
-                                          << cb2.get_error().message << "\n";
-                            }
-                        }
-                    );
-                }
-            }
-        );
-
-        alliance_helpers::create_or_update_alliance_roster_message(
-            cluster,
-            db,
-            alliance_id,
-            thread_id
-        );
-    }
+    outbox::kick();
 }
 
-
 } // namespace
 
 void CancelAllianceUI::open(const dpp::slashcommand_t& event,
@@ -207,7 +174,7 @@ void CancelAllianceUI::open(const dpp::slashcommand_t& event,
     if (event.command.guild_id == 0) {
         dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
@@ -216,31 +183,25 @@ void CancelAllianceUI::open(const dpp::slashcommand_t& event,
     const std::uint64_t user_id    = static_cast<std::uint64_t>(event.command.usr.id);
 
     try {
-        using AllianceQuery  = odb::query<Alliance>;
-        using AllianceResult = odb::result<Alliance>;
-
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "cancel.open");
 
-        AllianceResult ares(
-            db->query<Alliance>(
-                AllianceQuery::guild_id == guild_id &&
-                AllianceQuery::thread_channel_id == channel_id
-            )
+        std::unique_ptr<Alliance> alliance_ptr(
+            alliance_index::load_alliance(*db, guild_id, channel_id)
         );
 
-        auto ait = ares.begin();
-        if (ait == ares.end()) {
+        if (!alliance_ptr) {
             t.commit();
             dpp::message msg(
                 "❌ Ce thread n'est pas associé à une alliance connue.\n"
                 "La commande `/cancel` ne peut être utilisée que dans un thread d'alliance créé par le bot."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
-        Alliance alliance = *ait;
+        Alliance alliance = *alliance_ptr;
 
         std::uint64_t organizer_id  = alliance.organizer_id();
         std::uint64_t right_hand_id = 0;
@@ -254,7 +215,7 @@ void CancelAllianceUI::open(const dpp::slashcommand_t& event,
                 "❌ Seul l'organisateur ou le bras droit peuvent lancer `/cancel` pour cette alliance."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
@@ -270,7 +231,7 @@ void CancelAllianceUI::open(const dpp::slashcommand_t& event,
                     "Utilise plutôt `/end` pour la terminer et supprimer les rôles/salons."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return;
             }
 
@@ -281,7 +242,7 @@ void CancelAllianceUI::open(const dpp::slashcommand_t& event,
                     "❌ Cette alliance est déjà terminée ou annulée."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return;
             }
         }
@@ -316,13 +277,13 @@ void CancelAllianceUI::open(const dpp::slashcommand_t& event,
 
         msg.add_component(row);
 
-        event.reply(msg);
+        deferral::reply(event, msg);
     }
     catch (const std::exception& ex) {
         std::cerr << "[CancelAllianceUI::open] Erreur DB : " << ex.what() << "\n";
         dpp::message msg("❌ Erreur interne lors de la préparation de l'annulation.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
     }
 }
 
@@ -337,7 +298,7 @@ bool CancelAllianceUI::handle_button(const dpp::button_click_t& event,
     if (id == "cancel_alliance_cancel") {
         dpp::message msg("❌ Action annulée, l'alliance n'a pas été modifiée.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return true;
     }
 
@@ -1,9 +1,12 @@
 #include "bot/ui/CreateAllianceUI.hpp"
 
+#include <algorithm>
 #include <ctime>
+#include <memory>
+#include <optional>
+#include <random>
 #include <sstream>
 #include <iomanip>
-#include <unordered_map>
 #include <iostream>
 #include <cctype>
 #include <vector>
@@ -15,6 +18,7 @@
 #include <odb/pgsql/database.hxx>
 #include <odb/transaction.hxx>
 #include <odb/exceptions.hxx>
+#include <odb/pgsql/exceptions.hxx>
 
 #include "model/bot_settings.hxx"
 #include "bot_settings-odb.hxx"
@@ -29,6 +33,15 @@
 #include "alliance_discord_objects-odb.hxx"
 
 #include "bot/AllianceHelpers.hpp"
+#include "bot/AllianceIndex.hpp"
+#include "bot/Deferral.hpp"
+#include "bot/InteractionTrace.hpp"
+#include "db/BotSettingsCache.hpp"
+#include "db/DbExecutor.hpp"
+#include "db/TxMetrics.hpp"
+#include "util/CompactCodec.hpp"
+#include "util/TimeParse.hpp"
+#include "util/TimeZone.hpp"
 
 namespace {
 
@@ -54,27 +67,21 @@ struct ShipConfig {
 
 static void ack_select(const dpp::select_click_t& event)
 {
-    event.reply();
+    deferral::ack(event);
 }
 
 
 
-struct PendingAllianceKey {
-    std::uint64_t guild_id;
-    std::uint64_t user_id;
-
-    bool operator==(const PendingAllianceKey&) const = default;
-};
-
-struct PendingAllianceKeyHash {
-    std::size_t operator()(const PendingAllianceKey& k) const noexcept {
-        std::size_t h1 = std::hash<std::uint64_t>{}(k.guild_id);
-        std::size_t h2 = std::hash<std::uint64_t>{}(k.user_id);
-        return h1 ^ (h2 << 1);
-    }
-};
-
+// État de l'assistant de création. Il n'est pas conservé côté serveur :
+// chaque composant du message le porte, encodé et signé, dans son custom_id
+// (cf. compact_codec). Un redémarrage ou une autre instance du bot peut donc
+// traiter la suite de l'assistant.
 struct PendingAlliance {
+    // Tiré à l'ouverture de l'assistant, recopié dans l'alliance créée :
+    // l'index unique sur ce jeton empêche un second clic sur "Terminer"
+    // (ou une livraison rejouée sur une autre instance) de la recréer.
+    std::uint32_t nonce = 0;
+
     std::string date_iso;    // "2025-11-18"
     std::string start_time;  // "07:30"
     std::string sale_time;   // "18:00"
@@ -109,138 +116,373 @@ struct PendingAlliance {
     }
 };
 
-std::unordered_map<PendingAllianceKey,
-                   PendingAlliance,
-                   PendingAllianceKeyHash> pending_alliances;
+// ---- Encodage de l'état ----------------------------------------------------
 
-PendingAlliance& get_state(dpp::snowflake guild_id,
-                           dpp::snowflake user_id)
-{
-    PendingAllianceKey key{
-        static_cast<std::uint64_t>(guild_id),
-        static_cast<std::uint64_t>(user_id)
-    };
-    return pending_alliances[key];
-}
+constexpr std::uint8_t STATE_VERSION = 2;
 
-void clear_state(dpp::snowflake guild_id,
-                 dpp::snowflake user_id)
-{
-    PendingAllianceKey key{
-        static_cast<std::uint64_t>(guild_id),
-        static_cast<std::uint64_t>(user_id)
-    };
-    pending_alliances.erase(key);
+enum StateFlag : std::uint8_t {
+    FLAG_DATE       = 1 << 0,
+    FLAG_START      = 1 << 1,
+    FLAG_SALE       = 1 << 2,
+    FLAG_BRAS_DROIT = 1 << 3,
+    FLAG_REPRISE_SET = 1 << 4,
+    FLAG_REPRISE    = 1 << 5,
+    FLAG_FLEET      = 1 << 6
+};
+
+// Rôles du sélecteur, encodés par leur rang ; les autres le sont en texte.
+const std::vector<std::string> PRESET_ROLES = {"FDD", "Event", "Athéna", "Chasseur", "Libre"};
+
+constexpr std::uint8_t ROLE_NONE   = 0;
+constexpr std::uint8_t ROLE_CUSTOM = 0x3F;
+
+// Assez court pour laisser la place à plusieurs rôles personnalisés dans un custom_id.
+// Limite du modal en caractères ; un caractère UTF-8 fait au plus 4 octets.
+constexpr std::size_t CUSTOM_ROLE_MAX = 32;
+constexpr std::size_t CUSTOM_ROLE_MAX_BYTES = 4 * CUSTOM_ROLE_MAX;
+
+// Date ISO d'un nombre de jours depuis le 01/01/1970.
+std::string iso_from_days(std::int64_t days) {
+    std::int64_t y = 0;
+    int m = 0, d = 0;
+    time_zone::civil_from_days(days, y, m, d);
+
+    char buf[20];
+    return std::string(buf, time_parse::format_iso_date(static_cast<int>(y), m, d, buf));
 }
 
-static void send_ship_config_prompt(const dpp::button_click_t& event,
-                                    dpp::snowflake /*guild_id*/,
-                                    dpp::snowflake /*user_id*/,
-                                    const PendingAlliance& state)
-{
-    if (state.ships.empty() || state.current_ship >= state.ships.size())
-        return;
+bool hhmm_to_minutes(const std::string& hhmm, std::uint64_t& minutes) {
+    int h = 0, m = 0;
+    if (!time_parse::parse_clock(hhmm, h, m))
+        return false;
+    minutes = static_cast<std::uint64_t>(h * 60 + m);
+    return true;
+}
 
-    const std::size_t idx   = state.current_ship;
-    const std::size_t total = state.ships.size();
+std::string minutes_to_hhmm(std::uint64_t minutes) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%02u:%02u",
+                  static_cast<unsigned>(minutes / 60), static_cast<unsigned>(minutes % 60));
+    return buf;
+}
 
-    std::ostringstream content;
-    content << "⚓ Configuration du **bateau " << (idx + 1) << "/" << total << "**\n"
-            << "Choisis la **coque** et le **rôle** pour ce navire.\n"
-            << "Tu peux aussi choisir `Autre…` pour définir un rôle personnalisé.";
+std::string encode_state(const PendingAlliance& st) {
+    std::uint64_t start_min = 0;
+    std::uint64_t sale_min  = 0;
+    int year = 0, month = 0, day = 0;
+
+    const bool has_date  = !st.date_iso.empty() && parse_iso_date(st.date_iso, year, month, day);
+    const bool has_start = hhmm_to_minutes(st.start_time, start_min);
+    const bool has_sale  = hhmm_to_minutes(st.sale_time, sale_min);
+    const bool has_fleet = st.fleet_config_started && !st.ships.empty();
+
+    std::uint8_t flags = 0;
+    if (has_date)           flags |= FLAG_DATE;
+    if (has_start)          flags |= FLAG_START;
+    if (has_sale)           flags |= FLAG_SALE;
+    if (st.bras_droit_id)   flags |= FLAG_BRAS_DROIT;
+    if (st.reprise_set)     flags |= FLAG_REPRISE_SET;
+    if (st.reprise)         flags |= FLAG_REPRISE;
+    if (has_fleet)          flags |= FLAG_FLEET;
+
+    compact_codec::Writer w;
+    w.u8(STATE_VERSION);
+    w.u8(flags);
+    for (int shift = 0; shift < 32; shift += 8)
+        w.u8(static_cast<std::uint8_t>(st.nonce >> shift));
+
+    if (has_date)
+        w.varint(static_cast<std::uint64_t>(time_zone::days_from_civil(year, month, day)));
+    if (has_start)
+        w.varint(start_min);
+    if (has_sale)
+        w.varint(sale_min);
+    if (st.bras_droit_id)
+        w.varint(static_cast<std::uint64_t>(st.bras_droit_id));
+
+    if (has_fleet) {
+        w.u8(static_cast<std::uint8_t>(st.ships.size()));
+        w.u8(static_cast<std::uint8_t>(st.current_ship));
+
+        for (const ShipConfig& sc : st.ships) {
+            // hull sur 2 bits (0 = non choisi), rôle sur 6 bits
+            std::uint8_t hull = 0;
+            if (sc.has_hull) {
+                switch (sc.hull) {
+                    case ShipHull::Sloop:   hull = 1; break;
+                    case ShipHull::Brig:    hull = 2; break;
+                    case ShipHull::Galleon: hull = 3; break;
+                }
+            }
 
+            std::uint8_t role = ROLE_NONE;
+            if (sc.has_role) {
+                auto it = std::find(PRESET_ROLES.begin(), PRESET_ROLES.end(), sc.role);
+                role = it != PRESET_ROLES.end()
+                     ? static_cast<std::uint8_t>(1 + (it - PRESET_ROLES.begin()))
+                     : ROLE_CUSTOM;
+            }
 
-    dpp::message m;
-    m.set_content(content.str());
-    m.set_flags(dpp::m_ephemeral);
+            w.u8(static_cast<std::uint8_t>((hull << 6) | role));
+            if (role == ROLE_CUSTOM)
+                w.str(sc.role);
+        }
+    }
 
-    dpp::component hull_select;
-    hull_select.set_type(dpp::cot_selectmenu)
-               .set_id("create_alliance_ship_hull")
-               .set_placeholder("Type de navire")
-               .set_min_values(1)
-               .set_max_values(1);
-    hull_select.add_select_option(dpp::select_option("Sloop", "sloop"));
-    hull_select.add_select_option(dpp::select_option("Brigantin", "brig"));
-    hull_select.add_select_option(dpp::select_option("Galion", "galleon"));
+    return w.bytes();
+}
 
-    m.add_component(dpp::component().add_component(hull_select));
+std::optional<PendingAlliance> decode_state(const std::string& bytes) {
+    compact_codec::Reader r(bytes);
+    PendingAlliance st;
 
-    dpp::component role_select;
-    role_select.set_type(dpp::cot_selectmenu)
-               .set_id("create_alliance_ship_role")
-               .set_placeholder("Rôle du navire")
-               .set_min_values(1)
-               .set_max_values(1);
-    role_select.add_select_option(dpp::select_option("FDD", "FDD"));
-    role_select.add_select_option(dpp::select_option("Event", "Event"));
-    role_select.add_select_option(dpp::select_option("Athéna", "Athéna"));
-    role_select.add_select_option(dpp::select_option("Chasseur", "Chasseur"));
-    role_select.add_select_option(dpp::select_option("Libre", "Libre"));
-    role_select.add_select_option(dpp::select_option("Autre…", "custom"));
+    std::uint8_t version = 0;
+    std::uint8_t flags   = 0;
+    if (!r.u8(version) || version != STATE_VERSION || !r.u8(flags))
+        return std::nullopt;
 
-    m.add_component(dpp::component().add_component(role_select));
+    for (int shift = 0; shift < 32; shift += 8) {
+        std::uint8_t b = 0;
+        if (!r.u8(b))
+            return std::nullopt;
+        st.nonce |= static_cast<std::uint32_t>(b) << shift;
+    }
+    if (st.nonce == 0)
+        return std::nullopt;
+
+    std::uint64_t v = 0;
+    if (flags & FLAG_DATE) {
+        if (!r.varint(v) || v > 200000) // au-delà de l'an 2500
+            return std::nullopt;
+        st.date_iso = iso_from_days(static_cast<std::int64_t>(v));
+    }
+    if (flags & FLAG_START) {
+        if (!r.varint(v) || v >= 24 * 60)
+            return std::nullopt;
+        st.start_time = minutes_to_hhmm(v);
+    }
+    if (flags & FLAG_SALE) {
+        if (!r.varint(v) || v >= 24 * 60)
+            return std::nullopt;
+        st.sale_time = minutes_to_hhmm(v);
+    }
+    if (flags & FLAG_BRAS_DROIT) {
+        if (!r.varint(v))
+            return std::nullopt;
+        st.bras_droit_id = static_cast<dpp::snowflake>(v);
+    }
 
-    dpp::component row_buttons;
+    st.reprise_set = (flags & FLAG_REPRISE_SET) != 0;
+    st.reprise     = (flags & FLAG_REPRISE) != 0;
+
+    if (flags & FLAG_FLEET) {
+        std::uint8_t count   = 0;
+        std::uint8_t current = 0;
+        if (!r.u8(count) || count == 0 || count > 6 || !r.u8(current) || current >= count)
+            return std::nullopt;
+
+        st.fleet_config_started = true;
+        st.max_ships    = count;
+        st.current_ship = current;
+        st.ships.resize(count);
+
+        for (ShipConfig& sc : st.ships) {
+            std::uint8_t packed = 0;
+            if (!r.u8(packed))
+                return std::nullopt;
+
+            switch (packed >> 6) {
+                case 1: sc.hull = ShipHull::Sloop;   sc.has_hull = true; break;
+                case 2: sc.hull = ShipHull::Brig;    sc.has_hull = true; break;
+                case 3: sc.hull = ShipHull::Galleon; sc.has_hull = true; break;
+                default: break;
+            }
 
-    if (idx + 1 == total) {
-        row_buttons.add_component(
-            dpp::component()
-                .set_type(dpp::cot_button)
-                .set_id("create_alliance_ship_finish")
-                .set_label("Terminer et créer l'alliance")
-                .set_style(dpp::cos_primary)
-        );
-    } else {
-        row_buttons.add_component(
-            dpp::component()
-                .set_type(dpp::cot_button)
-                .set_id("create_alliance_ship_next")
-                .set_label("Bateau suivant")
-                .set_style(dpp::cos_primary)
-        );
+            const std::uint8_t role = packed & 0x3F;
+            if (role == ROLE_CUSTOM) {
+                if (!r.str(sc.role, CUSTOM_ROLE_MAX_BYTES))
+                    return std::nullopt;
+                sc.has_role = true;
+            } else if (role != ROLE_NONE) {
+                if (role > PRESET_ROLES.size())
+                    return std::nullopt;
+                sc.role = PRESET_ROLES[role - 1];
+                sc.has_role = true;
+            }
+        }
     }
 
-    m.add_component(row_buttons);
+    if (!r.done())
+        return std::nullopt;
+    return st;
+}
 
-    event.reply(m);
+// SQLSTATE d'une violation d'index unique.
+constexpr char UNIQUE_VIOLATION[] = "23505";
+
+std::uint32_t new_wizard_nonce() {
+    static thread_local std::mt19937 rng(std::random_device{}());
+    std::uint32_t n = 0;
+    while (n == 0)
+        n = rng();
+    return n;
 }
 
-} // namespace
+// Dans la transaction de l'appelant.
+bool wizard_alliance_exists(odb::pgsql::database& db,
+                            std::uint64_t guild_id,
+                            std::uint64_t organizer_id,
+                            std::uint32_t nonce)
+{
+    using Query = odb::query<Alliance>;
+    std::unique_ptr<Alliance> existing(db.query_one<Alliance>(
+        Query::guild_id == guild_id &&
+        Query::organizer_id == organizer_id &&
+        Query::wizard_nonce == nonce
+    ));
+    return existing != nullptr;
+}
 
-void CreateAllianceUI::open_modal(const dpp::slashcommand_t& event) {
-    if (event.command.guild_id == 0) {
-        dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
-        msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
-        return;
+// ---- custom_id de l'assistant ----------------------------------------------
+
+// "cw." + action + "." + état signé. L'action distingue les composants d'un
+// même message (Discord exige des custom_id uniques).
+constexpr char WIZARD_PREFIX[] = "cw.";
+
+namespace action {
+constexpr char date          = 'd';
+constexpr char start         = 's';
+constexpr char sale          = 'v';
+constexpr char manual        = 'm'; // bouton -> modal date & heures
+constexpr char fleet         = 'f';
+constexpr char hull          = 'h';
+constexpr char role          = 'r';
+constexpr char bras_droit    = 'b';
+constexpr char reprise       = 'p';
+constexpr char next          = 'n';
+constexpr char finish        = 't';
+constexpr char datetime_modal = 'M';
+constexpr char role_modal    = 'R';
+}
+
+std::string wizard_prefix(char act) {
+    return std::string(WIZARD_PREFIX) + act + ".";
+}
+
+// L'état n'est valable que pour l'utilisateur et le serveur qui l'ont produit.
+std::string wizard_context(const dpp::interaction_create_t& event) {
+    return std::to_string(static_cast<std::uint64_t>(event.command.guild_id)) + ":" +
+           std::to_string(static_cast<std::uint64_t>(event.command.usr.id));
+}
+
+// Action du custom_id, ou '\0' si ce n'est pas un id d'assistant.
+char wizard_action(const std::string& custom_id) {
+    const std::size_t n = sizeof(WIZARD_PREFIX) - 1;
+    if (custom_id.size() < n + 2 || custom_id.compare(0, n, WIZARD_PREFIX) != 0 || custom_id[n + 1] != '.')
+        return '\0';
+    return custom_id[n];
+}
+
+std::optional<PendingAlliance> read_state(const dpp::interaction_create_t& event,
+                                          const std::string& custom_id)
+{
+    const char act = wizard_action(custom_id);
+    if (!act)
+        return std::nullopt;
+
+    auto payload = compact_codec::open(custom_id, wizard_prefix(act), wizard_context(event));
+    if (!payload)
+        return std::nullopt;
+    return decode_state(*payload);
+}
+
+// Sérialise l'état une fois pour tous les composants d'un message.
+class WizardIds {
+public:
+    WizardIds(const dpp::interaction_create_t& event, const PendingAlliance& st)
+        : context_(wizard_context(event)), payload_(encode_state(st)) {}
+
+    // Vide si l'état ne tient pas dans un custom_id (trop de rôles personnalisés).
+    std::string id(char act) {
+        auto sealed = compact_codec::seal(wizard_prefix(act), context_, payload_);
+        if (!sealed) {
+            overflow_ = true;
+            return {};
+        }
+        return *sealed;
     }
 
-    dpp::snowflake guild_id = event.command.guild_id;
-    dpp::snowflake user_id  = event.command.usr.id;
-
-    clear_state(guild_id, user_id);
-    get_state(guild_id, user_id);
-
-    dpp::message m(
-        event.command.channel_id,
-        "Configuration de l'alliance :\n"
-        "1️⃣ Choisis la **date** (ou le bouton *Saisir la date et heures* pour une date plus éloignée)\n"
-        "2️⃣ Choisis l'**heure de début**\n"
-        "3️⃣ Choisis l'**heure de vente**\n"
-        "4️⃣ Configure la **flotte** (bouton *Configurer la flotte*)\n"
-        "5️⃣ (Optionnel) règle le **bras droit** et la **reprise des bateaux** dans le second message."
+    bool overflow() const { return overflow_; }
+
+private:
+    std::string context_;
+    std::string payload_;
+    bool overflow_ = false;
+};
+
+void reply_invalid_wizard(const dpp::interaction_create_t& event) {
+    dpp::message msg(
+        "❌ Ce formulaire n'est plus valide.\n"
+        "Relance `/alliance creer` pour recommencer."
+    );
+    msg.set_flags(dpp::m_ephemeral);
+    deferral::reply(event, msg);
+}
+
+void reply_state_too_large(const dpp::interaction_create_t& event) {
+    dpp::message msg(
+        "❌ Trop de rôles personnalisés pour cette flotte.\n"
+        "Raccourcis ce rôle ou choisis un rôle de la liste."
     );
+    msg.set_flags(dpp::m_ephemeral);
+    deferral::reply(event, msg);
+}
+
+// ---- Rendu des étapes ------------------------------------------------------
+
+std::string format_day(const std::string& iso, const TimeZone& zone) {
+    int year = 0, month = 0, day = 0;
+    if (!parse_iso_date(iso, year, month, day))
+        return iso;
+
+    const std::tm tm_day = zone.to_local(zone.from_local(year, month, day, 12, 0));
+
+    std::ostringstream oss;
+    oss << alliance_helpers::french_day_name(tm_day) << " "
+        << std::setw(2) << std::setfill('0') << day
+        << "/"
+        << std::setw(2) << std::setfill('0') << month
+        << "/" << year;
+    return oss.str();
+}
+
+// Étape 1 : date et heures. nullopt si l'état ne tient pas dans les custom_id.
+std::optional<dpp::message> render_schedule_step(const dpp::interaction_create_t& event,
+                                                 const PendingAlliance& st,
+                                                 const TimeZone& zone)
+{
+    WizardIds ids(event, st);
+
+    std::ostringstream content;
+    content << "Configuration de l'alliance :\n"
+            << "1️⃣ Choisis la **date** (ou le bouton *Saisir date & heures* pour une date plus éloignée)\n"
+            << "2️⃣ Choisis l'**heure de début**\n"
+            << "3️⃣ Choisis l'**heure de vente**\n"
+            << "4️⃣ Configure la **flotte** (bouton *Configurer la flotte*), "
+            << "ainsi que le **bras droit** et la **reprise des bateaux**.";
+
+    if (!st.date_iso.empty() || !st.start_time.empty() || !st.sale_time.empty()) {
+        content << "\n\n📅 "
+                << (st.date_iso.empty() ? "date à choisir" : "**" + format_day(st.date_iso, zone) + "**")
+                << " · début " << (st.start_time.empty() ? "?" : st.start_time)
+                << " · vente " << (st.sale_time.empty() ? "?" : st.sale_time);
+    }
 
+    dpp::message m(event.command.channel_id, content.str());
     m.set_flags(dpp::m_ephemeral);
 
     std::time_t now = std::time(nullptr);
-    std::tm local_now {};
-#ifdef _WIN32
-    localtime_s(&local_now, &now);
-#else
-    local_now = *std::localtime(&now);
-#endif
+    const std::tm local_now = zone.to_local(now);
 
     const bool is_summer_time = (local_now.tm_isdst > 0);
 
@@ -256,21 +498,23 @@ void CreateAllianceUI::open_modal(const dpp::slashcommand_t& event) {
         return oss.str();
     };
 
+    auto option = [](const std::string& label, const std::string& value, const std::string& current) {
+        dpp::select_option opt(label, value);
+        if (value == current)
+            opt.set_default(true);
+        return opt;
+    };
+
     dpp::component date_select;
     date_select.set_type(dpp::cot_selectmenu)
-               .set_id("create_alliance_date")
+               .set_id(ids.id(action::date))
                .set_placeholder("Choisis le jour de l'alliance")
                .set_min_values(1)
                .set_max_values(1);
 
     for (int i = 0; i < 21; ++i) {
         std::time_t day_ts = now + i * 24 * 3600;
-        std::tm tm_day {};
-#ifdef _WIN32
-        localtime_s(&tm_day, &day_ts);
-#else
-        tm_day = *std::localtime(&day_ts);
-#endif
+        const std::tm tm_day = zone.to_local(day_ts);
 
         char value[32];
         std::strftime(value, sizeof(value), "%Y-%m-%d", &tm_day);
@@ -284,9 +528,7 @@ void CreateAllianceUI::open_modal(const dpp::slashcommand_t& event) {
               << "/"
               << std::setw(2) << std::setfill('0') << month;
 
-        date_select.add_select_option(
-            dpp::select_option(label.str(), value)
-        );
+        date_select.add_select_option(option(label.str(), value, st.date_iso));
     }
 
     m.add_component(
@@ -295,20 +537,18 @@ void CreateAllianceUI::open_modal(const dpp::slashcommand_t& event) {
 
     dpp::component start_select;
     start_select.set_type(dpp::cot_selectmenu)
-                .set_id("create_alliance_start")
+                .set_id(ids.id(action::start))
                 .set_placeholder("Heure de début")
                 .set_min_values(1)
                 .set_max_values(1);
 
-    start_select.add_select_option(
-        dpp::select_option("7h30", "07:30")
-    );
+    start_select.add_select_option(option("7h30", "07:30", st.start_time));
 
     {
         std::ostringstream label_soir;
         label_soir << evening_start_hour << "h00";
         start_select.add_select_option(
-            dpp::select_option(label_soir.str(), hhmm(evening_start_hour))
+            option(label_soir.str(), hhmm(evening_start_hour), st.start_time)
         );
     }
 
@@ -318,7 +558,7 @@ void CreateAllianceUI::open_modal(const dpp::slashcommand_t& event) {
 
     dpp::component sale_select;
     sale_select.set_type(dpp::cot_selectmenu)
-               .set_id("create_alliance_sale")
+               .set_id(ids.id(action::sale))
                .set_placeholder("Heure de vente")
                .set_min_values(1)
                .set_max_values(1);
@@ -329,8 +569,7 @@ void CreateAllianceUI::open_modal(const dpp::slashcommand_t& event) {
                       << gold_rush_evening_hour
                       << "h00 (Gold Rush soir)";
         sale_select.add_select_option(
-            dpp::select_option(label_evening.str(),
-                               hhmm(gold_rush_evening_hour))
+            option(label_evening.str(), hhmm(gold_rush_evening_hour), st.sale_time)
         );
     }
 
@@ -340,8 +579,7 @@ void CreateAllianceUI::open_modal(const dpp::slashcommand_t& event) {
                    << gold_rush_late_hour
                    << "h00 (Gold Rush nuit)";
         sale_select.add_select_option(
-            dpp::select_option(label_late.str(),
-                               hhmm(gold_rush_late_hour))
+            option(label_late.str(), hhmm(gold_rush_late_hour), st.sale_time)
         );
     }
 
@@ -353,63 +591,324 @@ void CreateAllianceUI::open_modal(const dpp::slashcommand_t& event) {
     row_buttons.add_component(
         dpp::component()
             .set_type(dpp::cot_button)
-            .set_id("create_alliance_datetime_manual")
+            .set_id(ids.id(action::manual))
             .set_label("Saisir date & heures")
             .set_style(dpp::cos_secondary)
     );
     row_buttons.add_component(
         dpp::component()
             .set_type(dpp::cot_button)
-            .set_id("create_alliance_configure_fleet")
+            .set_id(ids.id(action::fleet))
             .set_label("Configurer la flotte")
             .set_style(dpp::cos_primary)
     );
 
     m.add_component(row_buttons);
 
-    event.reply(m);
+    if (ids.overflow())
+        return std::nullopt;
+    return m;
+}
+
+// Étape 2 : un bateau à la fois, plus les options (bras droit, reprise).
+std::optional<dpp::message> render_ship_step(const dpp::interaction_create_t& event,
+                                             const PendingAlliance& st)
+{
+    if (st.ships.empty() || st.current_ship >= st.ships.size())
+        return std::nullopt;
+
+    WizardIds ids(event, st);
+
+    const std::size_t idx   = st.current_ship;
+    const std::size_t total = st.ships.size();
+    const ShipConfig& current = st.ships[idx];
+
+    std::ostringstream content;
+    content << "⚓ Configuration du **bateau " << (idx + 1) << "/" << total << "**\n"
+            << "Choisis la **coque** et le **rôle** pour ce navire.\n"
+            << "Tu peux aussi choisir `Autre…` pour définir un rôle personnalisé.";
+
+    if (current.has_role && std::find(PRESET_ROLES.begin(), PRESET_ROLES.end(), current.role) == PRESET_ROLES.end())
+        content << "\nRôle personnalisé : **" << current.role << "**";
+
+    content << "\n\nBras droit : "
+            << (st.bras_droit_id
+                    ? "<@" + std::to_string(static_cast<std::uint64_t>(st.bras_droit_id)) + ">"
+                    : std::string("aucun"))
+            << " · Reprise des bateaux : "
+            << (st.reprise_set && st.reprise ? "prévue" : "non");
+
+    dpp::message m;
+    m.set_content(content.str());
+    m.set_flags(dpp::m_ephemeral);
+
+    auto hull_option = [&](const std::string& label, const std::string& value, ShipHull hull) {
+        dpp::select_option opt(label, value);
+        if (current.has_hull && current.hull == hull)
+            opt.set_default(true);
+        return opt;
+    };
+
+    dpp::component hull_select;
+    hull_select.set_type(dpp::cot_selectmenu)
+               .set_id(ids.id(action::hull))
+               .set_placeholder("Type de navire")
+               .set_min_values(1)
+               .set_max_values(1);
+    hull_select.add_select_option(hull_option("Sloop", "sloop", ShipHull::Sloop));
+    hull_select.add_select_option(hull_option("Brigantin", "brig", ShipHull::Brig));
+    hull_select.add_select_option(hull_option("Galion", "galleon", ShipHull::Galleon));
+
+    m.add_component(dpp::component().add_component(hull_select));
+
+    dpp::component role_select;
+    role_select.set_type(dpp::cot_selectmenu)
+               .set_id(ids.id(action::role))
+               .set_placeholder("Rôle du navire")
+               .set_min_values(1)
+               .set_max_values(1);
+    for (const std::string& role : PRESET_ROLES) {
+        dpp::select_option opt(role, role);
+        if (current.has_role && current.role == role)
+            opt.set_default(true);
+        role_select.add_select_option(opt);
+    }
+    role_select.add_select_option(dpp::select_option("Autre…", "custom"));
+
+    m.add_component(dpp::component().add_component(role_select));
+
+    dpp::component row_buttons;
+
+    if (idx + 1 == total) {
+        row_buttons.add_component(
+            dpp::component()
+                .set_type(dpp::cot_button)
+                .set_id(ids.id(action::finish))
+                .set_label("Terminer et créer l'alliance")
+                .set_style(dpp::cos_primary)
+        );
+    } else {
+        row_buttons.add_component(
+            dpp::component()
+                .set_type(dpp::cot_button)
+                .set_id(ids.id(action::next))
+                .set_label("Bateau suivant")
+                .set_style(dpp::cos_primary)
+        );
+    }
+
+    m.add_component(row_buttons);
+
+    dpp::component bras_select;
+    bras_select.set_type(dpp::cot_user_selectmenu)
+               .set_id(ids.id(action::bras_droit))
+               .set_placeholder("Choisis un bras droit (facultatif)")
+               .set_min_values(0)
+               .set_max_values(1);
+
+    dpp::component reprise_select;
+    reprise_select.set_type(dpp::cot_selectmenu)
+                  .set_id(ids.id(action::reprise))
+                  .set_placeholder("Reprise des bateaux ?")
+                  .set_min_values(1)
+                  .set_max_values(1);
+    {
+        dpp::select_option yes("Reprise prévue", "yes");
+        dpp::select_option no("Pas de reprise", "no");
+        if (st.reprise_set)
+            (st.reprise ? yes : no).set_default(true);
+        reprise_select.add_select_option(yes);
+        reprise_select.add_select_option(no);
+    }
+
+    m.add_component(dpp::component().add_component(bras_select));
+    m.add_component(dpp::component().add_component(reprise_select));
+
+    if (ids.overflow())
+        return std::nullopt;
+    return m;
+}
+
+// Remplace le message de l'assistant par l'étape correspondant à l'état.
+void update_wizard(const dpp::interaction_create_t& event, const PendingAlliance& st,
+                   const TimeZone& zone)
+{
+    auto m = st.fleet_config_started ? render_ship_step(event, st)
+                                     : render_schedule_step(event, st, zone);
+    if (!m) {
+        reply_state_too_large(event);
+        return;
+    }
+    deferral::update(event, *m);
+}
+
+struct PublishRequest {
+    std::uint64_t alliance_id     = 0;
+    std::string   alliance_name;
+    std::string   thread_title;
+    std::string   summary;         // réponse éphémère, complétée avec le lien du post
+    std::uint64_t forum_id        = 0;
+    std::uint64_t ping_channel_id = 0;
+    std::uint64_t notify_role_id  = 0;
+    std::time_t   scheduled_at    = 0;
+    std::time_t   sale_at         = 0;
+};
+
+// Publication d'une alliance déjà enregistrée : post du forum, roster et ping.
+// Le span du clic reste ouvert jusqu'à la fin de la coroutine.
+static dpp::job publish_alliance(
+    dpp::button_click_t event,
+    std::shared_ptr<odb::pgsql::database> db,
+    PublishRequest req,
+    interaction_trace::Handle interaction
+)
+{
+    {
+        // Remplace l'assistant : ses boutons ne peuvent plus recréer l'alliance.
+        dpp::message msg(req.summary + "Création du post dans le forum d'alliances...");
+        msg.set_flags(dpp::m_ephemeral);
+        co_await deferral::co_update(event, msg);
+    }
 
     dpp::cluster* cluster = event.from()->creator;
-    if (cluster) {
-        dpp::message m2(
-            event.command.channel_id,
-            "Options facultatives de l'alliance :\n"
+    if (!cluster)
+        co_return;
+
+    dpp::message starter_msg;
+    starter_msg.set_content("🏴‍☠️ **" + req.alliance_name + "**.");
+
+    // co_thread_create_in_forum reprendrait la coroutine sur le thread DPP
+    // sans contexte : le callback est rattaché à l'interaction.
+    dpp::confirmation_callback_t cb = co_await dpp::async<dpp::confirmation_callback_t>{
+        [&](auto&& done) {
+            cluster->thread_create_in_forum(
+                req.thread_title,
+                dpp::snowflake(req.forum_id),
+                starter_msg,
+                dpp::arc_1_day,
+                0,
+                {},
+                trace::bind(std::forward<decltype(done)>(done))
+            );
+        }
+    };
+
+    if (cb.is_error()) {
+        std::cerr << "[Alliance] Erreur création thread: "
+                  << cb.get_error().message << "\n";
+
+        dpp::message msg(req.summary + "❌ Impossible de créer le post dans le forum d'alliances.");
+        msg.set_flags(dpp::m_ephemeral);
+        event.edit_original_response(msg);
+        co_return;
+    }
+
+    dpp::thread thr = cb.get<dpp::thread>();
+    const std::uint64_t thread_id = static_cast<std::uint64_t>(thr.id);
+
+    co_await db_executor::run([&]() {
+        try {
+            odb::transaction t2(db->begin());
+            tx_metrics::track(t2, "create.publish");
+
+            std::unique_ptr<Alliance> a(db->load<Alliance>(req.alliance_id));
+            a->thread_channel_id(thread_id);
+            db->update(*a);
+
+            AllianceDiscordObject thread_obj(
+                req.alliance_id,
+                DiscordObjectType::thread,
+                thread_id,
+                thr.name,
+                true
+            );
+            db->persist(thread_obj);
+
+            t2.commit();
+
+            alliance_index::put(
+                thread_id,
+                alliance_index::Entry{req.alliance_id, a->guild_id(), a->status()}
+            );
+        }
+        catch (const std::exception& ex) {
+            std::cerr << "[Alliance] Erreur DB maj thread_id / thread_obj : "
+                      << ex.what() << "\n";
+        }
+    });
+
+    {
+        dpp::message msg(req.summary + "📌 Post : <#" + std::to_string(thread_id) + ">");
+        msg.set_flags(dpp::m_ephemeral);
+        event.edit_original_response(msg);
+    }
+
+    alliance_helpers::create_or_update_alliance_roster_message(
+        cluster,
+        db,
+        req.alliance_id,
+        thr.id
+    );
+
+    if (req.ping_channel_id != 0 && req.notify_role_id != 0) {
+        std::string start_ts = "<t:" + std::to_string(req.scheduled_at) + ":t>";
+        std::string sale_ts  = "<t:" + std::to_string(req.sale_at) + ":t>";
+
+        std::string content =
+            "<@&" + std::to_string(req.notify_role_id) + "> "
+            "Nouvelle alliance planifiée !\n"
+            "Début : " + start_ts + "\n"
+            "Vente : " + sale_ts + "\n"
+            "Thread : <#" + std::to_string(thread_id) + ">";
+
+        dpp::message ping_msg(
+            static_cast<dpp::snowflake>(req.ping_channel_id),
+            content
         );
-        m2.set_flags(dpp::m_ephemeral);
-
-        dpp::component bras_select;
-        bras_select.set_type(dpp::cot_user_selectmenu)
-                   .set_id("create_alliance_brasdroit")
-                   .set_placeholder("Choisis un bras droit")
-                   .set_min_values(0)
-                   .set_max_values(1);
-
-        dpp::component reprise_select;
-        reprise_select.set_type(dpp::cot_selectmenu)
-                      .set_id("create_alliance_reuse_ships")
-                      .set_placeholder("Reprise des bateaux ?")
-                      .set_min_values(1)
-                      .set_max_values(1);
-        reprise_select.add_select_option(dpp::select_option("Reprise prévue", "yes"));
-        reprise_select.add_select_option(dpp::select_option("Pas de reprise", "no"));
-
-        m2.add_component(dpp::component().add_component(bras_select));
-        m2.add_component(dpp::component().add_component(reprise_select));
-
-        cluster->interaction_followup_create(event.command.token, m2);
+        cluster->message_create(ping_msg);
+    }
+}
+
+} // namespace
+
+dpp::task<void> CreateAllianceUI::open_modal(dpp::slashcommand_t event, const TimeZone& zone) {
+    if (event.command.guild_id == 0) {
+        dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
+        msg.set_flags(dpp::m_ephemeral);
+        co_await deferral::co_reply(event, msg);
+        co_return;
+    }
+
+    PendingAlliance st;
+    st.nonce = new_wizard_nonce();
+
+    auto m = render_schedule_step(event, st, zone);
+    if (!m)
+        co_return; // état vide : tient toujours dans un custom_id
+
+    dpp::confirmation_callback_t replied = co_await deferral::co_reply(event, *m);
+    if (replied.is_error()) {
+        std::cerr << "[CreateAllianceUI] Erreur réponse open_modal : "
+                  << replied.get_error().message << "\n";
     }
 }
 
-bool CreateAllianceUI::handle_modal(const dpp::form_submit_t& event,
-                                    const std::shared_ptr<odb::pgsql::database>& /*db*/) const
+dpp::task<void> CreateAllianceUI::co_handle_modal(dpp::form_submit_t event,
+                                                  std::shared_ptr<odb::pgsql::database> db) const
 {
     if (event.command.guild_id == 0)
-        return false;
+        co_return;
 
-    if (event.custom_id == "create_alliance_datetime_modal") {
-        dpp::snowflake guild_id = event.command.guild_id;
-        dpp::snowflake user_id  = event.command.usr.id;
+    const char act = wizard_action(event.custom_id);
+    std::optional<PendingAlliance> decoded = read_state(event, event.custom_id);
+    if (!decoded) {
+        reply_invalid_wizard(event);
+        co_return;
+    }
+    PendingAlliance state = std::move(*decoded);
+    const TimeZone& zone = bot_settings_cache::zone(*db, static_cast<std::uint64_t>(event.command.guild_id));
 
+    if (act == action::datetime_modal) {
         std::string date_input  = trim(get_text_field(event, 0, 0));
         std::string start_input = trim(get_text_field(event, 1, 0));
         std::string sale_input  = trim(get_text_field(event, 2, 0));
@@ -420,16 +919,16 @@ bool CreateAllianceUI::handle_modal(const dpp::form_submit_t& event,
                 "❌ Merci de renseigner **date, heure de début et heure de vente**.\n"
                 "Exemple : `15/11`, `07:30`, `18:00`."
             );
-            return true;
+            co_return;
         }
 
         std::string iso;
-        if (!parse_french_date_to_iso(date_input, iso)) {
+        if (!parse_french_date_to_iso(date_input, zone, iso)) {
             reply_ephemeral(
                 event,
                 "❌ Je n'ai pas compris la date. Essaie par exemple `15/11` ou `15/11/2025`."
             );
-            return true;
+            co_return;
         }
 
         std::string start_hhmm;
@@ -440,7 +939,7 @@ bool CreateAllianceUI::handle_modal(const dpp::form_submit_t& event,
                 event,
                 "❌ Je n'ai pas compris l'heure de début. Essaie par exemple `7h30` ou `07:30`."
             );
-            return true;
+            co_return;
         }
 
         if (!parse_time_to_hhmm(sale_input, sale_hhmm)) {
@@ -448,59 +947,33 @@ bool CreateAllianceUI::handle_modal(const dpp::form_submit_t& event,
                 event,
                 "❌ Je n'ai pas compris l'heure de vente. Essaie par exemple `18h00` ou `18:00`."
             );
-            return true;
+            co_return;
         }
 
         std::time_t t_start = 0;
         std::time_t t_sale  = 0;
-        if (!make_time_t(iso, start_hhmm, t_start) ||
-            !make_time_t(iso, sale_hhmm,  t_sale)) {
+        if (!make_time_t(iso, start_hhmm, zone, t_start) ||
+            !make_time_t(iso, sale_hhmm,  zone, t_sale)) {
             reply_ephemeral(
                 event,
                 "❌ Impossible d'interpréter la date/heure, vérifie les valeurs."
             );
-            return true;
+            co_return;
         }
 
-        PendingAlliance& state = get_state(guild_id, user_id);
         state.date_iso   = iso;
         state.start_time = start_hhmm;
         state.sale_time  = sale_hhmm;
 
-        int year = 0, month = 0, day = 0;
-        parse_iso_date(iso, year, month, day);
-
-        std::tm tm_day {};
-        tm_day.tm_year = year - 1900;
-        tm_day.tm_mon  = month - 1;
-        tm_day.tm_mday = day;
-        std::mktime(&tm_day);
-
-        std::ostringstream oss;
-        oss << "✅ Date et heures mises à jour : **"
-            << alliance_helpers::french_day_name(tm_day) << " "
-            << std::setw(2) << std::setfill('0') << day
-            << "/"
-            << std::setw(2) << std::setfill('0') << month
-            << "/" << year
-            << "** de " << start_hhmm << " à " << sale_hhmm << ".";
-
-        reply_ephemeral(event, oss.str());
-        return true;
+        // Modal ouvert depuis le message de l'assistant : on le met à jour.
+        update_wizard(event, state, zone);
+        co_return;
     }
 
-    if (event.custom_id == "create_alliance_ship_role_custom_modal") {
-        dpp::snowflake guild_id = event.command.guild_id;
-        dpp::snowflake user_id  = event.command.usr.id;
-
-        PendingAlliance& state = get_state(guild_id, user_id);
+    if (act == action::role_modal) {
         if (!state.fleet_config_started || state.ships.empty()) {
-            reply_ephemeral(
-                event,
-                "❌ La configuration de flotte a expiré ou n'est plus valide.\n"
-                "Relance `/create_alliance` puis clique sur **Configurer la flotte**."
-            );
-            return true;
+            reply_invalid_wizard(event);
+            co_return;
         }
 
         std::string role;
@@ -513,76 +986,78 @@ bool CreateAllianceUI::handle_modal(const dpp::form_submit_t& event,
                 event,
                 "❌ Impossible de lire le rôle saisi. Réessaie."
             );
-            return true;
+            co_return;
         }
 
         if (role.empty()) {
             reply_ephemeral(event, "❌ Merci de saisir un nom de rôle pour le bateau.");
-            return true;
+            co_return;
         }
 
-        if (state.current_ship >= state.ships.size())
-            state.current_ship = state.ships.size() - 1;
-
         ShipConfig& sc = state.ships[state.current_ship];
         sc.role = role;
         sc.has_role = true;
 
-        reply_ephemeral(
-            event,
-            "✅ Rôle personnalisé défini : **" + role + "**."
-        );
-        return true;
+        update_wizard(event, state, zone);
+        co_return;
     }
 
-    return false;
+    reply_invalid_wizard(event);
 }
 
 bool CreateAllianceUI::handle_select(const dpp::select_click_t& event,
-                                     const std::shared_ptr<odb::pgsql::database>& /*db*/)
+                                     const std::shared_ptr<odb::pgsql::database>& db)
 {
-    const std::string& id = event.custom_id;
-
     if (event.command.guild_id == 0)
         return false;
 
+    const char act = wizard_action(event.custom_id);
+    if (!act)
+        return false;
+
+    std::optional<PendingAlliance> decoded = read_state(event, event.custom_id);
+    if (!decoded) {
+        reply_invalid_wizard(event);
+        return true;
+    }
+    PendingAlliance state = std::move(*decoded);
+    const TimeZone& zone = bot_settings_cache::zone(*db, static_cast<std::uint64_t>(event.command.guild_id));
+
+    // Sélecteur d'utilisateur vidé : plus de bras droit.
+    if (act == action::bras_droit) {
+        state.bras_droit_id = 0;
+        if (!event.values.empty()) {
+            try {
+                state.bras_droit_id = static_cast<dpp::snowflake>(std::stoull(event.values[0]));
+            } catch (...) {
+                state.bras_droit_id = 0;
+            }
+        }
+        update_wizard(event, state, zone);
+        return true;
+    }
+
     if (event.values.empty()) {
         ack_select(event);
         return true;
     }
 
-    dpp::snowflake guild_id = event.command.guild_id;
-    dpp::snowflake user_id  = event.command.usr.id;
-
-    PendingAlliance& state = get_state(guild_id, user_id);
     const std::string& value = event.values[0];
 
-    if (id == "create_alliance_date") {
+    if (act == action::date) {
         state.date_iso = value;
-        ack_select(event);
-        return true;
     }
-    else if (id == "create_alliance_start") {
+    else if (act == action::start) {
         state.start_time = value;
-        ack_select(event);
-        return true;
     }
-    else if (id == "create_alliance_sale") {
+    else if (act == action::sale) {
         state.sale_time = value;
-        ack_select(event);
-        return true;
     }
-    else if (id == "create_alliance_brasdroit") {
-        try {
-            std::uint64_t uid = std::stoull(value);
-            state.bras_droit_id = static_cast<dpp::snowflake>(uid);
-        } catch (...) {
-            state.bras_droit_id = 0;
-        }
-        ack_select(event);
-        return true;
+    else if (act == action::reprise) {
+        state.reprise = (value == "yes");
+        state.reprise_set = true;
     }
-    else if (id == "create_alliance_ship_hull") {
+    else if (act == action::hull || act == action::role) {
         if (!state.fleet_config_started || state.ships.empty()) {
             ack_select(event);
             return true;
@@ -590,29 +1065,28 @@ bool CreateAllianceUI::handle_select(const dpp::select_click_t& event,
 
         ShipConfig& sc = state.ships[state.current_ship];
 
-        if (value == "sloop") {
-            sc.hull = ShipHull::Sloop;
-        } else if (value == "brig") {
-            sc.hull = ShipHull::Brig;
-        } else if (value == "galleon") {
-            sc.hull = ShipHull::Galleon;
-        }
-        sc.has_hull = true;
-
-        ack_select(event);
-        return true;
-    }
-    else if (id == "create_alliance_ship_role") {
-        if (!state.fleet_config_started || state.ships.empty()) {
-            ack_select(event);
-            return true;
+        if (act == action::hull) {
+            if (value == "sloop") {
+                sc.hull = ShipHull::Sloop;
+            } else if (value == "brig") {
+                sc.hull = ShipHull::Brig;
+            } else if (value == "galleon") {
+                sc.hull = ShipHull::Galleon;
+            }
+            sc.has_hull = true;
         }
+        else if (value == "custom") {
+            // L'état voyage dans l'id du modal jusqu'à sa soumission.
+            auto modal_id = compact_codec::seal(
+                wizard_prefix(action::role_modal), wizard_context(event), encode_state(state)
+            );
+            if (!modal_id) {
+                reply_state_too_large(event);
+                return true;
+            }
 
-        ShipConfig& sc = state.ships[state.current_ship];
-
-        if (value == "custom") {
             dpp::interaction_modal_response modal(
-                "create_alliance_ship_role_custom_modal",
+                *modal_id,
                 "Rôle personnalisé du bateau"
             );
 
@@ -623,47 +1097,57 @@ bool CreateAllianceUI::handle_select(const dpp::select_click_t& event,
                     .set_type(dpp::cot_text)
                     .set_placeholder("Ex: Reaper")
                     .set_min_length(1)
-                    .set_max_length(50)
+                    .set_max_length(CUSTOM_ROLE_MAX)
                     .set_text_style(dpp::text_short)
             );
 
-            event.dialog(modal);
+            deferral::dialog(event, modal);
             return true;
-        } else {
+        }
+        else {
             sc.role = value;
             sc.has_role = true;
-            ack_select(event);
-            return true;
         }
     }
-    else if (id == "create_alliance_reuse_ships") {
-        if (value == "yes") {
-            state.reprise = true;
-        } else {
-            state.reprise = false;
-        }
-        state.reprise_set = true;
-        ack_select(event);
-        return true;
+    else {
+        return false;
     }
 
-    return false;
+    update_wizard(event, state, zone);
+    return true;
 }
 
 bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
                                      const std::shared_ptr<odb::pgsql::database>& db)
 {
-    const std::string& id = event.custom_id;
-
     if (event.command.guild_id == 0)
         return false;
 
+    const char act = wizard_action(event.custom_id);
+    if (!act)
+        return false;
+
+    std::optional<PendingAlliance> decoded = read_state(event, event.custom_id);
+    if (!decoded) {
+        reply_invalid_wizard(event);
+        return true;
+    }
+    PendingAlliance state = std::move(*decoded);
+    const TimeZone& zone = bot_settings_cache::zone(*db, static_cast<std::uint64_t>(event.command.guild_id));
+
     dpp::snowflake guild_id = event.command.guild_id;
-    dpp::snowflake user_id  = event.command.usr.id;
 
-    if (id == "create_alliance_datetime_manual") {
+    if (act == action::manual) {
+        auto modal_id = compact_codec::seal(
+            wizard_prefix(action::datetime_modal), wizard_context(event), encode_state(state)
+        );
+        if (!modal_id) {
+            reply_state_too_large(event);
+            return true;
+        }
+
         dpp::interaction_modal_response modal(
-            "create_alliance_datetime_modal",
+            *modal_id,
             "Date & heures de l'alliance"
         );
 
@@ -702,30 +1186,26 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
                 .set_text_style(dpp::text_short)
         );
 
-        event.dialog(modal);
+        deferral::dialog(event, modal);
         return true;
     }
 
-    if (id == "create_alliance_configure_fleet") {
-        PendingAlliance& state = get_state(guild_id, user_id);
-
+    if (act == action::fleet) {
         std::uint64_t guild_id_u64 = static_cast<std::uint64_t>(guild_id);
         unsigned short max_ships = 6;
 
         try {
-            odb::transaction t(db->begin());
-            std::unique_ptr<BotSettings> s(db->load<BotSettings>(guild_id_u64));
+            auto s = bot_settings_cache::get(*db, guild_id_u64);
+            if (!s) {
+                dpp::message msg(
+                    "❌ Ce serveur n'est pas encore configuré.\n"
+                    "Lance d'abord `/setup` pour définir les salons et rôles."
+                );
+                msg.set_flags(dpp::m_ephemeral);
+                deferral::reply(event, msg);
+                return true;
+            }
             max_ships = s->default_max_ships();
-            t.commit();
-        }
-        catch (const odb::object_not_persistent&) {
-            dpp::message msg(
-                "❌ Ce serveur n'est pas encore configuré.\n"
-                "Lance d'abord `/setup` pour définir les salons et rôles."
-            );
-            msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
-            return true;
         }
         catch (const std::exception& ex) {
             dpp::message msg(
@@ -733,7 +1213,7 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
                 + ex.what()
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -748,68 +1228,59 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
         state.current_ship = 0;
         state.fleet_config_started = true;
 
-        send_ship_config_prompt(event, guild_id, user_id, state);
+        update_wizard(event, state, zone);
         return true;
     }
 
-    if (id == "create_alliance_ship_next") {
-        PendingAlliance& state = get_state(guild_id, user_id);
-
+    if (act == action::next) {
         if (!state.fleet_config_started || state.ships.empty()) {
             dpp::message msg("❌ Commence par cliquer sur **Configurer la flotte**.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
-        if (state.current_ship >= state.ships.size())
-            state.current_ship = state.ships.size() - 1;
-
-        ShipConfig& sc = state.ships[state.current_ship];
+        const ShipConfig& sc = state.ships[state.current_ship];
 
         if (!sc.has_hull || !sc.has_role) {
             dpp::message msg("❌ Merci de choisir **coque** et **rôle** pour ce bateau.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
         if (state.current_ship + 1 < state.ships.size()) {
             state.current_ship++;
-            send_ship_config_prompt(event, guild_id, user_id, state);
+            update_wizard(event, state, zone);
         } else {
             dpp::message msg(
                 "✅ Flotte configurée ! Tu peux maintenant terminer avec le dernier écran."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
         }
 
         return true;
     }
 
-    if (id == "create_alliance_ship_finish") {
-        PendingAlliance& state = get_state(guild_id, user_id);
-
+    if (act == action::finish) {
         if (!state.fleet_config_started || state.ships.empty()) {
             dpp::message msg(
                 "❌ Tu dois d'abord configurer la flotte avec **Configurer la flotte**."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
-        if (state.current_ship >= state.ships.size())
-            state.current_ship = state.ships.size() - 1;
         {
-            ShipConfig& sc = state.ships[state.current_ship];
+            const ShipConfig& sc = state.ships[state.current_ship];
             if (!sc.has_hull || !sc.has_role) {
                 dpp::message msg(
                     "❌ Merci de choisir **coque** et **rôle** pour ce dernier bateau."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
         }
@@ -829,7 +1300,7 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
                 "❌ Impossible de créer l'alliance, il manque :\n" + missing
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -840,22 +1311,20 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
         unsigned short max_ships                = 6;
 
         try {
-            odb::transaction t(db->begin());
-            std::unique_ptr<BotSettings> s(db->load<BotSettings>(guild_id_u64));
+            auto s = bot_settings_cache::get(*db, guild_id_u64);
+            if (!s) {
+                dpp::message msg(
+                    "❌ Ce serveur n'est pas encore configuré.\n"
+                    "Lance d'abord `/setup` pour définir les salons et rôles."
+                );
+                msg.set_flags(dpp::m_ephemeral);
+                deferral::reply(event, msg);
+                return true;
+            }
             alliance_forum_channel_id = s->alliance_forum_channel_id();
             ping_channel_id           = s->ping_channel_id();
             notify_role_id            = s->notify_role_id();
             max_ships                 = s->default_max_ships();
-            t.commit();
-        }
-        catch (const odb::object_not_persistent&) {
-            dpp::message msg(
-                "❌ Ce serveur n'est pas encore configuré.\n"
-                "Lance d'abord `/setup` pour définir les salons et rôles."
-            );
-            msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
-            return true;
         }
         catch (const std::exception& ex) {
             dpp::message msg(
@@ -863,7 +1332,7 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
                 + ex.what()
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -873,7 +1342,7 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
                 "Va dans `/setup` → **Salons** pour le définir."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -884,17 +1353,17 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
         std::time_t scheduled_at = 0;
         std::time_t sale_at      = 0;
 
-        if (!make_time_t(state.date_iso, state.start_time, scheduled_at)) {
+        if (!make_time_t(state.date_iso, state.start_time, zone, scheduled_at)) {
             dpp::message msg("❌ Impossible d'interpréter l'heure de début.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
-        if (!make_time_t(state.date_iso, state.sale_time, sale_at)) {
+        if (!make_time_t(state.date_iso, state.sale_time, zone, sale_at)) {
             dpp::message msg("❌ Impossible d'interpréter l'heure de vente.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -905,56 +1374,25 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
                     "❌ Impossible d'interpréter la date de l'alliance."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
-                return true;
-            }
-
-            std::tm tm_day {};
-            tm_day.tm_year = year - 1900;
-            tm_day.tm_mon  = month - 1;
-            tm_day.tm_mday = day;
-            tm_day.tm_hour = 12;
-            tm_day.tm_min  = 0;
-            tm_day.tm_sec  = 0;
-
-            std::time_t base = std::mktime(&tm_day);
-            if (base == -1) {
-                dpp::message msg(
-                    "❌ Impossible de calculer la date de fin de l'alliance."
-                );
-                msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
 
-            base += 24 * 3600;
-            std::tm* tm_next = std::localtime(&base);
-            if (!tm_next) {
-                dpp::message msg(
-                    "❌ Impossible de calculer la date du lendemain."
-                );
-                msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
-                return true;
-            }
+            // Vente après minuit : même heure, le lendemain.
+            const std::tm tm_next = zone.to_local(zone.from_local(year, month, day + 1, 12, 0));
 
-            char buf[32];
-            std::snprintf(
+            char buf[20];
+            const std::string iso_next_day(
                 buf,
-                sizeof(buf),
-                "%04d-%02d-%02d",
-                tm_next->tm_year + 1900,
-                tm_next->tm_mon + 1,
-                tm_next->tm_mday
+                time_parse::format_iso_date(tm_next.tm_year + 1900, tm_next.tm_mon + 1, tm_next.tm_mday, buf)
             );
-            std::string iso_next_day = buf;
 
-            if (!make_time_t(iso_next_day, state.sale_time, sale_at)) {
+            if (!make_time_t(iso_next_day, state.sale_time, zone, sale_at)) {
                 dpp::message msg(
                     "❌ Impossible d'interpréter l'heure de vente (lendemain)."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
 
@@ -963,7 +1401,7 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
                     "❌ L'heure de vente doit être **après** l'heure de début."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
         }
@@ -975,7 +1413,7 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
                 "❌ L'heure de début doit être dans le futur."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -995,183 +1433,117 @@ bool CreateAllianceUI::handle_button(const dpp::button_click_t& event,
         std::uint64_t organizer_id =
             static_cast<std::uint64_t>(event.command.usr.id);
 
+        bool already_created = false;
+
         try {
             odb::transaction t(db->begin());
+            tx_metrics::track(t, "create.insert");
+
+            if (wizard_alliance_exists(*db, guild_id_u64, organizer_id, state.nonce)) {
+                already_created = true;
+            } else {
+                Alliance alliance(
+                    guild_id_u64,
+                    organizer_id,
+                    alliance_name,
+                    scheduled_at,
+                    sale_at,
+                    max_ships
+                );
+                alliance.right_hand(bras_droit_str);
+                alliance.ships_reuse_planned(state.reprise);
+                alliance.wizard_nonce(state.nonce);
 
-            Alliance alliance(
-                guild_id_u64,
-                organizer_id,
-                alliance_name,
-                scheduled_at,
-                sale_at,
-                max_ships
-            );
-            alliance.right_hand(bras_droit_str);
-            alliance.ships_reuse_planned(state.reprise);
-
-            db->persist(alliance);
-            alliance_id = alliance.id();
+                db->persist(alliance);
+                alliance_id = alliance.id();
 
-            unsigned short slot = 1;
-            for (const auto& sc : state.ships) {
-                HullType db_hull = HullType::brig;
+                unsigned short slot = 1;
+                for (const auto& sc : state.ships) {
+                    HullType db_hull = HullType::brig;
 
-                switch (sc.hull) {
-                    case ShipHull::Sloop:   db_hull = HullType::sloop;   break;
-                    case ShipHull::Brig:    db_hull = HullType::brig;    break;
-                    case ShipHull::Galleon: db_hull = HullType::galleon; break;
-                }
+                    switch (sc.hull) {
+                        case ShipHull::Sloop:   db_hull = HullType::sloop;   break;
+                        case ShipHull::Brig:    db_hull = HullType::brig;    break;
+                        case ShipHull::Galleon: db_hull = HullType::galleon; break;
+                    }
 
-                std::string role = sc.role.empty() ? "Libre" : sc.role;
+                    std::string role = sc.role.empty() ? "Libre" : sc.role;
 
-                Ship ship(
-                    alliance_id,
-                    slot,
-                    db_hull,
-                    role
-                );
+                    Ship ship(
+                        alliance_id,
+                        slot,
+                        db_hull,
+                        role
+                    );
 
-                db->persist(ship);
-                ++slot;
+                    db->persist(ship);
+                    ++slot;
+                }
             }
 
             t.commit();
         }
+        catch (const odb::pgsql::database_exception& ex) {
+            // Deux clics traités en même temps : l'index unique refuse le second.
+            if (ex.sqlstate() != UNIQUE_VIOLATION) {
+                dpp::message msg(
+                    std::string("❌ Erreur DB lors de la création de l'alliance : ")
+                    + ex.what()
+                );
+                msg.set_flags(dpp::m_ephemeral);
+                deferral::reply(event, msg);
+                return true;
+            }
+            already_created = true;
+        }
         catch (const std::exception& ex) {
             dpp::message msg(
                 std::string("❌ Erreur DB lors de la création de l'alliance : ")
                 + ex.what()
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
+            return true;
+        }
+
+        if (already_created) {
+            dpp::message msg("✅ Cette alliance a déjà été créée, son post est dans le forum d'alliances.");
+            msg.set_flags(dpp::m_ephemeral);
+            deferral::update(event, msg);
             return true;
         }
 
         std::string start_ts = "<t:" + std::to_string(scheduled_at) + ":t>";
         std::string sale_ts  = "<t:" + std::to_string(sale_at) + ":t>";
 
-        {
-            std::ostringstream oss;
-            oss << "✅ Alliance **" << alliance_name << "** créée !\n"
+        std::ostringstream summary;
+        summary << "✅ Alliance **" << alliance_name << "** créée !\n"
                 << "Début : " << start_ts << "\n"
                 << "Vente : " << sale_ts << "\n"
-                << "Bateaux max (paramètre serveur) : " << max_ships << "\n"
-                << "Création du post dans le forum d'alliances...";
-
-            dpp::message msg;
-            msg.set_content(oss.str());
-            msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
-        }
-
-        dpp::cluster* cluster = event.from()->creator;
-        if (!cluster) {
-            clear_state(guild_id, user_id);
-            return true;
-        }
+                << "Bateaux max (paramètre serveur) : " << max_ships << "\n";
 
-        std::tm tm_start {};
-#ifdef _WIN32
-        localtime_s(&tm_start, &scheduled_at);
-#else
-        tm_start = *std::localtime(&scheduled_at);
-#endif
+        const std::tm tm_start = zone.to_local(scheduled_at);
 
         std::ostringstream title_oss;
         title_oss << alliance_helpers::french_day_name(tm_start) << " "
                   << std::setw(2) << std::setfill('0') << tm_start.tm_mday
                   << "/"
                   << std::setw(2) << std::setfill('0') << (tm_start.tm_mon + 1)
-                  << " " << alliance_helpers::format_hhmm(scheduled_at)
-                  << " - " << alliance_helpers::format_hhmm(sale_at);
-
-        std::string thread_title = title_oss.str();
-
-        dpp::message starter_msg;
-        starter_msg.set_content("🏴‍☠️ **" + alliance_name + "**.");
-
-        dpp::snowflake forum_channel_sf(alliance_forum_channel_id);
-
-        clear_state(guild_id, user_id);
-
-        cluster->thread_create_in_forum(
-            thread_title,
-            forum_channel_sf,
-            starter_msg,
-            dpp::arc_1_day,
-            0,
-            {},
-            [db,
-             alliance_id,
-             scheduled_at, sale_at,
-             ping_channel_id, notify_role_id,
-             cluster]
-            (const dpp::confirmation_callback_t& cb) {
-
-                if (cb.is_error()) {
-                    std::cerr << "[Alliance] Erreur création thread: "
-                              << cb.get_error().message << "\n";
-                    return;
-                }
-
-                dpp::thread thr = cb.get<dpp::thread>();
-                dpp::snowflake thread_id = thr.id;
-
-                try {
-                    odb::transaction t2(db->begin());
-
-                    std::unique_ptr<Alliance> a(db->load<Alliance>(alliance_id));
-                    a->thread_channel_id(
-                        static_cast<std::uint64_t>(thread_id)
-                    );
-                    db->update(*a);
-
-                    AllianceDiscordObject thread_obj(
-                        alliance_id,
-                        DiscordObjectType::thread,
-                        static_cast<std::uint64_t>(thread_id),
-                        thr.name,
-                        true
-                    );
-                    db->persist(thread_obj);
-
-                    t2.commit();
-                }
-                catch (const std::exception& ex) {
-                    std::cerr << "[Alliance] Erreur DB maj thread_id / thread_obj : "
-                              << ex.what() << "\n";
-                }
-
-                alliance_helpers::create_or_update_alliance_roster_message(
-                    cluster,
-                    db,
-                    alliance_id,
-                    thread_id
-                );
-
-                if (ping_channel_id != 0 && notify_role_id != 0) {
-                    std::string start_ts2 =
-                        "<t:" + std::to_string(scheduled_at) + ":t>";
-                    std::string sale_ts2  =
-                        "<t:" + std::to_string(sale_at) + ":t>";
-
-                    std::string content =
-                        "<@&" + std::to_string(notify_role_id) + "> "
-                        "Nouvelle alliance planifiée !\n"
-                        "Début : " + start_ts2 + "\n"
-                        "Vente : " + sale_ts2 + "\n"
-                        "Thread : <#" + std::to_string(
-                            static_cast<std::uint64_t>(thread_id)
-                        ) + ">";
-
-                    dpp::message ping_msg(
-                        static_cast<dpp::snowflake>(ping_channel_id),
-                        content
-                    );
-                    cluster->message_create(ping_msg);
-                }
-            }
-        );
+                  << " " << alliance_helpers::format_hhmm(scheduled_at, zone)
+                  << " - " << alliance_helpers::format_hhmm(sale_at, zone);
+
+        PublishRequest req;
+        req.alliance_id     = alliance_id;
+        req.alliance_name   = alliance_name;
+        req.thread_title    = title_oss.str();
+        req.summary         = summary.str();
+        req.forum_id        = alliance_forum_channel_id;
+        req.ping_channel_id = ping_channel_id;
+        req.notify_role_id  = notify_role_id;
+        req.scheduled_at    = scheduled_at;
+        req.sale_at         = sale_at;
+
+        publish_alliance(event, db, std::move(req), interaction_trace::take());
 
         return true;
     }
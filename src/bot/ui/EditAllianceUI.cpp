@@ -20,11 +20,16 @@
 #include "ships-odb.hxx"
 
 #include "bot/AllianceHelpers.hpp"
+#include "bot/AllianceIndex.hpp"
+#include "bot/Deferral.hpp"
+#include "db/BotSettingsCache.hpp"
+#include "db/TxMetrics.hpp"
+#include "util/TimeParse.hpp"
+#include "util/TimeZone.hpp"
 
 namespace {
 
 using alliance_helpers::trim;
-using alliance_helpers::parse_time_to_hhmm;
 using alliance_helpers::parse_date_ddmm;
 
 static std::uint64_t parse_mention_id(const std::string& mention) {
@@ -46,7 +51,7 @@ static std::uint64_t parse_mention_id(const std::string& mention) {
 
 static void ack_select(const dpp::select_click_t& event)
 {
-    event.reply();
+    deferral::ack(event);
 }
 
 static bool set_ship_hull_from_value(Ship& ship, const std::string& value)
@@ -75,35 +80,30 @@ void EditAllianceUI::open(const dpp::slashcommand_t& event,
     if (guild_id == 0) {
         dpp::message msg("❌ Cette commande ne peut pas être utilisée en messages privés.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
     try {
-        using AllianceQuery  = odb::query<Alliance>;
-        using AllianceResult = odb::result<Alliance>;
-
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "edit.open");
 
-        AllianceResult ares(
-            db->query<Alliance>(
-                AllianceQuery::guild_id == guild_id &&
-                AllianceQuery::thread_channel_id == channel_id
-            )
+        std::unique_ptr<Alliance> alliance_ptr(
+            alliance_index::load_alliance(*db, guild_id, channel_id)
         );
 
-        if (ares.empty()) {
+        if (!alliance_ptr) {
             t.commit();
             dpp::message msg(
                 "❌ Ce thread n'est plus associé à une alliance.\n"
                 "La commande `/alliance edit` doit être utilisée **dans un post d'alliance créé par le bot**."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
-        Alliance alliance = *ares.begin();
+        Alliance alliance = *alliance_ptr;
         t.commit();
 
         const std::uint64_t organizer_id = alliance.organizer_id();
@@ -115,7 +115,7 @@ void EditAllianceUI::open(const dpp::slashcommand_t& event,
                 "❌ Tu n'es **ni l'organisateur** ni **le bras droit** de cette alliance."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
@@ -126,7 +126,7 @@ void EditAllianceUI::open(const dpp::slashcommand_t& event,
                 "❌ Cette alliance est **terminée** ou **annulée**, tu ne peux plus la modifier."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
@@ -134,8 +134,9 @@ void EditAllianceUI::open(const dpp::slashcommand_t& event,
         const std::time_t sale_at      = alliance.sale_at();
         const bool reprise             = alliance.ships_reuse_planned();
 
-        const std::string start_str = alliance_helpers::format_hhmm(scheduled_at);
-        const std::string sale_str  = alliance_helpers::format_hhmm(sale_at);
+        const TimeZone& zone = bot_settings_cache::zone(*db, alliance.guild_id());
+        const std::string start_str = alliance_helpers::format_hhmm(scheduled_at, zone);
+        const std::string sale_str  = alliance_helpers::format_hhmm(sale_at, zone);
 
         const std::string start_ts = "<t:" + std::to_string(scheduled_at) + ":t>";
         const std::string sale_ts  = "<t:" + std::to_string(sale_at) + ":t>";
@@ -189,13 +190,13 @@ void EditAllianceUI::open(const dpp::slashcommand_t& event,
             dpp::component().add_component(reuse_select)
         );
 
-        event.reply(msg);
+        deferral::reply(event, msg);
     }
     catch (const std::exception& ex) {
         std::cerr << "[EditAllianceUI::open] Exception : " << ex.what() << "\n";
         dpp::message msg("❌ Erreur interne lors de l'ouverture de l'éditeur.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
     }
 }
 
@@ -249,7 +250,7 @@ bool EditAllianceUI::handle_button(const dpp::button_click_t& event,
                 .set_text_style(dpp::text_short)
         );
 
-        event.dialog(modal);
+        deferral::dialog(event, modal);
         return true;
     }
 
@@ -261,41 +262,22 @@ bool EditAllianceUI::handle_button(const dpp::button_click_t& event,
         std::uint64_t channel_id_u64 = static_cast<std::uint64_t>(channel_id);
 
         try {
-            using AllianceQuery  = odb::query<Alliance>;
-            using AllianceResult = odb::result<Alliance>;
-            using ShipQuery      = odb::query<Ship>;
-            using ShipResult     = odb::result<Ship>;
-
             odb::transaction t(db->begin());
+            tx_metrics::track(t, "edit.fleet_menu");
 
-            AllianceResult ares(
-                db->query<Alliance>(
-                    AllianceQuery::guild_id == guild_id_u64 &&
-                    AllianceQuery::thread_channel_id == channel_id_u64
-                )
-            );
-
-            auto ait = ares.begin();
-            if (ait == ares.end()) {
+            alliance_helpers::AllianceRosterData roster;
+            if (!alliance_helpers::fetch_alliance_roster_by_thread(*db, guild_id_u64, channel_id_u64, roster)) {
                 t.commit();
                 dpp::message msg("❌ Ce thread n'est plus associé à une alliance connue.");
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
 
-            Alliance alliance = *ait;
+            Alliance& alliance = roster.alliance;
             std::uint64_t alliance_id = alliance.id();
 
-            ShipQuery sq(ShipQuery::alliance_id == alliance_id);
-            sq += " ORDER BY " + ShipQuery::slot;
-
-            ShipResult sres(db->query<Ship>(sq));
-
-            std::vector<Ship> ships;
-            for (const Ship& s : sres) {
-                ships.push_back(s);
-            }
+            std::vector<Ship>& ships = roster.ships;
 
             t.commit();
 
@@ -305,7 +287,7 @@ bool EditAllianceUI::handle_button(const dpp::button_click_t& event,
                     "Tu peux d'abord configurer la flotte via `/create`."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
 
@@ -342,7 +324,7 @@ bool EditAllianceUI::handle_button(const dpp::button_click_t& event,
             row.add_component(ship_select);
             m.add_component(row);
 
-            event.reply(m);
+            deferral::reply(event, m);
             return true;
         }
         catch (const std::exception& ex) {
@@ -350,7 +332,7 @@ bool EditAllianceUI::handle_button(const dpp::button_click_t& event,
                       << ex.what() << "\n";
             dpp::message msg("❌ Erreur interne lors du chargement de la flotte.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
     }
@@ -386,40 +368,22 @@ bool EditAllianceUI::handle_select(const dpp::select_click_t& event,
         }
 
         try {
-            using AllianceQuery  = odb::query<Alliance>;
-            using AllianceResult = odb::result<Alliance>;
-            using ShipQuery      = odb::query<Ship>;
-            using ShipResult     = odb::result<Ship>;
-
             odb::transaction t(db->begin());
+            tx_metrics::track(t, "edit.ship_menu");
 
-            AllianceResult ares(
-                db->query<Alliance>(
-                    AllianceQuery::guild_id == guild_id_u64 &&
-                    AllianceQuery::thread_channel_id == channel_id_u64
-                )
-            );
-
-            auto ait = ares.begin();
-            if (ait == ares.end()) {
+            alliance_helpers::AllianceRosterData roster;
+            if (!alliance_helpers::fetch_alliance_roster_by_thread(*db, guild_id_u64, channel_id_u64, roster)) {
                 t.commit();
                 dpp::message msg("❌ Ce thread n'est plus associé à une alliance connue.");
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
 
-            Alliance alliance = *ait;
+            Alliance& alliance = roster.alliance;
             std::uint64_t alliance_id = alliance.id();
 
-            ShipQuery sq(ShipQuery::alliance_id == alliance_id);
-            sq += " ORDER BY " + ShipQuery::slot;
-            ShipResult sres(db->query<Ship>(sq));
-
-            std::vector<Ship> ships;
-            for (const Ship& s : sres) {
-                ships.push_back(s);
-            }
+            std::vector<Ship>& ships = roster.ships;
 
             Ship* target = nullptr;
             std::size_t index = 0;
@@ -435,7 +399,7 @@ bool EditAllianceUI::handle_select(const dpp::select_click_t& event,
                 t.commit();
                 dpp::message msg("❌ Ce bateau n'existe plus pour cette alliance.");
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
 
@@ -508,14 +472,14 @@ bool EditAllianceUI::handle_select(const dpp::select_click_t& event,
 
             m.add_component(dpp::component().add_component(role_select));
 
-            event.reply(m);
+            deferral::reply(event, m);
         }
         catch (const std::exception& ex) {
             std::cerr << "[EditAllianceUI::handle_select] Erreur DB (choose_ship) : "
                       << ex.what() << "\n";
             dpp::message msg("❌ Erreur interne lors du chargement du bateau.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
         }
 
         return true;
@@ -526,26 +490,20 @@ bool EditAllianceUI::handle_select(const dpp::select_click_t& event,
         bool reprise = (value == "yes");
 
         try {
-            using AllianceQuery  = odb::query<Alliance>;
-            using AllianceResult = odb::result<Alliance>;
-
             odb::transaction t(db->begin());
+            tx_metrics::track(t, "edit.reuse");
 
-            AllianceResult ares(
-                db->query<Alliance>(
-                    AllianceQuery::guild_id == guild_id_u64 &&
-                    AllianceQuery::thread_channel_id == channel_id_u64
-                )
+            std::unique_ptr<Alliance> alliance_ptr(
+                alliance_index::load_alliance(*db, guild_id_u64, channel_id_u64)
             );
 
-            auto ait = ares.begin();
-            if (ait == ares.end()) {
+            if (!alliance_ptr) {
                 t.commit();
                 ack_select(event);
                 return true;
             }
 
-            Alliance alliance = *ait;
+            Alliance alliance = *alliance_ptr;
             alliance.ships_reuse_planned(reprise);
             db->update(alliance);
             std::uint64_t alliance_id = alliance.id();
@@ -585,6 +543,7 @@ bool EditAllianceUI::handle_select(const dpp::select_click_t& event,
 
         try {
             odb::transaction t(db->begin());
+            tx_metrics::track(t, "edit.ship_hull");
 
             std::unique_ptr<Ship> ship(db->load<Ship>(ship_id));
             if (!ship) {
@@ -607,6 +566,7 @@ bool EditAllianceUI::handle_select(const dpp::select_click_t& event,
             if (cluster) {
                 try {
                     odb::transaction t2(db->begin());
+                    tx_metrics::track(t2, "edit.roster_alliance");
                     std::unique_ptr<Alliance> a(
                         db->load<Alliance>(alliance_id)
                     );
@@ -661,7 +621,7 @@ bool EditAllianceUI::handle_select(const dpp::select_click_t& event,
                     .set_text_style(dpp::text_short)
             );
 
-            event.dialog(modal);
+            deferral::dialog(event, modal);
             return true;
         }
 
@@ -683,6 +643,7 @@ bool EditAllianceUI::handle_select(const dpp::select_click_t& event,
 
         try {
             odb::transaction t(db->begin());
+            tx_metrics::track(t, "edit.ship_role");
 
             std::unique_ptr<Ship> ship(db->load<Ship>(ship_id));
             if (!ship) {
@@ -700,6 +661,7 @@ bool EditAllianceUI::handle_select(const dpp::select_click_t& event,
             if (cluster) {
                 try {
                     odb::transaction t2(db->begin());
+                    tx_metrics::track(t2, "edit.roster_alliance");
                     std::unique_ptr<Alliance> a(
                         db->load<Alliance>(alliance_id)
                     );
@@ -747,7 +709,7 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
         if (date_input.empty() && start_input.empty() && sale_input.empty()) {
             dpp::message msg("ℹ️ Aucun champ rempli, l'alliance n'a pas été modifiée.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -758,28 +720,22 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
         bool found = false;
 
         try {
-            using AllianceQuery  = odb::query<Alliance>;
-            using AllianceResult = odb::result<Alliance>;
-
             odb::transaction t(db->begin());
+            tx_metrics::track(t, "edit.schedule_load");
 
-            AllianceResult ares(
-                db->query<Alliance>(
-                    AllianceQuery::guild_id == guild_id_u64 &&
-                    AllianceQuery::thread_channel_id == channel_id_u64
-                )
+            std::unique_ptr<Alliance> alliance_ptr(
+                alliance_index::load_alliance(*db, guild_id_u64, channel_id_u64)
             );
 
-            auto ait = ares.begin();
-            if (ait == ares.end()) {
+            if (!alliance_ptr) {
                 t.commit();
                 dpp::message msg("❌ Ce thread n'est plus associé à une alliance connue.");
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
 
-            alliance = *ait;
+            alliance = *alliance_ptr;
             found = true;
             t.commit();
         }
@@ -788,26 +744,22 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
                       << ex.what() << "\n";
             dpp::message msg("❌ Erreur interne lors du chargement de l'alliance.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
         if (!found) {
             dpp::message msg("❌ Ce thread n'est plus associé à une alliance connue.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
         std::time_t old_scheduled_at = alliance.scheduled_at();
         std::time_t old_sale_at      = alliance.sale_at();
 
-        std::tm tm_base {};
-#ifdef _WIN32
-        localtime_s(&tm_base, &old_scheduled_at);
-#else
-        tm_base = *std::localtime(&old_scheduled_at);
-#endif
+        const TimeZone& zone = bot_settings_cache::zone(*db, guild_id_u64);
+        const std::tm tm_base = zone.to_local(old_scheduled_at);
 
         std::tm tm_start = tm_base;
 
@@ -818,32 +770,20 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
                     "❌ Je n'ai pas compris la date. Essaie par exemple `24/11` ou `24/11/2025`."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
             tm_start = tmp;
         }
 
         if (!start_input.empty()) {
-            std::string start_hhmm;
-            if (!parse_time_to_hhmm(start_input, start_hhmm)) {
+            int h = 0, m = 0;
+            if (!time_parse::parse_hhmm(start_input, h, m)) {
                 dpp::message msg(
                     "❌ Je n'ai pas compris l'heure de début. Essaie par exemple `7h`, `7h30` ou `07:30`."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
-                return true;
-            }
-
-            auto pos = start_hhmm.find(':');
-            int h = 0, m = 0;
-            try {
-                h = std::stoi(start_hhmm.substr(0, pos));
-                m = std::stoi(start_hhmm.substr(pos + 1));
-            } catch (...) {
-                dpp::message msg("❌ Impossible d'interpréter l'heure de début.");
-                msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
 
@@ -852,39 +792,22 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
             tm_start.tm_sec  = 0;
         }
 
-        std::time_t new_scheduled_at = std::mktime(&tm_start);
+        std::time_t new_scheduled_at = zone.from_local(tm_start);
 
-        std::tm tm_sale {};
-#ifdef _WIN32
-        localtime_s(&tm_sale, &old_sale_at);
-#else
-        tm_sale = *std::localtime(&old_sale_at);
-#endif
+        std::tm tm_sale = zone.to_local(old_sale_at);
 
         tm_sale.tm_year = tm_start.tm_year;
         tm_sale.tm_mon  = tm_start.tm_mon;
         tm_sale.tm_mday = tm_start.tm_mday;
 
         if (!sale_input.empty()) {
-            std::string sale_hhmm;
-            if (!parse_time_to_hhmm(sale_input, sale_hhmm)) {
+            int h = 0, m = 0;
+            if (!time_parse::parse_hhmm(sale_input, h, m)) {
                 dpp::message msg(
                     "❌ Je n'ai pas compris l'heure de vente. Essaie par exemple `18h`, `18h00` ou `18:00`."
                 );
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
-                return true;
-            }
-
-            auto pos = sale_hhmm.find(':');
-            int h = 0, m = 0;
-            try {
-                h = std::stoi(sale_hhmm.substr(0, pos));
-                m = std::stoi(sale_hhmm.substr(pos + 1));
-            } catch (...) {
-                dpp::message msg("❌ Impossible d'interpréter l'heure de vente.");
-                msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
 
@@ -893,14 +816,14 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
             tm_sale.tm_sec  = 0;
         }
 
-        std::time_t new_sale_at = std::mktime(&tm_sale);
+        std::time_t new_sale_at = zone.from_local(tm_sale);
 
         if (new_sale_at <= new_scheduled_at) {
             dpp::message msg(
                 "❌ L'heure de vente doit être **après** l'heure de début."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -909,6 +832,7 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
 
         try {
             odb::transaction t2(db->begin());
+            tx_metrics::track(t2, "edit.schedule_save");
             db->update(alliance);
             t2.commit();
         }
@@ -917,7 +841,7 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
                       << ex.what() << "\n";
             dpp::message msg("❌ Erreur DB lors de la mise à jour de la date/heure.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -931,8 +855,8 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
             );
         }
 
-        std::string start_str = alliance_helpers::format_hhmm(new_scheduled_at);
-        std::string sale_str  = alliance_helpers::format_hhmm(new_sale_at);
+        std::string start_str = alliance_helpers::format_hhmm(new_scheduled_at, zone);
+        std::string sale_str  = alliance_helpers::format_hhmm(new_sale_at, zone);
 
         std::ostringstream resp;
         resp << "✅ Date & heures mises à jour :\n"
@@ -941,7 +865,7 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
 
         dpp::message msg(resp.str());
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return true;
     }
 
@@ -956,7 +880,7 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
         } catch (...) {
             dpp::message msg("❌ Impossible d'identifier le bateau à modifier.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -964,19 +888,20 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
         if (role_input.empty()) {
             dpp::message msg("❌ Merci de renseigner un nom de rôle.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
         try {
             odb::transaction t(db->begin());
+            tx_metrics::track(t, "edit.custom_role");
 
             std::unique_ptr<Ship> ship(db->load<Ship>(ship_id));
             if (!ship) {
                 t.commit();
                 dpp::message msg("❌ Ce bateau n'existe plus.");
                 msg.set_flags(dpp::m_ephemeral);
-                event.reply(msg);
+                deferral::reply(event, msg);
                 return true;
             }
 
@@ -990,6 +915,7 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
             if (cluster) {
                 try {
                     odb::transaction t2(db->begin());
+                    tx_metrics::track(t2, "edit.roster_alliance");
                     std::unique_ptr<Alliance> a(
                         db->load<Alliance>(alliance_id)
                     );
@@ -1010,14 +936,14 @@ bool EditAllianceUI::handle_modal(const dpp::form_submit_t& event,
                 "✅ Rôle du navire mis à jour : **" + role_input + "**."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
         }
         catch (const std::exception& ex) {
             std::cerr << "[EditAllianceUI::handle_modal] Erreur DB (custom ship role) : "
                       << ex.what() << "\n";
             dpp::message msg("❌ Erreur DB lors de la mise à jour du rôle.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
         }
 
         return true;
@@ -31,6 +31,11 @@
 #include "alliance_discord_objects-odb.hxx"
 
 #include "bot/AllianceHelpers.hpp"
+#include "bot/AllianceIndex.hpp"
+#include "bot/Deferral.hpp"
+#include "bot/RestScheduler.hpp"
+#include "db/BotSettingsCache.hpp"
+#include "db/TxMetrics.hpp"
 
 void JoinAllianceUI::open(const dpp::slashcommand_t& event,
                           const std::shared_ptr<odb::pgsql::database>& db)
@@ -38,7 +43,7 @@ void JoinAllianceUI::open(const dpp::slashcommand_t& event,
     if (event.command.guild_id == 0) {
         dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
@@ -47,54 +52,34 @@ void JoinAllianceUI::open(const dpp::slashcommand_t& event,
     const std::uint64_t user_id    = static_cast<std::uint64_t>(event.command.usr.id);
 
     try {
-        typedef odb::query<Alliance> AllianceQuery;
-        typedef odb::result<Alliance> AllianceResult;
-
-        typedef odb::query<Ship> ShipQuery;
-        typedef odb::result<Ship> ShipResult;
-
-        typedef odb::query<AllianceParticipant> PartQuery;
-        typedef odb::result<AllianceParticipant> PartResult;
-
-        typedef odb::query<BotSettings> SettingsQuery;
-
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "join.open");
 
-        AllianceResult ares(
-            db->query<Alliance>(
-                AllianceQuery::guild_id == guild_id &&
-                AllianceQuery::thread_channel_id == channel_id
-            )
-        );
-
-        auto ait = ares.begin();
-        if (ait == ares.end()) {
+        alliance_helpers::AllianceRosterData roster;
+        if (!alliance_helpers::fetch_alliance_roster_by_thread(*db, guild_id, channel_id, roster)) {
             dpp::message msg(
                 "❌ Ce thread n'est pas associé à une alliance connue.\n"
                 "La commande `/join` ne peut être utilisée que dans un thread d'alliance créé par le bot."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
-        Alliance alliance = *ait;
-        const std::uint64_t alliance_id = alliance.id();
+        const Alliance& alliance = roster.alliance;
 
         if (alliance.status() == AllianceStatus::finished ||
             alliance.status() == AllianceStatus::cancelled)
         {
             dpp::message msg("❌ Cette alliance est terminée ou annulée, tu ne peux plus la rejoindre.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
         bool allow_public_join = true;
-        try {
-            std::unique_ptr<BotSettings> settings(db->load<BotSettings>(guild_id));
+        if (auto settings = bot_settings_cache::get(*db, guild_id)) {
             allow_public_join = settings->allow_public_join();
-        } catch (const odb::object_not_persistent&) {
         }
 
         if (!allow_public_join) {
@@ -102,7 +87,7 @@ void JoinAllianceUI::open(const dpp::slashcommand_t& event,
                 "❌ Les inscriptions publiques sont désactivées pour ce serveur."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
@@ -121,19 +106,11 @@ void JoinAllianceUI::open(const dpp::slashcommand_t& event,
                 "Raison : " + user->ban_reason()
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
-        ShipQuery q(ShipQuery::alliance_id == alliance_id);
-        q += " ORDER BY " + ShipQuery::slot;
-
-        ShipResult sres(db->query<Ship>(q));
-
-        std::vector<Ship> ships;
-        for (const Ship& s : sres) {
-            ships.push_back(s);
-        }
+        const std::vector<Ship>& ships = roster.ships;
 
         if (ships.empty()) {
             dpp::message msg(
@@ -141,24 +118,18 @@ void JoinAllianceUI::open(const dpp::slashcommand_t& event,
                 "Demande à l'organisateur de recréer l'alliance."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
-        PartResult pres(
-            db->query<AllianceParticipant>(
-                PartQuery::alliance_id == alliance_id &&
-                PartQuery::left_at == 0
-            )
-        );
-
-        std::unordered_map<std::uint64_t, std::vector<AllianceParticipant>> by_ship;
+        const auto& by_ship = roster.by_ship;
         std::uint64_t current_ship_id = 0;
 
-        for (const AllianceParticipant& p : pres) {
-            by_ship[p.ship_id()].push_back(p);
-            if (p.user_id() == user_id && p.left_at() == 0) {
-                current_ship_id = p.ship_id();
+        for (const auto& [sid, parts] : by_ship) {
+            for (const AllianceParticipant& p : parts) {
+                if (p.user_id() == user_id) {
+                    current_ship_id = sid;
+                }
             }
         }
 
@@ -224,18 +195,18 @@ void JoinAllianceUI::open(const dpp::slashcommand_t& event,
                 "Tu es déjà inscrit sur le seul bateau disponible pour cette alliance. "
                 "Il n'y a pas d'autre bateau à rejoindre pour le moment."
             );
-            event.reply(m);
+            deferral::reply(event, m);
             return;
         }
 
         m.add_component(dpp::component().add_component(select));
-        event.reply(m);
+        deferral::reply(event, m);
     }
     catch (const std::exception& ex) {
         std::cerr << "[JoinAllianceUI] Erreur DB dans open : " << ex.what() << "\n";
         dpp::message msg("❌ Erreur interne en ouvrant le sélecteur de bateaux.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
     }
 }
 
@@ -253,7 +224,7 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
     if (event.values.empty()) {
         dpp::message msg("❌ Tu n'as rien sélectionné.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return true;
     }
 
@@ -263,7 +234,7 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
     } catch (...) {
         dpp::message msg("❌ Valeur de sélection invalide.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return true;
     }
 
@@ -272,30 +243,25 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
     const std::uint64_t user_id    = static_cast<std::uint64_t>(event.command.usr.id);
 
     try {
-        typedef odb::query<Alliance> AllianceQuery;
-        typedef odb::result<Alliance> AllianceResult;
-
         typedef odb::query<AllianceParticipant> PartQuery;
         typedef odb::result<AllianceParticipant> PartResult;
 
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "join.perform");
 
-        AllianceResult ares(
-            db->query<Alliance>(
-                AllianceQuery::guild_id == guild_id &&
-                AllianceQuery::thread_channel_id == channel_id
-            )
+        std::unique_ptr<Alliance> alliance_ptr(
+            alliance_index::load_alliance(*db, guild_id, channel_id)
         );
-        auto ait = ares.begin();
-        if (ait == ares.end()) {
+
+        if (!alliance_ptr) {
             dpp::message msg(
                 "❌ Ce thread n'est pas associé à une alliance connue."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
-        Alliance alliance = *ait;
+        Alliance alliance = *alliance_ptr;
         const std::uint64_t alliance_id = alliance.id();
 
         AllianceStatus alliance_status = alliance.status();
@@ -307,7 +273,7 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
         } catch (const odb::object_not_persistent&) {
             dpp::message msg("❌ Ce bateau n'existe pas ou plus.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -325,7 +291,7 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
         if (ship->alliance_id() != alliance_id) {
             dpp::message msg("❌ Ce bateau n'appartient pas à cette alliance.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -344,7 +310,7 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
                 "Raison : " + user->ban_reason()
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -372,7 +338,7 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
         if (old_ship_id == ship_id) {
             dpp::message msg("Tu es déjà inscrit sur ce bateau.");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return true;
         }
 
@@ -413,6 +379,7 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
                     using ObjResult = odb::result<AllianceDiscordObject>;
 
                     odb::transaction t2(db->begin());
+                    tx_metrics::track(t2, "join.roles");
 
                     ObjResult ores(
                         db->query<AllianceDiscordObject>(
@@ -440,10 +407,12 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
                         if (role_id == 0)
                             return;
 
-                        cluster->guild_member_add_role(
+                        rest_scheduler::member_add_role(
+                            cluster,
                             static_cast<dpp::snowflake>(guild_id),
                             static_cast<dpp::snowflake>(user_id),
                             static_cast<dpp::snowflake>(role_id),
+                            rest_scheduler::Priority::interactive,
                             [](const dpp::confirmation_callback_t& cb) {
                                 if (cb.is_error()) {
                                     std::cerr << "[JoinAllianceUI] Erreur ajout rôle : "
@@ -490,7 +459,7 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
         dpp::message msg;
         msg.set_content(oss.str());
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
 
         return true;
     }
@@ -499,7 +468,7 @@ bool JoinAllianceUI::handle_select(const dpp::select_click_t& event,
                   << ex.what() << "\n";
         dpp::message msg("❌ Erreur interne lors de l'inscription à l'alliance.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return true;
     }
 }
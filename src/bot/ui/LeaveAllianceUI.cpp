@@ -28,6 +28,10 @@
 #include "alliance_discord_objects-odb.hxx"
 
 #include "bot/AllianceHelpers.hpp"
+#include "bot/AllianceIndex.hpp"
+#include "bot/Deferral.hpp"
+#include "bot/RestScheduler.hpp"
+#include "db/TxMetrics.hpp"
 
 namespace {
 
@@ -40,7 +44,7 @@ static void perform_leave_alliance(
     if (event.command.guild_id == 0) {
         dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
@@ -50,34 +54,29 @@ static void perform_leave_alliance(
     const std::uint64_t user_id    = static_cast<std::uint64_t>(event.command.usr.id);
 
     try {
-        using AllianceQuery  = odb::query<Alliance>;
-        using AllianceResult = odb::result<Alliance>;
         using ShipQuery      = odb::query<Ship>;
         using PartQuery      = odb::query<AllianceParticipant>;
         using PartResult     = odb::result<AllianceParticipant>;
 
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "leave.perform");
 
-        AllianceResult ares(
-            db->query<Alliance>(
-                AllianceQuery::guild_id == guild_id &&
-                AllianceQuery::thread_channel_id == channel_id
-            )
+        std::unique_ptr<Alliance> alliance_ptr(
+            alliance_index::load_alliance(*db, guild_id, channel_id)
         );
 
-        auto ait = ares.begin();
-        if (ait == ares.end()) {
+        if (!alliance_ptr) {
             t.commit();
             dpp::message msg(
                 "❌ Ce thread n'est pas associé à une alliance connue.\n"
                 "La commande `/leave` ne peut être utilisée que dans un thread d'alliance créé par le bot."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
-        Alliance alliance = *ait;
+        Alliance alliance = *alliance_ptr;
         const std::uint64_t alliance_id = alliance.id();
         AllianceStatus alliance_status  = alliance.status();
         std::string alliance_name       = alliance.name();
@@ -90,7 +89,7 @@ static void perform_leave_alliance(
                 "❌ Cette alliance est terminée ou annulée, tu ne peux plus la quitter."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
@@ -110,7 +109,7 @@ static void perform_leave_alliance(
                 "Raison : " + user->ban_reason()
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
@@ -133,7 +132,7 @@ static void perform_leave_alliance(
                 "❌ Tu n'es pas inscrit sur cette alliance."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
@@ -196,6 +195,7 @@ static void perform_leave_alliance(
                 using ObjResult = odb::result<AllianceDiscordObject>;
 
                 odb::transaction t2(db->begin());
+                tx_metrics::track(t2, "leave.roles");
 
                 ObjResult ores(
                     db->query<AllianceDiscordObject>(
@@ -227,10 +227,12 @@ static void perform_leave_alliance(
                     if (role_id == 0)
                         return;
 
-                    cluster->guild_member_remove_role(
+                    rest_scheduler::member_remove_role(
+                        cluster,
                         static_cast<dpp::snowflake>(guild_id),
                         static_cast<dpp::snowflake>(user_id),
                         static_cast<dpp::snowflake>(role_id),
+                        rest_scheduler::Priority::interactive,
                         [](const dpp::confirmation_callback_t& cb) {
                             if (cb.is_error()) {
                                 std::cerr << "[LeaveAllianceUI] Erreur retrait rôle : "
@@ -269,13 +271,13 @@ static void perform_leave_alliance(
         dpp::message msg;
         msg.set_flags(dpp::m_ephemeral);
         msg.set_content(oss.str());
-        event.reply(msg);
+        deferral::reply(event, msg);
     }
     catch (const std::exception& ex) {
         std::cerr << "[LeaveAllianceUI] Erreur DB : " << ex.what() << "\n";
         dpp::message msg("❌ Erreur interne lors de la sortie de l'alliance.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 }
@@ -288,7 +290,7 @@ void LeaveAllianceUI::open(const dpp::slashcommand_t& event,
     if (event.command.guild_id == 0) {
         dpp::message msg("❌ Cette commande doit être utilisée dans un serveur, pas en DM.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return;
     }
 
@@ -298,31 +300,25 @@ void LeaveAllianceUI::open(const dpp::slashcommand_t& event,
     (void)user_id;
 
     try {
-        using AllianceQuery  = odb::query<Alliance>;
-        using AllianceResult = odb::result<Alliance>;
-
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "leave.open");
 
-        AllianceResult ares(
-            db->query<Alliance>(
-                AllianceQuery::guild_id == guild_id &&
-                AllianceQuery::thread_channel_id == channel_id
-            )
+        std::unique_ptr<Alliance> alliance_ptr(
+            alliance_index::load_alliance(*db, guild_id, channel_id)
         );
 
-        auto ait = ares.begin();
-        if (ait == ares.end()) {
+        if (!alliance_ptr) {
             t.commit();
             dpp::message msg(
                 "❌ Ce thread n'est pas associé à une alliance connue.\n"
                 "La commande `/leave` ne peut être utilisée que dans un thread d'alliance créé par le bot."
             );
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
             return;
         }
 
-        Alliance alliance = *ait;
+        Alliance alliance = *alliance_ptr;
 
         t.commit();
 
@@ -352,13 +348,13 @@ void LeaveAllianceUI::open(const dpp::slashcommand_t& event,
         );
 
         msg.add_component(row);
-        event.reply(msg);
+        deferral::reply(event, msg);
     }
     catch (const std::exception& ex) {
         std::cerr << "[LeaveAllianceUI::open] Erreur DB : " << ex.what() << "\n";
         dpp::message msg("❌ Erreur interne lors de la préparation de la sortie d'alliance.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
     }
 }
 
@@ -373,7 +369,7 @@ bool LeaveAllianceUI::handle_button(const dpp::button_click_t& event,
     if (id == "leave_alliance_cancel") {
         dpp::message msg("❌ Action annulée, tu restes inscrit sur cette alliance.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return true;
     }
 
@@ -9,10 +9,15 @@
 #include "model/bot_settings.hxx"
 #include "bot_settings-odb.hxx"
 
+#include "bot/Deferral.hpp"
+#include "db/BotSettingsCache.hpp"
+#include "db/TxMetrics.hpp"
+#include "util/TimeZone.hpp"
+
 namespace {
     static void ack_select(const dpp::select_click_t& event)
     {
-        event.reply();
+        deferral::ack(event);
     }
 }
 
@@ -73,7 +78,7 @@ bool SetupUI::handle_button(const dpp::button_click_t& event,
             )
         );
 
-        event.reply(m);
+        deferral::reply(event, m);
         return true;
     }
     else if (id == "setup_roles") {
@@ -102,7 +107,7 @@ bool SetupUI::handle_button(const dpp::button_click_t& event,
             )
         );
 
-        event.reply(m);
+        deferral::reply(event, m);
         return true;
     }
     else if (id == "setup_advanced") {
@@ -132,7 +137,7 @@ bool SetupUI::handle_button(const dpp::button_click_t& event,
                 .set_text_style(dpp::text_short)
         );
 
-        event.dialog(modal);
+        deferral::dialog(event, modal);
         return true;
     }
 
@@ -164,7 +169,7 @@ bool SetupUI::handle_select(const dpp::select_click_t& event,
     if (event.values.empty()) {
         dpp::message msg("❌ Tu n'as rien sélectionné.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return true;
     }
 
@@ -174,7 +179,7 @@ bool SetupUI::handle_select(const dpp::select_click_t& event,
     } catch (...) {
         dpp::message msg("❌ Valeur de sélection invalide.");
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
         return true;
     }
 
@@ -182,6 +187,7 @@ bool SetupUI::handle_select(const dpp::select_click_t& event,
 
     try {
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "setup.select");
 
         std::unique_ptr<BotSettings> settings;
         try {
@@ -208,6 +214,8 @@ bool SetupUI::handle_select(const dpp::select_click_t& event,
         db->update(*settings);
         t.commit();
 
+        bot_settings_cache::put(*settings);
+
         const bool all_channels_set =
             settings->command_channel_id() != 0 &&
             settings->ping_channel_id() != 0 &&
@@ -221,7 +229,7 @@ bool SetupUI::handle_select(const dpp::select_click_t& event,
         if (all_channels_set && all_roles_set) {
             dpp::message msg("✅ Configuration complète pour ce serveur !");
             msg.set_flags(dpp::m_ephemeral);
-            event.reply(msg);
+            deferral::reply(event, msg);
         } else {
             ack_select(event);
         }
@@ -230,7 +238,7 @@ bool SetupUI::handle_select(const dpp::select_click_t& event,
         std::cerr << "[SetupUI] Erreur DB dans handle_select : " << ex.what() << "\n";
         dpp::message msg(std::string("❌ Erreur DB : ") + ex.what());
         msg.set_flags(dpp::m_ephemeral);
-        event.reply(msg);
+        deferral::reply(event, msg);
     }
 
     return true;
@@ -253,8 +261,18 @@ bool SetupUI::handle_modal(const dpp::form_submit_t& event,
     if (max_ships_int < 1) max_ships_int = 1;
     if (max_ships_int > 20) max_ships_int = 20;
 
+    if (!timezone_str.empty() && !time_zone::locate(timezone_str)) {
+        reply_ephemeral(
+            event,
+            "❌ Fuseau horaire inconnu : `" + timezone_str + "`.\n"
+            "Utilise un nom IANA, par exemple `Europe/Paris` ou `America/Montreal`."
+        );
+        return true;
+    }
+
     try {
         odb::transaction t(db->begin());
+        tx_metrics::track(t, "setup.modal");
 
         std::unique_ptr<BotSettings> settings;
         try {
@@ -271,6 +289,8 @@ bool SetupUI::handle_modal(const dpp::form_submit_t& event,
         db->update(*settings);
         t.commit();
 
+        bot_settings_cache::put(*settings);
+
         reply_ephemeral(event, "✅ Options avancées mises à jour !");
     }
     catch (const std::exception& ex) {
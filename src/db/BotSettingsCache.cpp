@@ -0,0 +1,137 @@
+#include "db/BotSettingsCache.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <odb/pgsql/database.hxx>
+#include <odb/transaction.hxx>
+
+#include "model/bot_settings.hxx"
+#include "bot_settings-odb.hxx"
+
+#include "db/TxMetrics.hpp"
+#include "util/TimeZone.hpp"
+
+namespace bot_settings_cache {
+
+namespace {
+
+std::shared_mutex g_mutex;
+std::unordered_map<std::uint64_t, std::shared_ptr<const BotSettings>> g_entries;
+
+std::atomic<std::uint64_t> g_hits {0};
+std::atomic<std::uint64_t> g_misses {0};
+
+// Incrémenté à chaque écriture : un fuseau résolu pendant un put() n'est pas mémorisé.
+std::atomic<std::uint64_t> g_writes {0};
+
+std::shared_ptr<const BotSettings> load_from_db(odb::pgsql::database& db, std::uint64_t guild_id) {
+    std::shared_ptr<const BotSettings> result;
+
+    auto load = [&]() {
+        std::unique_ptr<BotSettings> s(db.find<BotSettings>(guild_id));
+        if (s)
+            result = std::shared_ptr<const BotSettings>(std::move(s));
+    };
+
+    if (odb::transaction::has_current()) {
+        load();
+    } else {
+        odb::transaction t(db.begin());
+        tx_metrics::track(t, "bot_settings.load");
+        load();
+        t.commit();
+    }
+
+    return result;
+}
+
+} // namespace
+
+std::shared_ptr<const BotSettings> get(odb::pgsql::database& db, std::uint64_t guild_id) {
+    {
+        std::shared_lock<std::shared_mutex> lock(g_mutex);
+        auto it = g_entries.find(guild_id);
+        if (it != g_entries.end()) {
+            g_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    g_misses.fetch_add(1, std::memory_order_relaxed);
+
+    auto loaded = load_from_db(db, guild_id);
+
+    // Une écriture concurrente (put) a priorité sur ce qu'on vient de lire.
+    std::unique_lock<std::shared_mutex> lock(g_mutex);
+    return g_entries.emplace(guild_id, std::move(loaded)).first->second;
+}
+
+const TimeZone& zone(odb::pgsql::database& db, std::uint64_t guild_id) {
+    if (const TimeZone* z = time_zone::for_guild(guild_id))
+        return *z;
+
+    const std::uint64_t writes = g_writes.load(std::memory_order_acquire);
+
+    std::shared_ptr<const BotSettings> settings;
+    try {
+        settings = get(db, guild_id);
+    } catch (const std::exception& ex) {
+        // Fuseau par défaut pour cette fois ; on réessaiera au prochain appel.
+        std::cerr << "[BotSettingsCache] Erreur DB (fuseau du serveur " << guild_id << ") : "
+                  << ex.what() << "\n";
+        return time_zone::default_zone();
+    }
+
+    const TimeZone* z = nullptr;
+    if (settings) {
+        z = time_zone::locate(settings->timezone());
+        if (!z) {
+            std::cerr << "[BotSettingsCache] Fuseau '" << settings->timezone()
+                      << "' inconnu pour le serveur " << guild_id
+                      << ", utilisation de " << time_zone::default_zone().name() << ".\n";
+        }
+    }
+    if (!z)
+        z = &time_zone::default_zone();
+
+    time_zone::remember_guild(guild_id, z);
+    if (g_writes.load(std::memory_order_acquire) != writes)
+        time_zone::forget_guild(guild_id);
+    return *z;
+}
+
+void put(const BotSettings& settings) {
+    auto copy = std::make_shared<const BotSettings>(settings);
+
+    {
+        std::unique_lock<std::shared_mutex> lock(g_mutex);
+        g_entries[settings.guild_id()] = std::move(copy);
+    }
+    g_writes.fetch_add(1, std::memory_order_acq_rel);
+    time_zone::forget_guild(settings.guild_id());
+}
+
+void invalidate(std::uint64_t guild_id) {
+    {
+        std::unique_lock<std::shared_mutex> lock(g_mutex);
+        g_entries.erase(guild_id);
+    }
+    g_writes.fetch_add(1, std::memory_order_acq_rel);
+    time_zone::forget_guild(guild_id);
+}
+
+Stats stats() {
+    Stats s;
+    s.hits   = g_hits.load(std::memory_order_relaxed);
+    s.misses = g_misses.load(std::memory_order_relaxed);
+
+    std::shared_lock<std::shared_mutex> lock(g_mutex);
+    s.entries = g_entries.size();
+    return s;
+}
+
+} // namespace bot_settings_cache
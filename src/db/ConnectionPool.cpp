@@ -0,0 +1,273 @@
+#include "db/ConnectionPool.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <libpq-fe.h>
+
+#include <odb/details/lock.hxx>
+#include <odb/pgsql/connection.hxx>
+#include <odb/pgsql/database.hxx>
+
+namespace {
+
+std::uint64_t elapsed_us(std::chrono::steady_clock::time_point since) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - since
+        ).count()
+    );
+}
+
+void update_max(std::atomic<std::uint64_t>& target, std::uint64_t value) {
+    std::uint64_t cur = target.load(std::memory_order_relaxed);
+    while (value > cur &&
+           !target.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+    }
+}
+
+// Contrôle à l'emprunt, sans aller-retour : PQconsumeInput lit ce que le
+// serveur a déjà envoyé sans bloquer, ce qui fait passer PQstatus à
+// CONNECTION_BAD si le serveur a fermé la socket (redémarrage, timeout
+// d'inactivité). Une connexion coupée sans fermeture (réseau perdu) n'est
+// pas détectée ici : seul le reaper, avec son SELECT 1, la repère.
+bool connection_alive(PGconn* conn) {
+    if (PQstatus(conn) != CONNECTION_OK)
+        return false;
+    PQconsumeInput(conn);
+    return PQstatus(conn) == CONNECTION_OK;
+}
+
+} // namespace
+
+ConnectionPool::ConnectionPool(std::size_t min_connections,
+                               std::size_t max_connections,
+                               std::chrono::seconds idle_timeout,
+                               bool validate)
+    : odb::pgsql::connection_pool_factory(max_connections, 0),
+      min_connections_(min_connections),
+      idle_timeout_(idle_timeout),
+      validate_(validate)
+{}
+
+ConnectionPool::~ConnectionPool() {
+    {
+        std::lock_guard<std::mutex> lock(reaper_mutex_);
+        stopping_ = true;
+    }
+    reaper_cv_.notify_all();
+
+    if (reaper_.joinable()) {
+        reaper_.join();
+    }
+}
+
+void ConnectionPool::database(database_type& db) {
+    odb::pgsql::connection_pool_factory::database(db);
+
+    warm_up();
+
+    if (idle_timeout_.count() > 0) {
+        reaper_ = std::thread([this]() { reaper_loop(); });
+    }
+}
+
+odb::pgsql::connection_pool_factory::pooled_connection_ptr ConnectionPool::create() {
+    pooled_connection_ptr c(odb::pgsql::connection_pool_factory::create());
+    created_.fetch_add(1, std::memory_order_relaxed);
+    return c;
+}
+
+odb::pgsql::connection_ptr ConnectionPool::connect() {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Le pool est saturé : connect() va bloquer jusqu'à ce qu'une connexion soit rendue.
+    bool will_wait = false;
+    {
+        odb::details::lock l(mutex_);
+        will_wait = connections_.empty() && max_ != 0 && in_use_ >= max_;
+    }
+
+    odb::pgsql::connection_ptr c;
+
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        c = odb::pgsql::connection_pool_factory::connect();
+
+        if (!validate_ || connection_alive(c->handle())) {
+            break;
+        }
+
+        // Connexion cassée : ODB la détruira au lieu de la remettre dans le pool.
+        validation_failures_.fetch_add(1, std::memory_order_relaxed);
+        c->mark_failed();
+        c.reset();
+    }
+
+    if (!c) {
+        c = odb::pgsql::connection_pool_factory::connect();
+    }
+
+    {
+        odb::details::lock l(mutex_);
+        idle_low_water_ = std::min(idle_low_water_, connections_.size());
+    }
+
+    const std::uint64_t us = elapsed_us(start);
+    acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    total_acquire_us_.fetch_add(us, std::memory_order_relaxed);
+    update_max(max_acquire_us_, us);
+
+    if (will_wait) {
+        waits_.fetch_add(1, std::memory_order_relaxed);
+        total_wait_us_.fetch_add(us, std::memory_order_relaxed);
+    }
+
+    return c;
+}
+
+DbPoolStats ConnectionPool::stats() {
+    DbPoolStats s;
+
+    {
+        odb::details::lock l(mutex_);
+        s.in_use  = in_use_;
+        s.idle    = connections_.size();
+        s.waiting = waiters_;
+    }
+
+    s.acquisitions        = acquisitions_.load(std::memory_order_relaxed);
+    s.waits               = waits_.load(std::memory_order_relaxed);
+    s.total_wait_us       = total_wait_us_.load(std::memory_order_relaxed);
+    s.total_acquire_us    = total_acquire_us_.load(std::memory_order_relaxed);
+    s.max_acquire_us      = max_acquire_us_.load(std::memory_order_relaxed);
+    s.created             = created_.load(std::memory_order_relaxed);
+    s.reaped              = reaped_.load(std::memory_order_relaxed);
+    s.validation_failures = validation_failures_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void ConnectionPool::warm_up() {
+    if (min_connections_ == 0)
+        return;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    try {
+        // On emprunte min connexions en même temps pour forcer leur création,
+        // puis on les rend : avec min = 0 côté ODB, elles restent dans le pool.
+        std::vector<odb::pgsql::connection_ptr> warm;
+        warm.reserve(min_connections_);
+        for (std::size_t i = 0; i < min_connections_; ++i) {
+            warm.push_back(odb::pgsql::connection_pool_factory::connect());
+        }
+        warm.clear();
+
+        std::cout << "[DB] Pool : " << min_connections_ << " connexion(s) préchauffée(s) en "
+                  << elapsed_us(start) / 1000 << " ms\n";
+    } catch (const std::exception& ex) {
+        std::cerr << "[DB] Pool : échec du préchauffage : " << ex.what() << "\n";
+    }
+
+    odb::details::lock l(mutex_);
+    idle_low_water_ = connections_.size();
+}
+
+void ConnectionPool::reaper_loop() {
+    std::unique_lock<std::mutex> lock(reaper_mutex_);
+
+    while (!stopping_) {
+        if (reaper_cv_.wait_for(lock, idle_timeout_, [this] { return stopping_; })) {
+            break;
+        }
+
+        lock.unlock();
+        try {
+            reap_idle();
+        } catch (const std::exception& ex) {
+            std::cerr << "[DB] Pool : erreur du reaper : " << ex.what() << "\n";
+        }
+        lock.lock();
+    }
+}
+
+void ConnectionPool::reap_idle() {
+    std::vector<pooled_connection_ptr> to_close;
+    std::size_t to_check = 0;
+
+    {
+        odb::details::lock l(mutex_);
+
+        const std::size_t total = connections_.size() + in_use_;
+        std::size_t excess = 0;
+        if (total > min_connections_) {
+            excess = std::min(idle_low_water_, total - min_connections_);
+        }
+        excess = std::min(excess, connections_.size());
+
+        // Les plus anciennes connexions rendues sont en tête du vecteur.
+        to_close.assign(connections_.begin(), connections_.begin() + excess);
+        connections_.erase(connections_.begin(), connections_.begin() + excess);
+
+        if (validate_) {
+            to_check = connections_.size();
+        }
+    }
+
+    // Validation des connexions inactives une par une, hors verrou : un
+    // aller-retour léger détecte les connexions coupées côté serveur. La
+    // connexion vérifiée compte comme empruntée (in_use_), pour que connect()
+    // ne crée pas de connexion en plus pendant ce temps et que le pool ne
+    // dépasse jamais DB_POOL_MAX.
+    for (std::size_t i = 0; i < to_check; ++i) {
+        pooled_connection_ptr c;
+        {
+            odb::details::lock l(mutex_);
+            if (connections_.empty())
+                break;
+            c = connections_.front();
+            connections_.erase(connections_.begin());
+            ++in_use_;
+        }
+
+        bool ok = false;
+        try {
+            ok = PQstatus(c->handle()) == CONNECTION_OK;
+            if (ok) {
+                c->execute("SELECT 1");
+            }
+        } catch (const std::exception&) {
+            ok = false;
+        }
+
+        {
+            odb::details::lock l(mutex_);
+            --in_use_;
+            if (ok) {
+                connections_.push_back(c);
+            }
+            if (waiters_ != 0) {
+                cond_.signal();
+            }
+        }
+
+        if (!ok) {
+            validation_failures_.fetch_add(1, std::memory_order_relaxed);
+            to_close.push_back(c);
+        }
+    }
+
+    {
+        odb::details::lock l(mutex_);
+        idle_low_water_ = connections_.size();
+    }
+
+    if (!to_close.empty()) {
+        reaped_.fetch_add(to_close.size(), std::memory_order_relaxed);
+        std::cout << "[DB] Pool : " << to_close.size()
+                  << " connexion(s) inactive(s) fermée(s)\n";
+    }
+
+    // Les connexions retirées du pool (pool_ == 0) sont détruites ici.
+    to_close.clear();
+}
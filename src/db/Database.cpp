@@ -1,9 +1,29 @@
 #include "db/Database.hpp"
+#include "db/DbTrace.hpp"
+#include "util/Trace.hpp"
 #include "util/env.hpp"
 
+#include <atomic>
 #include <iostream>
 #include <odb/pgsql/database.hxx>
 
+namespace {
+
+std::atomic<ConnectionPool*> g_pool {nullptr};
+
+std::size_t parse_size_env(const char* name, std::size_t fallback) {
+    try {
+        return static_cast<std::size_t>(
+            std::stoul(getenv_or(name, std::to_string(fallback)))
+        );
+    } catch (...) {
+        std::cerr << "Warning : " << name << " invalide, utilisation de " << fallback << ".\n";
+        return fallback;
+    }
+}
+
+} // namespace
+
 DbConfig load_db_config_from_env() {
     DbConfig cfg;
     cfg.host = getenv_or("DB_HOST", "db");
@@ -20,15 +40,61 @@ DbConfig load_db_config_from_env() {
         cfg.port = 5432;
     }
 
+    cfg.pool_min = parse_size_env("DB_POOL_MIN", 2);
+    cfg.pool_max = parse_size_env("DB_POOL_MAX", 10);
+    cfg.pool_idle_timeout = static_cast<std::uint32_t>(parse_size_env("DB_POOL_IDLE_TIMEOUT", 300));
+    cfg.pool_validate = getenv_or("DB_POOL_VALIDATE", "1") != "0";
+    cfg.workers = parse_size_env("DB_WORKERS", 4);
+
+    if (cfg.pool_max == 0) {
+        std::cerr << "Warning : DB_POOL_MAX doit être > 0, utilisation de 10.\n";
+        cfg.pool_max = 10;
+    }
+    if (cfg.pool_min > cfg.pool_max) {
+        std::cerr << "Warning : DB_POOL_MIN > DB_POOL_MAX, DB_POOL_MIN ramené à " << cfg.pool_max << ".\n";
+        cfg.pool_min = cfg.pool_max;
+    }
+    if (cfg.workers > cfg.pool_max) {
+        // Les workers en trop attendraient une connexion libre.
+        std::cerr << "Warning : DB_WORKERS > DB_POOL_MAX, DB_WORKERS ramené à " << cfg.pool_max << ".\n";
+        cfg.workers = cfg.pool_max;
+    }
+
     return cfg;
 }
 
 std::shared_ptr<odb::pgsql::database> make_database(const DbConfig& cfg) {
-    return std::make_shared<odb::pgsql::database>(
+    auto* pool = new ConnectionPool(
+        cfg.pool_min,
+        cfg.pool_max,
+        std::chrono::seconds(cfg.pool_idle_timeout),
+        cfg.pool_validate
+    );
+    g_pool.store(pool);
+
+    std::cout << "[DB] Pool : min=" << cfg.pool_min
+              << " max=" << cfg.pool_max
+              << " idle_timeout=" << cfg.pool_idle_timeout << "s"
+              << " validation=" << (cfg.pool_validate ? "on" : "off") << "\n";
+
+    // La base prend possession du pool.
+    auto db = std::make_shared<odb::pgsql::database>(
         cfg.user,
         cfg.password,
         cfg.name,
         cfg.host,
-        cfg.port
+        cfg.port,
+        "",
+        std::unique_ptr<odb::pgsql::connection_factory>(pool)
     );
+
+    if (trace::enabled())
+        db->tracer(db_trace::tracer());
+
+    return db;
+}
+
+DbPoolStats db_pool_stats() {
+    ConnectionPool* pool = g_pool.load();
+    return pool ? pool->stats() : DbPoolStats{};
 }
@@ -0,0 +1,174 @@
+#include "db/DbExecutor.hpp"
+#include "util/Trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace db_executor {
+
+namespace {
+
+// Au-delà, un job a attendu assez longtemps pour risquer l'expiration de l'interaction (3 s).
+constexpr std::uint64_t SLOW_WAIT_US = 1'000'000;
+
+struct Job {
+    std::function<void()> fn;
+    std::chrono::steady_clock::time_point enqueued_at;
+    trace::Context trace; // contexte du thread qui a posté le job
+};
+
+std::mutex g_mutex;
+std::condition_variable g_cv;
+std::deque<Job> g_queue;
+std::vector<std::thread> g_workers;
+std::size_t g_running = 0;
+bool g_stopping = false;
+
+std::atomic<std::uint64_t> g_submitted {0};
+std::atomic<std::uint64_t> g_completed {0};
+std::atomic<std::uint64_t> g_failed {0};
+std::atomic<std::uint64_t> g_total_wait_us {0};
+std::atomic<std::uint64_t> g_max_wait_us {0};
+std::atomic<std::uint64_t> g_total_run_us {0};
+std::atomic<std::uint64_t> g_max_run_us {0};
+
+std::uint64_t elapsed_us(std::chrono::steady_clock::time_point since) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - since
+        ).count()
+    );
+}
+
+void update_max(std::atomic<std::uint64_t>& target, std::uint64_t value) {
+    std::uint64_t cur = target.load(std::memory_order_relaxed);
+    while (value > cur &&
+           !target.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+    }
+}
+
+void execute(Job& job) {
+    const auto start = std::chrono::steady_clock::now();
+    const trace::Scope scope(job.trace);
+
+    try {
+        job.fn();
+    } catch (const std::exception& ex) {
+        g_failed.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "[DB] Exécuteur : exception dans un job : " << ex.what() << "\n";
+    } catch (...) {
+        g_failed.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "[DB] Exécuteur : exception inconnue dans un job\n";
+    }
+
+    const std::uint64_t us = elapsed_us(start);
+    g_total_run_us.fetch_add(us, std::memory_order_relaxed);
+    update_max(g_max_run_us, us);
+    g_completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void worker_loop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(g_mutex);
+            g_cv.wait(lock, [] { return g_stopping || !g_queue.empty(); });
+
+            if (g_queue.empty())
+                return; // arrêt demandé et file vidée
+
+            job = std::move(g_queue.front());
+            g_queue.pop_front();
+            g_running++;
+        }
+
+        const std::uint64_t waited = elapsed_us(job.enqueued_at);
+        g_total_wait_us.fetch_add(waited, std::memory_order_relaxed);
+        update_max(g_max_wait_us, waited);
+
+        if (waited >= SLOW_WAIT_US) {
+            std::cerr << "[DB] Exécuteur : job resté " << waited / 1000
+                      << " ms en file (workers saturés ?)\n";
+        }
+
+        execute(job);
+
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_running--;
+    }
+}
+
+} // namespace
+
+void start(std::size_t workers) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_workers.empty())
+        return;
+
+    g_stopping = false;
+    g_workers.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        g_workers.emplace_back(worker_loop);
+    }
+
+    std::cout << "[DB] Exécuteur : " << workers << " worker(s)\n";
+}
+
+void stop() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_stopping = true;
+        workers.swap(g_workers);
+    }
+    g_cv.notify_all();
+
+    for (std::thread& w : workers) {
+        if (w.joinable())
+            w.join();
+    }
+}
+
+void post(std::function<void()> job) {
+    g_submitted.fetch_add(1, std::memory_order_relaxed);
+
+    Job j{std::move(job), std::chrono::steady_clock::now(), trace::current()};
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (!g_workers.empty() && !g_stopping) {
+            g_queue.push_back(std::move(j));
+            g_cv.notify_one();
+            return;
+        }
+    }
+
+    // Exécuteur non démarré (ou arrêté) : exécution sur le thread appelant.
+    execute(j);
+}
+
+Stats stats() {
+    Stats s;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        s.workers = g_workers.size();
+        s.queued  = g_queue.size();
+        s.running = g_running;
+    }
+
+    s.submitted     = g_submitted.load(std::memory_order_relaxed);
+    s.completed     = g_completed.load(std::memory_order_relaxed);
+    s.failed        = g_failed.load(std::memory_order_relaxed);
+    s.total_wait_us = g_total_wait_us.load(std::memory_order_relaxed);
+    s.max_wait_us   = g_max_wait_us.load(std::memory_order_relaxed);
+    s.total_run_us  = g_total_run_us.load(std::memory_order_relaxed);
+    s.max_run_us    = g_max_run_us.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace db_executor
@@ -0,0 +1,75 @@
+#include "db/DbTrace.hpp"
+#include "util/Trace.hpp"
+
+#include <cstring>
+#include <string>
+
+#include <odb/tracer.hxx>
+
+namespace db_trace {
+
+namespace {
+
+constexpr std::size_t STATEMENT_MAX = 1024;
+
+// ODB garde une transaction par thread : l'état de trace suit la même règle.
+struct ThreadState {
+    trace::Span transaction;
+    // La fin d'une requête n'est pas notifiée : son span court jusqu'à l'appel suivant.
+    trace::Span statement;
+};
+
+thread_local ThreadState t_state;
+
+bool starts_with(const char* s, const char* prefix) {
+    return std::strncmp(s, prefix, std::strlen(prefix)) == 0;
+}
+
+class Tracer final : public odb::tracer {
+public:
+    // ODB passe aussi BEGIN / COMMIT / ROLLBACK par ici, sous forme de texte ;
+    // la surcharge sur odb::statement y renvoie avec s.text().
+    void execute(odb::connection&, const char* text) override {
+        ThreadState& st = t_state;
+
+        if (starts_with(text, "BEGIN")) {
+            st.statement.end();
+            st.transaction = trace::Span("db.transaction", trace::Span::Kind::client);
+            st.transaction.attr("db.system", "postgresql");
+            return;
+        }
+
+        if (!st.transaction.active())
+            return;
+
+        st.statement.end();
+
+        const bool commit = starts_with(text, "COMMIT");
+        if (commit || starts_with(text, "ROLLBACK")) {
+            st.transaction.attr("db.outcome", commit ? "commit" : "rollback");
+            st.transaction.end();
+            return;
+        }
+
+        st.statement = trace::Span("db.statement", trace::Span::Kind::client, st.transaction.context());
+        st.statement.attr("db.system", "postgresql");
+        st.statement.attr("db.statement", std::string_view(text).substr(0, STATEMENT_MAX));
+    }
+};
+
+} // namespace
+
+odb::tracer& tracer() {
+    static Tracer instance;
+    return instance;
+}
+
+void label(std::string_view type) {
+    trace::Span& tx = t_state.transaction;
+    if (!tx.active())
+        return;
+    tx.name("db " + std::string(type));
+    tx.attr("db.transaction.type", type);
+}
+
+} // namespace db_trace
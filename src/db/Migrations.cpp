@@ -0,0 +1,206 @@
+#include "db/Migrations.hpp"
+
+#include <chrono>
+#include <iostream>
+
+#include <odb/transaction.hxx>
+#include <odb/pgsql/database.hxx>
+
+namespace {
+
+// Clé arbitraire pour pg_advisory_xact_lock : sérialise deux instances qui démarrent en même temps.
+constexpr long long MIGRATION_LOCK_KEY = 0x534F54414C4CLL;
+
+std::string quote_literal(const std::string& s) {
+    std::string out;
+    out.reserve(s.size() + 2);
+    out.push_back('\'');
+    for (char c : s) {
+        if (c == '\'')
+            out.push_back('\'');
+        out.push_back(c);
+    }
+    out.push_back('\'');
+    return out;
+}
+
+void ensure_migrations_table(odb::pgsql::database& db) {
+    db.execute(
+        "CREATE TABLE IF NOT EXISTS bot_schema_migrations ("
+        " version INTEGER PRIMARY KEY,"
+        " description TEXT NOT NULL,"
+        " applied_at BIGINT NOT NULL)"
+    );
+}
+
+bool is_applied(odb::pgsql::database& db, int version) {
+    return db.execute(
+        "SELECT 1 FROM bot_schema_migrations WHERE version = " + std::to_string(version)
+    ) > 0;
+}
+
+} // namespace
+
+const std::vector<Migration>& all_migrations() {
+    static const std::vector<Migration> migrations = {
+        {
+            1,
+            "Index composites sur les chemins chauds",
+            {
+                // Résolution d'une alliance depuis son thread forum
+                "CREATE INDEX IF NOT EXISTS alliances_guild_thread_idx "
+                "ON alliances (guild_id, thread_channel_id)",
+
+                // Participants actifs (left_at = 0) : roster, join/leave, start
+                "CREATE INDEX IF NOT EXISTS alliance_participants_alliance_left_idx "
+                "ON alliance_participants (alliance_id, left_at)",
+                "CREATE INDEX IF NOT EXISTS alliance_participants_active_ship_idx "
+                "ON alliance_participants (alliance_id, ship_id) WHERE left_at = 0",
+                "CREATE INDEX IF NOT EXISTS alliance_participants_active_user_idx "
+                "ON alliance_participants (alliance_id, user_id) WHERE left_at = 0",
+
+                // Bateaux d'une alliance, triés par slot
+                "CREATE INDEX IF NOT EXISTS ships_alliance_slot_idx "
+                "ON ships (alliance_id, slot)",
+
+                // Objets Discord d'une alliance, et ceux encore à nettoyer
+                "CREATE INDEX IF NOT EXISTS alliance_discord_objects_alliance_type_idx "
+                "ON alliance_discord_objects (alliance_id, type)",
+                "CREATE INDEX IF NOT EXISTS alliance_discord_objects_live_idx "
+                "ON alliance_discord_objects (alliance_id, type) WHERE deleted_at = 0",
+            }
+        },
+        {
+            2,
+            "Hash du contenu des messages de roster",
+            {
+                "ALTER TABLE alliance_discord_objects "
+                "ADD COLUMN IF NOT EXISTS content_hash BIGINT NOT NULL DEFAULT 0",
+            }
+        },
+        {
+            3,
+            "File de nettoyage persistante des objets Discord",
+            {
+                "ALTER TABLE alliance_discord_objects "
+                "ADD COLUMN IF NOT EXISTS cleanup_attempts INTEGER NOT NULL DEFAULT 0",
+                "ALTER TABLE alliance_discord_objects "
+                "ADD COLUMN IF NOT EXISTS cleanup_at BIGINT NOT NULL DEFAULT 0",
+
+                // Reprise au démarrage : suppressions planifiées et non terminées
+                "CREATE INDEX IF NOT EXISTS alliance_discord_objects_cleanup_idx "
+                "ON alliance_discord_objects (cleanup_at) "
+                "WHERE cleanup_at > 0 AND deleted_at = 0",
+            }
+        },
+        {
+            4,
+            "Outbox des effets Discord",
+            {
+                // Même DDL que le schéma ODB de OutboxEvent (bases créées avant le modèle)
+                "CREATE TABLE IF NOT EXISTS \"discord_outbox\" ("
+                " \"id\" BIGSERIAL NOT NULL PRIMARY KEY,"
+                " \"idempotency_key\" TEXT NOT NULL,"
+                " \"kind\" SMALLINT NOT NULL,"
+                " \"status\" SMALLINT NOT NULL,"
+                " \"guild_id\" BIGINT NOT NULL,"
+                " \"alliance_id\" BIGINT NOT NULL,"
+                " \"channel_id\" BIGINT NOT NULL,"
+                " \"payload\" TEXT NOT NULL,"
+                " \"attempts\" INTEGER NOT NULL,"
+                " \"created_at\" BIGINT NOT NULL,"
+                " \"next_attempt_at\" BIGINT NOT NULL,"
+                " \"done_at\" BIGINT NOT NULL,"
+                " \"last_error\" TEXT NOT NULL)",
+                "CREATE UNIQUE INDEX IF NOT EXISTS \"discord_outbox_idempotency_key_i\" "
+                "ON \"discord_outbox\" (\"idempotency_key\")",
+
+                // Dispatcher : événements en attente par date de prochaine tentative
+                "CREATE INDEX IF NOT EXISTS discord_outbox_pending_idx "
+                "ON discord_outbox (next_attempt_at, id) WHERE status = 0",
+            }
+        },
+        {
+            5,
+            "Pagination du message de roster",
+            {
+                "ALTER TABLE alliance_discord_objects "
+                "ADD COLUMN IF NOT EXISTS page INTEGER NOT NULL DEFAULT 0",
+            }
+        },
+        {
+            6,
+            "Réservation des événements de l'outbox",
+            {
+                "ALTER TABLE discord_outbox "
+                "ADD COLUMN IF NOT EXISTS locked_until BIGINT NOT NULL DEFAULT 0",
+
+                // Reprise des réservations expirées (instance arrêtée en cours de traitement)
+                "CREATE INDEX IF NOT EXISTS discord_outbox_in_progress_idx "
+                "ON discord_outbox (locked_until) WHERE status = 3",
+            }
+        },
+        {
+            7,
+            "Jeton d'assistant des alliances",
+            {
+                "ALTER TABLE alliances "
+                "ADD COLUMN IF NOT EXISTS wizard_nonce INTEGER NOT NULL DEFAULT 0",
+
+                // Un même assistant ne crée qu'une alliance (double clic, livraison rejouée)
+                "CREATE UNIQUE INDEX IF NOT EXISTS alliances_wizard_nonce_idx "
+                "ON alliances (guild_id, organizer_id, wizard_nonce) WHERE wizard_nonce <> 0",
+            }
+        },
+    };
+    return migrations;
+}
+
+int run_migrations(const std::shared_ptr<odb::pgsql::database>& db) {
+    int applied = 0;
+
+    {
+        odb::transaction t(db->begin());
+        ensure_migrations_table(*db);
+        t.commit();
+    }
+
+    for (const auto& m : all_migrations()) {
+        odb::transaction t(db->begin());
+        db->execute("SELECT pg_advisory_xact_lock(" + std::to_string(MIGRATION_LOCK_KEY) + ")");
+
+        // Revérifié sous verrou : une autre instance a pu l'appliquer entre-temps.
+        if (is_applied(*db, m.version)) {
+            t.commit();
+            continue;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (const auto& stmt : m.statements) {
+            db->execute(stmt);
+        }
+
+        const auto now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count();
+
+        db->execute(
+            "INSERT INTO bot_schema_migrations (version, description, applied_at) VALUES ("
+            + std::to_string(m.version) + ", "
+            + quote_literal(m.description) + ", "
+            + std::to_string(now) + ")"
+        );
+
+        t.commit();
+        ++applied;
+
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+        std::cout << "[DB] Migration " << m.version << " appliquée (" << m.description
+                  << ") en " << ms << " ms\n";
+    }
+
+    return applied;
+}
@@ -1,4 +1,5 @@
 #include "db/Schema.hpp"
+#include "db/Migrations.hpp"
 
 #include <iostream>
 
@@ -6,21 +7,50 @@
 #include <odb/transaction.hxx>
 #include <odb/pgsql/database.hxx>
 
+namespace {
+
+// Le modèle ODB n'est pas versionné : schema_version() vaut toujours 0 et
+// create_schema() supprime puis recrée les tables. On ne l'appelle donc que
+// sur une base vide, le reste passe par les migrations.
+bool has_existing_tables(odb::pgsql::database& db) {
+    return db.execute(
+        "SELECT 1 FROM pg_catalog.pg_tables "
+        "WHERE schemaname = current_schema() AND tablename = 'alliances'"
+    ) > 0;
+}
+
+} // namespace
+
 void init_schema(const std::shared_ptr<odb::pgsql::database>& db) {
     try {
-        odb::schema_version v = db->schema_version();
+        bool exists = false;
+        {
+            odb::transaction t(db->begin());
+            exists = has_existing_tables(*db);
+            t.commit();
+        }
 
-        if (v == 0) {
+        if (!exists) {
             std::cout << "[DB] Aucun schéma ODB, création...\n";
             odb::transaction t(db->begin());
             odb::schema_catalog::create_schema(*db);
             t.commit();
             std::cout << "[DB] Schéma ODB créé.\n";
         } else {
-            std::cout << "[DB] Schéma ODB déjà présent (v=" << v << ")\n";
+            std::cout << "[DB] Schéma ODB déjà présent\n";
         }
     } catch (const std::exception& ex) {
         std::cerr << "[DB] Erreur init schéma : " << ex.what() << "\n";
+        return;
+    }
+
+    try {
+        int applied = run_migrations(db);
+        if (applied == 0) {
+            std::cout << "[DB] Migrations à jour\n";
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "[DB] Erreur migrations : " << ex.what() << "\n";
     }
 }
 
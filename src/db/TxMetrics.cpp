@@ -0,0 +1,36 @@
+#include "db/TxMetrics.hpp"
+#include "db/DbTrace.hpp"
+#include "util/Metrics.hpp"
+
+#include <chrono>
+
+#include <odb/transaction.hxx>
+
+namespace tx_metrics {
+
+namespace {
+
+constexpr const char* FAMILY = "sot_db_transaction_duration_seconds";
+
+using Clock = std::chrono::steady_clock;
+
+// key : histogramme de l'issue, data : instant du begin (ns, horloge monotone).
+void on_end(unsigned short, void* key, unsigned long long data) {
+    const Clock::time_point start {Clock::duration(static_cast<Clock::rep>(data))};
+    static_cast<metrics::Histogram*>(key)->observe_since(start);
+}
+
+} // namespace
+
+void track(odb::transaction& t, std::string_view type) {
+    metrics::Histogram& committed  = metrics::histogram(FAMILY, {{"type", type}, {"outcome", "commit"}});
+    metrics::Histogram& rolledback = metrics::histogram(FAMILY, {{"type", type}, {"outcome", "rollback"}});
+
+    const auto now = static_cast<unsigned long long>(Clock::now().time_since_epoch().count());
+    t.callback_register(&on_end, &committed, odb::transaction::event_commit, now);
+    t.callback_register(&on_end, &rolledback, odb::transaction::event_rollback, now);
+
+    db_trace::label(type);
+}
+
+} // namespace tx_metrics
@@ -4,9 +4,12 @@
 #include <string>
 
 #include "util/env.hpp"
+#include "util/Trace.hpp"
 #include "db/Database.hpp"
+#include "db/DbExecutor.hpp"
 #include "db/Schema.hpp"
 #include "bot/AllianceBot.hpp"
+#include "bot/AllianceIndex.hpp"
 
 int main() {
     std::cout.setf(std::ios::unitbuf);
@@ -17,14 +20,22 @@ int main() {
         return 1;
     }
 
+    trace::init();
+
     DbConfig cfg = load_db_config_from_env();
     auto db = make_database(cfg);
 
     init_schema(db);
     test_connection(db);
 
+    alliance_index::load(db);
+
+    db_executor::start(cfg.workers);
+
     AllianceBot bot(token, db);
     bot.run();
 
+    db_executor::stop();
+
     return 0;
 }
@@ -0,0 +1,294 @@
+#include "util/CompactCodec.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+namespace compact_codec {
+
+namespace {
+
+constexpr char Z85[] =
+    "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ.-:+=^!/*?&<>()[]{}@%$#";
+
+constexpr std::size_t TAG_BYTES = 6; // 48 bits
+
+std::atomic<std::uint64_t> g_sealed {0};
+std::atomic<std::uint64_t> g_too_long {0};
+std::atomic<std::size_t>   g_last_len {0};
+std::atomic<std::size_t>   g_max_len {0};
+
+std::array<std::int8_t, 128> make_decode_table() {
+    std::array<std::int8_t, 128> table {};
+    table.fill(-1);
+    for (int i = 0; i < 85; ++i) {
+        table[static_cast<unsigned char>(Z85[i])] = static_cast<std::int8_t>(i);
+    }
+    return table;
+}
+
+std::uint64_t rotl(std::uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+void sip_round(std::uint64_t& v0, std::uint64_t& v1, std::uint64_t& v2, std::uint64_t& v3) {
+    v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+    v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+}
+
+std::uint64_t load_le64(const unsigned char* p) {
+    std::uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+std::mutex g_key_mutex;
+Key g_key {};
+
+Key current_key() {
+    std::lock_guard<std::mutex> lock(g_key_mutex);
+    return g_key;
+}
+
+std::string tag_for(std::string_view prefix, std::string_view context, std::string_view payload) {
+    // Séparateurs de longueur : ("ab", "c") et ("a", "bc") ne donnent pas le même tag.
+    Writer w;
+    w.str(prefix);
+    w.str(context);
+    w.str(payload);
+
+    const std::uint64_t h = siphash24(current_key(), w.bytes());
+
+    std::string tag(TAG_BYTES, '\0');
+    for (std::size_t i = 0; i < TAG_BYTES; ++i) {
+        tag[i] = static_cast<char>((h >> (8 * i)) & 0xFF);
+    }
+    return tag;
+}
+
+} // namespace
+
+void Writer::varint(std::uint64_t v) {
+    while (v >= 0x80) {
+        bytes_.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    bytes_.push_back(static_cast<char>(v));
+}
+
+void Writer::str(std::string_view s) {
+    varint(s.size());
+    bytes_.append(s.data(), s.size());
+}
+
+bool Reader::u8(std::uint8_t& v) {
+    if (pos_ >= bytes_.size())
+        return false;
+    v = static_cast<std::uint8_t>(bytes_[pos_++]);
+    return true;
+}
+
+bool Reader::varint(std::uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        std::uint8_t b = 0;
+        if (!u8(b))
+            return false;
+        v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+            return true;
+    }
+    return false; // plus de 10 octets : invalide
+}
+
+bool Reader::str(std::string& s, std::size_t max_len) {
+    std::uint64_t len = 0;
+    if (!varint(len) || len > max_len || len > bytes_.size() - pos_)
+        return false;
+    s.assign(bytes_.substr(pos_, static_cast<std::size_t>(len)));
+    pos_ += static_cast<std::size_t>(len);
+    return true;
+}
+
+// Blocs de 4 octets -> 5 caractères ; un bloc final de n octets donne n + 1 caractères.
+std::string base85_encode(std::string_view bytes) {
+    std::string out;
+    out.reserve((bytes.size() * 5 + 3) / 4);
+
+    for (std::size_t i = 0; i < bytes.size(); i += 4) {
+        const std::size_t n = std::min<std::size_t>(4, bytes.size() - i);
+
+        std::uint32_t value = 0;
+        for (std::size_t j = 0; j < 4; ++j) {
+            const std::uint8_t b = j < n ? static_cast<std::uint8_t>(bytes[i + j]) : 0;
+            value = (value << 8) | b;
+        }
+
+        char block[5];
+        for (int j = 4; j >= 0; --j) {
+            block[j] = Z85[value % 85];
+            value /= 85;
+        }
+        out.append(block, n + 1);
+    }
+
+    return out;
+}
+
+std::optional<std::string> base85_decode(std::string_view text) {
+    static const std::array<std::int8_t, 128> table = make_decode_table();
+
+    if (text.size() % 5 == 1)
+        return std::nullopt;
+
+    std::string out;
+    out.reserve(text.size() * 4 / 5);
+
+    for (std::size_t i = 0; i < text.size(); i += 5) {
+        const std::size_t n = std::min<std::size_t>(5, text.size() - i);
+
+        std::uint64_t value = 0;
+        for (std::size_t j = 0; j < 5; ++j) {
+            int digit = 84; // bourrage par le plus grand chiffre
+            if (j < n) {
+                const unsigned char c = static_cast<unsigned char>(text[i + j]);
+                if (c >= table.size() || table[c] < 0)
+                    return std::nullopt;
+                digit = table[c];
+            }
+            value = value * 85 + static_cast<std::uint64_t>(digit);
+        }
+        if (value > 0xFFFFFFFFull)
+            return std::nullopt;
+
+        for (std::size_t j = 0; j + 1 < n; ++j) {
+            out.push_back(static_cast<char>((value >> (24 - 8 * j)) & 0xFF));
+        }
+    }
+
+    return out;
+}
+
+std::uint64_t siphash24(const Key& key, std::string_view data) {
+    const std::uint64_t k0 = load_le64(key.data());
+    const std::uint64_t k1 = load_le64(key.data() + 8);
+
+    std::uint64_t v0 = 0x736f6d6570736575ull ^ k0;
+    std::uint64_t v1 = 0x646f72616e646f6dull ^ k1;
+    std::uint64_t v2 = 0x6c7967656e657261ull ^ k0;
+    std::uint64_t v3 = 0x7465646279746573ull ^ k1;
+
+    const auto* p = reinterpret_cast<const unsigned char*>(data.data());
+    const std::size_t len = data.size();
+    const std::size_t full = len - (len % 8);
+
+    for (std::size_t i = 0; i < full; i += 8) {
+        const std::uint64_t m = load_le64(p + i);
+        v3 ^= m;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    std::uint64_t b = static_cast<std::uint64_t>(len) << 56;
+    for (std::size_t i = 0; i < len % 8; ++i) {
+        b |= static_cast<std::uint64_t>(p[full + i]) << (8 * i);
+    }
+
+    v3 ^= b;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= b;
+
+    v2 ^= 0xFF;
+    for (int i = 0; i < 4; ++i) {
+        sip_round(v0, v1, v2, v3);
+    }
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+void set_secret(std::string_view secret) {
+    // Deux hachages à clés fixes distinctes -> 128 bits de clé.
+    Key k_lo {};
+    Key k_hi {};
+    k_hi.fill(0x5A);
+
+    const std::uint64_t lo = siphash24(k_lo, secret);
+    const std::uint64_t hi = siphash24(k_hi, secret);
+
+    Key key {};
+    for (int i = 0; i < 8; ++i) {
+        key[i]     = static_cast<std::uint8_t>((lo >> (8 * i)) & 0xFF);
+        key[8 + i] = static_cast<std::uint8_t>((hi >> (8 * i)) & 0xFF);
+    }
+
+    std::lock_guard<std::mutex> lock(g_key_mutex);
+    g_key = key;
+}
+
+std::optional<std::string> seal(std::string_view prefix,
+                                std::string_view context,
+                                std::string_view payload,
+                                std::size_t max_len)
+{
+    std::string raw(payload);
+    raw += tag_for(prefix, context, payload);
+
+    std::string id(prefix);
+    id += base85_encode(raw);
+
+    if (id.size() > max_len) {
+        g_too_long.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    g_sealed.fetch_add(1, std::memory_order_relaxed);
+    g_last_len.store(id.size(), std::memory_order_relaxed);
+    std::size_t cur = g_max_len.load(std::memory_order_relaxed);
+    while (id.size() > cur &&
+           !g_max_len.compare_exchange_weak(cur, id.size(), std::memory_order_relaxed)) {
+    }
+    return id;
+}
+
+std::optional<std::string> open(std::string_view custom_id,
+                                std::string_view prefix,
+                                std::string_view context)
+{
+    if (custom_id.substr(0, prefix.size()) != prefix)
+        return std::nullopt;
+
+    auto raw = base85_decode(custom_id.substr(prefix.size()));
+    if (!raw || raw->size() < TAG_BYTES)
+        return std::nullopt;
+
+    std::string payload = raw->substr(0, raw->size() - TAG_BYTES);
+    const std::string tag = raw->substr(raw->size() - TAG_BYTES);
+
+    // Comparaison sans sortie anticipée.
+    const std::string expected = tag_for(prefix, context, payload);
+    unsigned char diff = 0;
+    for (std::size_t i = 0; i < TAG_BYTES; ++i) {
+        diff |= static_cast<unsigned char>(tag[i] ^ expected[i]);
+    }
+    if (diff != 0)
+        return std::nullopt;
+
+    return payload;
+}
+
+Stats stats() {
+    Stats st;
+    st.sealed   = g_sealed.load(std::memory_order_relaxed);
+    st.too_long = g_too_long.load(std::memory_order_relaxed);
+    st.last_len = g_last_len.load(std::memory_order_relaxed);
+    st.max_len  = g_max_len.load(std::memory_order_relaxed);
+    return st;
+}
+
+} // namespace compact_codec
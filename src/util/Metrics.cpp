@@ -0,0 +1,432 @@
+#include "util/Metrics.hpp"
+#include "util/env.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace metrics {
+
+namespace {
+
+// Valeurs "le" des seaux, alignées sur Histogram::BOUNDS_US.
+const char* const BUCKET_LABELS[] = {
+    "0.001", "0.0025", "0.005", "0.01", "0.025", "0.05", "0.1",
+    "0.25", "0.5", "1", "2.5", "5", "10", "+Inf"
+};
+static_assert(sizeof(BUCKET_LABELS) / sizeof(BUCKET_LABELS[0]) == Histogram::BOUNDS_US.size() + 1);
+
+struct Series {
+    std::string key;    // famille{étiquettes}, clé de recherche
+    std::string family;
+    std::string labels; // a="b",c="d", valeurs échappées
+    Type type = Type::counter;
+
+    Counter counter;
+    Histogram histogram;
+    std::function<double()> read; // séries lues à l'export
+};
+
+// Table à adressage ouvert : lectures sans verrou, insertions sous g_mutex,
+// publiées par un store release. Remplie au plus aux trois quarts.
+constexpr std::size_t SERIES_SLOTS = 1024; // puissance de 2
+constexpr std::size_t SERIES_MAX   = SERIES_SLOTS * 3 / 4;
+
+std::atomic<Series*> g_slots[SERIES_SLOTS];
+
+std::mutex g_mutex;
+std::vector<std::unique_ptr<Series>> g_owned;
+std::map<std::string, std::string, std::less<>> g_help;
+
+// Table pleine ou type incohérent : la série est comptée mais jamais exportée.
+Series& dropped_series() {
+    static Series s;
+    return s;
+}
+
+std::uint64_t fnv1a_64(std::string_view data) {
+    std::uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void append_escaped(std::string& out, std::string_view value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\n': out += "\\n";  break;
+            default:   out.push_back(c);
+        }
+    }
+}
+
+void append_labels(std::string& out, Labels labels) {
+    bool first = true;
+    for (const auto& [name, value] : labels) {
+        if (!first)
+            out.push_back(',');
+        first = false;
+        out.append(name.data(), name.size());
+        out += "=\"";
+        append_escaped(out, value);
+        out.push_back('"');
+    }
+}
+
+Series* find_slot(std::string_view key, std::uint64_t hash, std::size_t& free_slot) {
+    for (std::size_t probe = 0; probe < SERIES_SLOTS; ++probe) {
+        const std::size_t i = (static_cast<std::size_t>(hash) + probe) & (SERIES_SLOTS - 1);
+        Series* s = g_slots[i].load(std::memory_order_acquire);
+        if (!s) {
+            free_slot = i;
+            return nullptr;
+        }
+        if (s->key == key)
+            return s;
+    }
+    free_slot = SERIES_SLOTS;
+    return nullptr;
+}
+
+Series& series(std::string_view family, Labels labels, Type type, std::function<double()> read = {}) {
+    // Clé composée dans un tampon par thread : pas d'allocation une fois chaud.
+    thread_local std::string key;
+    key.assign(family.data(), family.size());
+    key.push_back('{');
+    append_labels(key, labels);
+    key.push_back('}');
+
+    const std::uint64_t hash = fnv1a_64(key);
+    std::size_t free_slot = SERIES_SLOTS;
+
+    Series* s = find_slot(key, hash, free_slot);
+    if (!s) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+
+        s = find_slot(key, hash, free_slot);
+        if (!s) {
+            if (free_slot == SERIES_SLOTS || g_owned.size() >= SERIES_MAX) {
+                std::cerr << "[Metrics] Trop de séries, " << key << " ignorée\n";
+                return dropped_series();
+            }
+
+            auto created = std::make_unique<Series>();
+            created->key = key;
+            created->family.assign(family.data(), family.size());
+            append_labels(created->labels, labels);
+            created->type = type;
+            created->read = std::move(read);
+
+            s = created.get();
+            g_owned.push_back(std::move(created));
+            g_slots[free_slot].store(s, std::memory_order_release);
+        }
+    }
+
+    if (s->type != type) {
+        std::cerr << "[Metrics] " << key << " déjà enregistrée avec un autre type\n";
+        return dropped_series();
+    }
+    return *s;
+}
+
+void append_number(std::string& out, double v) {
+    char buf[32];
+    const int n = std::snprintf(buf, sizeof(buf), "%.15g", v);
+    if (n > 0)
+        out.append(buf, static_cast<std::size_t>(n));
+}
+
+void append_number(std::string& out, std::uint64_t v) {
+    out += std::to_string(v);
+}
+
+void append_sample(std::string& out, const std::string& name, std::string_view suffix,
+                   const std::string& labels, std::string_view extra)
+{
+    out += name;
+    out.append(suffix.data(), suffix.size());
+    if (!labels.empty() || !extra.empty()) {
+        out.push_back('{');
+        out += labels;
+        if (!labels.empty() && !extra.empty())
+            out.push_back(',');
+        out.append(extra.data(), extra.size());
+        out.push_back('}');
+    }
+    out.push_back(' ');
+}
+
+void render_histogram(std::string& out, const Series& s) {
+    std::uint64_t cumulative = 0;
+    std::string le;
+    for (std::size_t i = 0; i < Histogram::BOUNDS_US.size() + 1; ++i) {
+        cumulative += s.histogram.bucket(i);
+        le = "le=\"";
+        le += BUCKET_LABELS[i];
+        le.push_back('"');
+        append_sample(out, s.family, "_bucket", s.labels, le);
+        append_number(out, cumulative);
+        out.push_back('\n');
+    }
+
+    append_sample(out, s.family, "_sum", s.labels, {});
+    append_number(out, static_cast<double>(s.histogram.sum_us()) / 1e6);
+    out.push_back('\n');
+
+    append_sample(out, s.family, "_count", s.labels, {});
+    append_number(out, cumulative);
+    out.push_back('\n');
+}
+
+const char* type_name(Type type) {
+    switch (type) {
+        case Type::counter:   return "counter";
+        case Type::gauge:     return "gauge";
+        case Type::histogram: return "histogram";
+    }
+    return "untyped";
+}
+
+std::uint16_t metrics_port() {
+    static const std::uint16_t value = []() -> std::uint16_t {
+        try {
+            const unsigned long port = std::stoul(getenv_or("METRICS_PORT", "0"));
+            if (port > 65535)
+                throw std::out_of_range("METRICS_PORT");
+            return static_cast<std::uint16_t>(port);
+        } catch (...) {
+            std::cerr << "Warning : METRICS_PORT invalide, utilisation de 0.\n";
+            return 0;
+        }
+    }();
+    return value;
+}
+
+bool send_all(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+void respond(int fd, const char* status, const char* content_type, const std::string& body, bool head) {
+    std::string out = "HTTP/1.1 ";
+    out += status;
+    out += "\r\nContent-Type: ";
+    out += content_type;
+    out += "\r\nContent-Length: ";
+    out += std::to_string(body.size());
+    out += "\r\nConnection: close\r\n\r\n";
+    if (!head)
+        out += body;
+    send_all(fd, out.data(), out.size());
+}
+
+// Une requête par connexion : seule la ligne de requête est lue.
+void handle_client(int fd) {
+    timeval timeout {};
+    timeout.tv_sec = 2;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    char buf[2048];
+    std::size_t len = 0;
+    while (len < sizeof(buf)) {
+        const ssize_t n = ::recv(fd, buf + len, sizeof(buf) - len, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        len += static_cast<std::size_t>(n);
+        if (std::string_view(buf, len).find("\r\n\r\n") != std::string_view::npos)
+            break;
+    }
+
+    const std::string_view request(buf, len);
+    const std::string_view line = request.substr(0, request.find("\r\n"));
+
+    const auto sp1 = line.find(' ');
+    const auto sp2 = line.find(' ', sp1 == std::string_view::npos ? line.size() : sp1 + 1);
+    if (sp1 == std::string_view::npos || sp2 == std::string_view::npos) {
+        respond(fd, "400 Bad Request", "text/plain; charset=utf-8", "Requête invalide\n", false);
+        return;
+    }
+
+    const std::string_view method = line.substr(0, sp1);
+    std::string_view path = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    path = path.substr(0, path.find('?'));
+
+    const bool head = method == "HEAD";
+    if (method != "GET" && !head) {
+        respond(fd, "405 Method Not Allowed", "text/plain; charset=utf-8", "GET uniquement\n", false);
+        return;
+    }
+    if (path != "/metrics") {
+        respond(fd, "404 Not Found", "text/plain; charset=utf-8", "Voir /metrics\n", head);
+        return;
+    }
+
+    respond(fd, "200 OK", "text/plain; version=0.0.4; charset=utf-8", render(), head);
+}
+
+void serve(int listen_fd) {
+    for (;;) {
+        const int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno != EINTR) {
+                std::cerr << "[Metrics] Erreur accept : " << std::strerror(errno) << "\n";
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+            continue;
+        }
+
+        try {
+            handle_client(fd);
+        } catch (const std::exception& ex) {
+            std::cerr << "[Metrics] Erreur export : " << ex.what() << "\n";
+        }
+        ::close(fd);
+    }
+}
+
+} // namespace
+
+void Histogram::observe_us(std::uint64_t us) noexcept {
+    const auto it = std::lower_bound(BOUNDS_US.begin(), BOUNDS_US.end(), us);
+    buckets_[static_cast<std::size_t>(it - BOUNDS_US.begin())].fetch_add(1, std::memory_order_relaxed);
+    sum_us_.fetch_add(us, std::memory_order_relaxed);
+}
+
+void Histogram::observe_since(std::chrono::steady_clock::time_point start) noexcept {
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    observe_us(static_cast<std::uint64_t>(
+        std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count())
+    ));
+}
+
+void describe(std::string_view family, std::string_view help) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_help[std::string(family)] = std::string(help);
+}
+
+Counter& counter(std::string_view family, Labels labels) {
+    return series(family, labels, Type::counter).counter;
+}
+
+Histogram& histogram(std::string_view family, Labels labels) {
+    return series(family, labels, Type::histogram).histogram;
+}
+
+void callback(std::string_view family, Type type, Labels labels, std::function<double()> read) {
+    series(family, labels, type, std::move(read));
+}
+
+std::string render() {
+    std::vector<const Series*> all;
+    std::map<std::string, std::string, std::less<>> help;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        all.reserve(g_owned.size());
+        for (const auto& s : g_owned)
+            all.push_back(s.get());
+        help = g_help;
+    }
+
+    std::sort(all.begin(), all.end(), [](const Series* a, const Series* b) {
+        return a->family != b->family ? a->family < b->family : a->labels < b->labels;
+    });
+
+    std::string out;
+    out.reserve(all.size() * 128);
+
+    const std::string* family = nullptr;
+    for (const Series* s : all) {
+        if (!family || *family != s->family) {
+            family = &s->family;
+            auto it = help.find(s->family);
+            if (it != help.end())
+                out += "# HELP " + s->family + " " + it->second + "\n";
+            out += "# TYPE " + s->family + " " + type_name(s->type) + "\n";
+        }
+
+        if (s->type == Type::histogram) {
+            render_histogram(out, *s);
+            continue;
+        }
+
+        append_sample(out, s->family, {}, s->labels, {});
+        if (s->read) {
+            double v = 0;
+            try {
+                v = s->read();
+            } catch (const std::exception& ex) {
+                std::cerr << "[Metrics] Erreur lecture " << s->key << " : " << ex.what() << "\n";
+            }
+            append_number(out, v);
+        } else {
+            append_number(out, s->counter.value());
+        }
+        out.push_back('\n');
+    }
+
+    return out;
+}
+
+void start_server() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        const std::uint16_t port = metrics_port();
+        if (port == 0)
+            return;
+
+        const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            std::cerr << "[Metrics] Erreur socket : " << std::strerror(errno) << "\n";
+            return;
+        }
+
+        const int yes = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+        sockaddr_in addr {};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port        = htons(port);
+
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+            std::cerr << "[Metrics] Impossible d'écouter sur le port " << port << " : "
+                      << std::strerror(errno) << "\n";
+            ::close(fd);
+            return;
+        }
+
+        std::thread(serve, fd).detach();
+        std::cout << "[Metrics] Export Prometheus sur :" << port << "/metrics\n";
+    });
+}
+
+} // namespace metrics
@@ -0,0 +1,318 @@
+#include "util/TimeParse.hpp"
+#include "util/TimeZone.hpp"
+
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <system_error>
+
+namespace time_parse {
+
+namespace {
+
+// Classes de caractères de la locale "C" (celle du bot), sans appel à <cctype>.
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+std::string_view trim(std::string_view s) {
+    std::size_t b = 0;
+    while (b < s.size() && is_space(s[b]))
+        ++b;
+
+    std::size_t e = s.size();
+    while (e > b && is_space(s[e - 1]))
+        --e;
+
+    return s.substr(b, e - b);
+}
+
+// Même résultat que std::stoi(s) : blancs initiaux, signe optionnel, au moins
+// un chiffre, suite ignorée ; false là où stoi lèverait une exception.
+bool stoi_prefix(std::string_view s, int& out) {
+    std::size_t i = 0;
+    while (i < s.size() && is_space(s[i]))
+        ++i;
+
+    bool negative = false;
+    if (i < s.size() && (s[i] == '+' || s[i] == '-')) {
+        negative = s[i] == '-';
+        ++i;
+    }
+
+    // from_chars accepte '-' mais pas '+' : le signe est déjà consommé.
+    if (i == s.size() || !is_digit(s[i]))
+        return false;
+
+    long long magnitude = 0;
+    const auto [ptr, ec] = std::from_chars(s.data() + i, s.data() + s.size(), magnitude);
+    (void)ptr;
+    if (ec != std::errc{})
+        return false;
+
+    const long long v = negative ? -magnitude : magnitude;
+    if (v < INT_MIN || v > INT_MAX)
+        return false;
+
+    out = static_cast<int>(v);
+    return true;
+}
+
+// std::stoi appliqué au fil de l'eau : les grammaires d'heure ignorent les
+// espaces partout, la chaîne filtrée n'a donc pas besoin d'être construite.
+class StoiScan {
+public:
+    void feed(char c) {
+        switch (state_) {
+        case State::start:
+            if (c == '+' || c == '-') {
+                negative_ = c == '-';
+                state_ = State::sign;
+                return;
+            }
+            [[fallthrough]];
+        case State::sign:
+            if (is_digit(c)) {
+                state_ = State::digits;
+                add(c);
+            } else {
+                state_ = State::invalid;
+            }
+            return;
+        case State::digits:
+            if (is_digit(c))
+                add(c);
+            else
+                state_ = State::done;
+            return;
+        case State::done:
+        case State::invalid:
+            return;
+        }
+    }
+
+    bool result(int& out) const {
+        if (state_ != State::digits && state_ != State::done)
+            return false;
+
+        const std::int64_t v = negative_ ? -magnitude_ : magnitude_;
+        if (v < INT_MIN || v > INT_MAX)
+            return false;
+
+        out = static_cast<int>(v);
+        return true;
+    }
+
+private:
+    enum class State { start, sign, digits, done, invalid };
+
+    // Plafonné juste au-delà de |INT_MIN| : les zéros de tête restent acceptés.
+    static constexpr std::int64_t CAP = std::int64_t(INT_MAX) + 2;
+
+    void add(char c) {
+        magnitude_ = magnitude_ * 10 + (c - '0');
+        if (magnitude_ > CAP)
+            magnitude_ = CAP;
+    }
+
+    State state_ = State::start;
+    bool negative_ = false;
+    std::int64_t magnitude_ = 0;
+};
+
+bool valid_hhmm(int hour, int minute) {
+    return hour >= 0 && hour <= 23 && minute >= 0 && minute <= 59;
+}
+
+// JJ/MM[/AAAA] -> jour, mois et année brute ; has_year faux pour JJ/MM.
+bool split_ddmm(std::string_view s, int& day, int& month, int& year, bool& has_year) {
+    const auto p1 = s.find('/');
+    if (p1 == std::string_view::npos)
+        return false;
+    const auto p2 = s.find('/', p1 + 1);
+
+    if (!stoi_prefix(s.substr(0, p1), day))
+        return false;
+
+    has_year = p2 != std::string_view::npos;
+    if (!has_year)
+        return stoi_prefix(s.substr(p1 + 1), month);
+
+    return stoi_prefix(s.substr(p1 + 1, p2 - p1 - 1), month)
+        && stoi_prefix(s.substr(p2 + 1), year);
+}
+
+} // namespace
+
+bool parse_hhmm(std::string_view input, int& hour, int& minute) noexcept {
+    StoiScan h_scan;
+    StoiScan m_scan;
+    bool colon = false;
+    bool all_digits = true;
+    std::size_t before = 0;
+    std::size_t after = 0;
+
+    for (char c : input) {
+        if (is_space(c))
+            continue;
+
+        if (c >= 'A' && c <= 'Z')
+            c = static_cast<char>(c - 'A' + 'a');
+        if (c == 'h')
+            c = ':'; // 7h30 -> 7:30, 7h -> 7:
+
+        if (colon) {
+            after++;
+            m_scan.feed(c);
+        } else if (c == ':') {
+            colon = true;
+        } else {
+            before++;
+            all_digits = all_digits && is_digit(c);
+            h_scan.feed(c);
+        }
+    }
+
+    int h = 0;
+    int m = 0;
+
+    if (!colon) {
+        // "7", "07" -> 7:00
+        if (before == 0 || !all_digits || !h_scan.result(h))
+            return false;
+    } else {
+        // "7:" -> minutes = 0
+        if (before == 0 || !h_scan.result(h))
+            return false;
+        if (after > 0 && !m_scan.result(m))
+            return false;
+    }
+
+    if (!valid_hhmm(h, m))
+        return false;
+
+    hour = h;
+    minute = m;
+    return true;
+}
+
+bool parse_clock(std::string_view input, int& hour, int& minute) noexcept {
+    StoiScan h_scan;
+    StoiScan m_scan;
+    bool colon = false;
+
+    for (char c : input) {
+        if (is_space(c))
+            continue;
+
+        if (colon)
+            m_scan.feed(c);
+        else if (c == ':')
+            colon = true;
+        else
+            h_scan.feed(c);
+    }
+
+    int h = 0;
+    int m = 0;
+    if (!colon || !h_scan.result(h) || !m_scan.result(m) || !valid_hhmm(h, m))
+        return false;
+
+    hour = h;
+    minute = m;
+    return true;
+}
+
+bool parse_iso_date(std::string_view iso, int& year, int& month, int& day) noexcept {
+    const std::string_view s = trim(iso);
+
+    const auto p1 = s.find('-');
+    if (p1 == std::string_view::npos)
+        return false;
+    const auto p2 = s.find('-', p1 + 1);
+    if (p2 == std::string_view::npos)
+        return false;
+
+    if (!stoi_prefix(s.substr(0, p1), year) ||
+        !stoi_prefix(s.substr(p1 + 1, p2 - p1 - 1), month) ||
+        !stoi_prefix(s.substr(p2 + 1), day))
+        return false;
+
+    return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+bool parse_french_date(std::string_view input, int current_year, int& year, int& month, int& day) noexcept {
+    int d = 0, m = 0, y = 0;
+    bool has_year = false;
+    if (!split_ddmm(trim(input), d, m, y, has_year))
+        return false;
+
+    if (has_year) {
+        // JJ/MM/AAAA, JJ/MM/YY
+        if (y < 100)
+            y += 2000;
+    } else {
+        y = current_year;
+    }
+
+    // Pas de 31/02 : le jour doit exister dans le mois.
+    if (m < 1 || m > 12 || d < 1 || d > time_zone::days_in_month(y, m))
+        return false;
+
+    year = y;
+    month = m;
+    day = d;
+    return true;
+}
+
+bool parse_date_ddmm(std::string_view input, const std::tm& base_tm, std::tm& out_tm) noexcept {
+    int d = 0, m = 0, y = 0;
+    bool has_year = false;
+    if (!split_ddmm(trim(input), d, m, y, has_year))
+        return false;
+
+    if (!has_year)
+        y = base_tm.tm_year + 1900;
+
+    if (d <= 0 || d > 31 || m <= 0 || m > 12 || y < 1970 || y > 2100)
+        return false;
+
+    out_tm = base_tm;
+    out_tm.tm_mday = d;
+    out_tm.tm_mon  = m - 1;
+    out_tm.tm_year = y - 1900;
+    return true;
+}
+
+bool make_time_t(std::string_view date_iso, std::string_view time_str,
+                 const TimeZone& zone, std::time_t& out) noexcept
+{
+    int year = 0, month = 0, day = 0;
+    int hour = 0, minute = 0;
+    if (!parse_iso_date(date_iso, year, month, day) || !parse_clock(time_str, hour, minute))
+        return false;
+
+    out = zone.from_local(year, month, day, hour, minute);
+    return true;
+}
+
+void format_hhmm(int hour, int minute, char (&out)[6]) noexcept {
+    out[0] = static_cast<char>('0' + hour / 10);
+    out[1] = static_cast<char>('0' + hour % 10);
+    out[2] = ':';
+    out[3] = static_cast<char>('0' + minute / 10);
+    out[4] = static_cast<char>('0' + minute % 10);
+    out[5] = '\0';
+}
+
+std::size_t format_iso_date(int year, int month, int day, char (&out)[20]) noexcept {
+    const int n = std::snprintf(out, sizeof(out), "%04d-%02d-%02d", year, month, day);
+    return n > 0 ? static_cast<std::size_t>(n) : 0;
+}
+
+} // namespace time_parse
@@ -0,0 +1,618 @@
+#include "util/TimeZone.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+namespace {
+
+constexpr std::int64_t SECONDS_PER_DAY = 86400;
+
+std::int64_t floor_div(std::int64_t a, std::int64_t b) {
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+bool is_leap(std::int64_t y) {
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+// 0 = dimanche (le 01/01/1970 était un jeudi).
+int weekday_from_days(std::int64_t days) {
+    return static_cast<int>(days - 7 * floor_div(days + 4, 7) + 4);
+}
+
+// ---- Lecture TZif (RFC 8536) ------------------------------------------------
+
+class ByteReader {
+public:
+    explicit ByteReader(const std::string& data) : data_(data) {}
+
+    bool skip(std::size_t n) {
+        if (n > data_.size() - pos_)
+            return false;
+        pos_ += n;
+        return true;
+    }
+
+    bool be32(std::uint32_t& v) {
+        if (data_.size() - pos_ < 4)
+            return false;
+        v = 0;
+        for (int i = 0; i < 4; ++i)
+            v = (v << 8) | static_cast<unsigned char>(data_[pos_++]);
+        return true;
+    }
+
+    bool be64(std::uint64_t& v) {
+        if (data_.size() - pos_ < 8)
+            return false;
+        v = 0;
+        for (int i = 0; i < 8; ++i)
+            v = (v << 8) | static_cast<unsigned char>(data_[pos_++]);
+        return true;
+    }
+
+    bool u8(std::uint8_t& v) {
+        if (pos_ >= data_.size())
+            return false;
+        v = static_cast<std::uint8_t>(data_[pos_++]);
+        return true;
+    }
+
+    std::string_view rest() const { return std::string_view(data_).substr(pos_); }
+
+private:
+    const std::string& data_;
+    std::size_t pos_ = 0;
+};
+
+struct TzifHeader {
+    char version = 0;
+    std::uint32_t isutcnt = 0, isstdcnt = 0, leapcnt = 0;
+    std::uint32_t timecnt = 0, typecnt = 0, charcnt = 0;
+
+    std::size_t data_size(std::size_t time_size) const {
+        return timecnt * time_size + timecnt + typecnt * 6 + charcnt
+             + leapcnt * (time_size + 4) + isstdcnt + isutcnt;
+    }
+};
+
+bool read_header(ByteReader& r, TzifHeader& h) {
+    std::uint8_t magic[4];
+    for (auto& b : magic) {
+        if (!r.u8(b))
+            return false;
+    }
+    if (magic[0] != 'T' || magic[1] != 'Z' || magic[2] != 'i' || magic[3] != 'f')
+        return false;
+
+    std::uint8_t version = 0;
+    if (!r.u8(version) || !r.skip(15))
+        return false;
+    h.version = static_cast<char>(version);
+
+    return r.be32(h.isutcnt) && r.be32(h.isstdcnt) && r.be32(h.leapcnt)
+        && r.be32(h.timecnt) && r.be32(h.typecnt) && r.be32(h.charcnt);
+}
+
+bool valid_zone_name(std::string_view name) {
+    if (name.empty() || name.size() > 64 || name.front() == '/' || name.find("..") != std::string_view::npos)
+        return false;
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')
+            || c == '/' || c == '_' || c == '-' || c == '+';
+    });
+}
+
+std::string zoneinfo_dir() {
+    const char* dir = std::getenv("TZDIR");
+    return dir && *dir ? dir : "/usr/share/zoneinfo";
+}
+
+// ---- Règle POSIX (pied de fichier TZif v2+) --------------------------------
+
+class SpecParser {
+public:
+    explicit SpecParser(std::string_view s) : s_(s) {}
+
+    bool done() const { return pos_ == s_.size(); }
+    char peek() const { return done() ? '\0' : s_[pos_]; }
+    bool eat(char c) {
+        if (peek() != c)
+            return false;
+        ++pos_;
+        return true;
+    }
+
+    // "CET" ou "<+03>".
+    bool name() {
+        if (eat('<')) {
+            const auto close = s_.find('>', pos_);
+            if (close == std::string_view::npos)
+                return false;
+            pos_ = close + 1;
+            return true;
+        }
+        const std::size_t start = pos_;
+        while (!done() && ((peek() >= 'A' && peek() <= 'Z') || (peek() >= 'a' && peek() <= 'z')))
+            ++pos_;
+        return pos_ - start >= 3;
+    }
+
+    bool number(int& v, int max_digits) {
+        int digits = 0;
+        v = 0;
+        while (!done() && peek() >= '0' && peek() <= '9' && digits < max_digits) {
+            v = v * 10 + (s_[pos_++] - '0');
+            ++digits;
+        }
+        return digits > 0;
+    }
+
+    // [+-]hh[:mm[:ss]], en secondes.
+    bool hms(int& seconds) {
+        const bool negative = eat('-');
+        if (!negative)
+            eat('+');
+
+        int h = 0, m = 0, s = 0;
+        if (!number(h, 3))
+            return false;
+        if (eat(':') && !number(m, 2))
+            return false;
+        if (eat(':') && !number(s, 2))
+            return false;
+
+        seconds = h * 3600 + m * 60 + s;
+        if (negative)
+            seconds = -seconds;
+        return true;
+    }
+
+    bool starts_offset() const {
+        const char c = peek();
+        return c == '+' || c == '-' || (c >= '0' && c <= '9');
+    }
+
+private:
+    std::string_view s_;
+    std::size_t pos_ = 0;
+};
+
+} // namespace
+
+namespace time_zone {
+
+std::int64_t days_from_civil(std::int64_t y, int m, int d) {
+    y -= m <= 2;
+    const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+void civil_from_days(std::int64_t z, std::int64_t& y, int& m, int& d) {
+    z += 719468;
+    const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp  = (5 * doy + 2) / 153;
+    d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    y = static_cast<std::int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+int days_in_month(std::int64_t y, int m) {
+    static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return m == 2 && is_leap(y) ? 29 : days[m - 1];
+}
+
+} // namespace time_zone
+
+TimeZone::TimeZone(std::string name, int utc_offset)
+    : name_(std::move(name)),
+      types_{Type{utc_offset, false}}
+{
+}
+
+std::unique_ptr<TimeZone> TimeZone::load(const std::string& name) {
+    std::ifstream in(zoneinfo_dir() + "/" + name, std::ios::binary);
+    if (!in)
+        return nullptr;
+    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    ByteReader r(data);
+    TzifHeader h;
+    if (!read_header(r, h))
+        return nullptr;
+
+    // v2+ : le bloc v1 (horodatages 32 bits) est suivi d'un second en 64 bits.
+    std::size_t time_size = 4;
+    if (h.version >= '2') {
+        if (!r.skip(h.data_size(4)) || !read_header(r, h))
+            return nullptr;
+        time_size = 8;
+    }
+    if (h.typecnt == 0)
+        return nullptr;
+
+    auto zone = std::make_unique<TimeZone>(name, 0);
+    zone->types_.clear();
+
+    zone->transitions_.reserve(h.timecnt);
+    for (std::uint32_t i = 0; i < h.timecnt; ++i) {
+        if (time_size == 8) {
+            std::uint64_t v = 0;
+            if (!r.be64(v))
+                return nullptr;
+            zone->transitions_.push_back(static_cast<std::int64_t>(v));
+        } else {
+            std::uint32_t v = 0;
+            if (!r.be32(v))
+                return nullptr;
+            zone->transitions_.push_back(static_cast<std::int32_t>(v));
+        }
+    }
+
+    zone->transition_types_.reserve(h.timecnt);
+    for (std::uint32_t i = 0; i < h.timecnt; ++i) {
+        std::uint8_t idx = 0;
+        if (!r.u8(idx) || idx >= h.typecnt)
+            return nullptr;
+        zone->transition_types_.push_back(idx);
+    }
+
+    for (std::uint32_t i = 0; i < h.typecnt; ++i) {
+        std::uint32_t utoff = 0;
+        std::uint8_t isdst = 0;
+        std::uint8_t desigidx = 0;
+        if (!r.be32(utoff) || !r.u8(isdst) || !r.u8(desigidx))
+            return nullptr;
+        zone->types_.push_back(Type{static_cast<std::int32_t>(utoff), isdst != 0});
+    }
+
+    // Désignations, secondes intercalaires et indicateurs : inutiles ici.
+    if (!r.skip(h.charcnt + h.leapcnt * (time_size + 4) + h.isstdcnt + h.isutcnt))
+        return nullptr;
+
+    if (time_size == 8) {
+        std::string_view footer = r.rest();
+        if (footer.size() >= 2 && footer.front() == '\n') {
+            footer.remove_prefix(1);
+            footer = footer.substr(0, footer.find('\n'));
+            zone->has_rule_ = !footer.empty() && parse_rule(footer, zone->rule_);
+        }
+    }
+
+    return zone;
+}
+
+bool TimeZone::parse_rule(std::string_view spec, Rule& rule) {
+    SpecParser p(spec);
+
+    int offset = 0;
+    if (!p.name() || !p.hms(offset))
+        return false;
+    rule.std_offset = -offset; // POSIX : positif à l'ouest
+    rule.dst_offset = rule.std_offset;
+
+    if (p.done())
+        return true;
+
+    if (!p.name())
+        return false;
+    rule.has_dst = true;
+    rule.dst_offset = rule.std_offset + 3600;
+    if (p.starts_offset()) {
+        if (!p.hms(offset))
+            return false;
+        rule.dst_offset = -offset;
+    }
+
+    auto date = [&p](RuleDate& d) {
+        if (p.eat('M')) {
+            d.kind = RuleDate::Kind::month_week_day;
+            if (!p.number(d.month, 2) || !p.eat('.') || !p.number(d.week, 1) ||
+                !p.eat('.') || !p.number(d.day, 1))
+                return false;
+            if (d.month < 1 || d.month > 12 || d.week < 1 || d.week > 5 || d.day > 6)
+                return false;
+        } else if (p.eat('J')) {
+            d.kind = RuleDate::Kind::julian1;
+            if (!p.number(d.day, 3) || d.day < 1 || d.day > 365)
+                return false;
+        } else {
+            d.kind = RuleDate::Kind::julian0;
+            if (!p.number(d.day, 3) || d.day > 365)
+                return false;
+        }
+        d.time = 2 * 3600;
+        return !p.eat('/') || p.hms(d.time);
+    };
+
+    if (p.done()) {
+        // Règle absente : celle des États-Unis, comme la libc.
+        rule.start = RuleDate{RuleDate::Kind::month_week_day, 3, 2, 0, 2 * 3600};
+        rule.end   = RuleDate{RuleDate::Kind::month_week_day, 11, 1, 0, 2 * 3600};
+        return true;
+    }
+
+    return p.eat(',') && date(rule.start) && p.eat(',') && date(rule.end) && p.done();
+}
+
+int TimeZone::rule_offset(std::time_t t, bool* dst) const {
+    if (!rule_.has_dst) {
+        if (dst)
+            *dst = false;
+        return rule_.std_offset;
+    }
+
+    std::int64_t year = 0;
+    int month = 0, day = 0;
+    time_zone::civil_from_days(floor_div(static_cast<std::int64_t>(t) + rule_.std_offset, SECONDS_PER_DAY),
+                               year, month, day);
+
+    // Instant UTC d'un changement d'heure, exprimé dans l'heure en vigueur avant lui.
+    auto transition = [year](const RuleDate& d, int offset_before) {
+        std::int64_t days = 0;
+        switch (d.kind) {
+        case RuleDate::Kind::julian1:
+            days = time_zone::days_from_civil(year, 1, 1) + d.day - 1 + (is_leap(year) && d.day >= 60);
+            break;
+        case RuleDate::Kind::julian0:
+            days = time_zone::days_from_civil(year, 1, 1) + d.day;
+            break;
+        case RuleDate::Kind::month_week_day: {
+            const std::int64_t first = time_zone::days_from_civil(year, d.month, 1);
+            days = first + (d.day - weekday_from_days(first) + 7) % 7 + (d.week - 1) * 7;
+            while (days >= first + time_zone::days_in_month(year, d.month))
+                days -= 7;
+            break;
+        }
+        }
+        return days * SECONDS_PER_DAY + d.time - offset_before;
+    };
+
+    const std::int64_t start = transition(rule_.start, rule_.std_offset);
+    const std::int64_t end   = transition(rule_.end, rule_.dst_offset);
+    const std::int64_t now   = static_cast<std::int64_t>(t);
+
+    // Hémisphère sud : l'heure d'été chevauche le nouvel an.
+    const bool in_dst = start < end ? (now >= start && now < end)
+                                    : !(now >= end && now < start);
+    if (dst)
+        *dst = in_dst;
+    return in_dst ? rule_.dst_offset : rule_.std_offset;
+}
+
+int TimeZone::offset_at(std::time_t t, bool* dst) const {
+    const std::int64_t now = static_cast<std::int64_t>(t);
+
+    if (has_rule_ && (transitions_.empty() || now >= transitions_.back()))
+        return rule_offset(t, dst);
+
+    // Avant la première transition : type 0 (RFC 8536).
+    std::size_t type = 0;
+    auto it = std::upper_bound(transitions_.begin(), transitions_.end(), now);
+    if (it != transitions_.begin())
+        type = transition_types_[static_cast<std::size_t>(it - transitions_.begin()) - 1];
+
+    if (dst)
+        *dst = types_[type].dst;
+    return types_[type].offset;
+}
+
+std::tm TimeZone::to_local(std::time_t t) const {
+    bool dst = false;
+    const std::int64_t local = static_cast<std::int64_t>(t) + offset_at(t, &dst);
+    const std::int64_t days  = floor_div(local, SECONDS_PER_DAY);
+    const std::int64_t secs  = local - days * SECONDS_PER_DAY;
+
+    std::int64_t year = 0;
+    int month = 0, day = 0;
+    time_zone::civil_from_days(days, year, month, day);
+
+    std::tm tm {};
+    tm.tm_year  = static_cast<int>(year - 1900);
+    tm.tm_mon   = month - 1;
+    tm.tm_mday  = day;
+    tm.tm_hour  = static_cast<int>(secs / 3600);
+    tm.tm_min   = static_cast<int>(secs % 3600 / 60);
+    tm.tm_sec   = static_cast<int>(secs % 60);
+    tm.tm_wday  = weekday_from_days(days);
+    tm.tm_yday  = static_cast<int>(days - time_zone::days_from_civil(year, 1, 1));
+    tm.tm_isdst = dst ? 1 : 0;
+    return tm;
+}
+
+std::time_t TimeZone::from_local(const std::tm& local) const {
+    const std::int64_t year  = 1900 + static_cast<std::int64_t>(local.tm_year) + floor_div(local.tm_mon, 12);
+    const int month          = static_cast<int>(local.tm_mon - 12 * floor_div(local.tm_mon, 12)) + 1;
+
+    const std::int64_t days = time_zone::days_from_civil(year, month, 1) + local.tm_mday - 1;
+    const std::int64_t wall = days * SECONDS_PER_DAY
+                            + static_cast<std::int64_t>(local.tm_hour) * 3600
+                            + static_cast<std::int64_t>(local.tm_min) * 60
+                            + local.tm_sec;
+
+    // Un seul changement d'heure par jour au plus : on essaie le décalage de
+    // la veille et celui du lendemain.
+    const int before = offset_at(static_cast<std::time_t>(wall - SECONDS_PER_DAY));
+    const int after  = offset_at(static_cast<std::time_t>(wall + SECONDS_PER_DAY));
+
+    const std::time_t t1 = static_cast<std::time_t>(wall - before);
+    const std::time_t t2 = static_cast<std::time_t>(wall - after);
+    const bool ok1 = offset_at(t1) == before;
+    const bool ok2 = offset_at(t2) == after;
+
+    if (ok1 && ok2)
+        return std::min(t1, t2);
+    if (ok2)
+        return t2;
+    return t1; // valide, ou dans le trou du passage à l'heure d'été
+}
+
+std::time_t TimeZone::from_local(int year, int month, int day, int hour, int minute, int second) const {
+    std::tm tm {};
+    tm.tm_year = year - 1900;
+    tm.tm_mon  = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min  = minute;
+    tm.tm_sec  = second;
+    return from_local(tm);
+}
+
+namespace time_zone {
+
+namespace {
+
+// Instantané immuable des fuseaux chargés, trié par nom. Un chargement publie
+// un nouvel instantané ; les anciens sont conservés car un lecteur peut
+// encore les parcourir (quelques fuseaux seulement par processus).
+struct Registry {
+    std::vector<std::pair<std::string, const TimeZone*>> zones;
+};
+
+std::atomic<const Registry*> g_registry {nullptr};
+
+std::mutex g_load_mutex;
+std::vector<std::unique_ptr<const TimeZone>> g_zones;
+std::vector<std::unique_ptr<const Registry>> g_registries;
+
+const TimeZone* find_in(const Registry* reg, std::string_view name) {
+    if (!reg)
+        return nullptr;
+    auto it = std::lower_bound(
+        reg->zones.begin(), reg->zones.end(), name,
+        [](const std::pair<std::string, const TimeZone*>& e, std::string_view n) { return e.first < n; }
+    );
+    return it != reg->zones.end() && it->first == name ? it->second : nullptr;
+}
+
+// Table serveur -> fuseau à adressage ouvert : lectures et insertions sans verrou.
+// Pleine, elle n'enregistre plus rien et bot_settings_cache::zone repasse par le cache.
+constexpr std::size_t GUILD_SLOTS = 4096; // puissance de 2
+constexpr std::size_t GUILD_PROBES = 32;
+
+struct GuildSlot {
+    std::atomic<std::uint64_t> guild_id {0};
+    std::atomic<const TimeZone*> zone {nullptr};
+};
+
+GuildSlot g_guilds[GUILD_SLOTS];
+
+std::size_t guild_slot(std::uint64_t guild_id, std::size_t probe) {
+    // Les snowflakes Discord ont des bits de poids faible peu variés.
+    const std::uint64_t h = guild_id * 0x9E3779B97F4A7C15ull;
+    return (static_cast<std::size_t>(h >> 40) + probe) & (GUILD_SLOTS - 1);
+}
+
+} // namespace
+
+const TimeZone* locate(std::string_view name) {
+    if (const TimeZone* zone = find_in(g_registry.load(std::memory_order_acquire), name))
+        return zone;
+
+    if (!valid_zone_name(name))
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(g_load_mutex);
+
+    const Registry* current = g_registry.load(std::memory_order_relaxed);
+    if (const TimeZone* zone = find_in(current, name))
+        return zone;
+
+    const std::string key(name);
+    std::unique_ptr<const TimeZone> zone = TimeZone::load(key);
+    if (!zone && (key == "UTC" || key == "Etc/UTC"))
+        zone = std::make_unique<const TimeZone>(key, 0);
+    if (!zone) {
+        std::cerr << "[TZ] Fuseau '" << key << "' introuvable dans " << zoneinfo_dir() << "\n";
+        return nullptr;
+    }
+
+    auto next = std::make_unique<Registry>();
+    if (current)
+        next->zones = current->zones;
+    auto pos = std::lower_bound(
+        next->zones.begin(), next->zones.end(), key,
+        [](const std::pair<std::string, const TimeZone*>& e, const std::string& n) { return e.first < n; }
+    );
+    next->zones.emplace(pos, key, zone.get());
+
+    const TimeZone* result = zone.get();
+    g_zones.push_back(std::move(zone));
+    g_registry.store(next.get(), std::memory_order_release);
+    g_registries.push_back(std::move(next));
+    return result;
+}
+
+const TimeZone& default_zone() {
+    static const TimeZone* zone = []() -> const TimeZone* {
+        const char* env = std::getenv("TZ");
+        std::string_view tz = env ? env : "";
+        if (!tz.empty() && tz.front() == ':')
+            tz.remove_prefix(1);
+
+        if (!tz.empty()) {
+            if (const TimeZone* z = locate(tz))
+                return z;
+            std::cerr << "Warning : TZ invalide, utilisation de Europe/Paris.\n";
+        }
+        if (const TimeZone* z = locate("Europe/Paris"))
+            return z;
+        return locate("UTC");
+    }();
+    return *zone;
+}
+
+const TimeZone* for_guild(std::uint64_t guild_id) {
+    for (std::size_t probe = 0; probe < GUILD_PROBES; ++probe) {
+        const GuildSlot& slot = g_guilds[guild_slot(guild_id, probe)];
+        const std::uint64_t id = slot.guild_id.load(std::memory_order_acquire);
+        if (id == guild_id)
+            return slot.zone.load(std::memory_order_acquire);
+        if (id == 0)
+            return nullptr;
+    }
+    return nullptr;
+}
+
+void remember_guild(std::uint64_t guild_id, const TimeZone* zone) {
+    if (guild_id == 0)
+        return;
+
+    for (std::size_t probe = 0; probe < GUILD_PROBES; ++probe) {
+        GuildSlot& slot = g_guilds[guild_slot(guild_id, probe)];
+        std::uint64_t id = slot.guild_id.load(std::memory_order_acquire);
+        if (id == 0 && slot.guild_id.compare_exchange_strong(id, guild_id, std::memory_order_acq_rel))
+            id = guild_id;
+        if (id == guild_id) {
+            slot.zone.store(zone, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+void forget_guild(std::uint64_t guild_id) {
+    for (std::size_t probe = 0; probe < GUILD_PROBES; ++probe) {
+        GuildSlot& slot = g_guilds[guild_slot(guild_id, probe)];
+        const std::uint64_t id = slot.guild_id.load(std::memory_order_acquire);
+        if (id == guild_id) {
+            slot.zone.store(nullptr, std::memory_order_release);
+            return;
+        }
+        if (id == 0)
+            return;
+    }
+}
+
+} // namespace time_zone
@@ -0,0 +1,427 @@
+#include "util/Trace.hpp"
+#include "util/env.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace trace {
+
+namespace {
+
+constexpr const char* SERVICE_NAME = "sot-alliance-bot";
+
+constexpr std::size_t QUEUE_MAX     = 10000; // au-delà, les spans sont abandonnés
+constexpr std::size_t BATCH_MAX     = 64;
+constexpr std::size_t DATAGRAM_MAX  = 60000; // sous la limite d'un datagramme UDP
+constexpr std::size_t ATTR_VALUE_MAX = 1024;
+
+constexpr auto FLUSH_INTERVAL = std::chrono::seconds(1);
+
+struct Attr {
+    std::string key;
+    std::string str;
+    std::int64_t num = 0;
+    bool is_num = false;
+};
+
+} // namespace
+
+struct Span::Data {
+    Context ctx;
+    std::uint64_t parent = 0;
+    std::string name;
+    Kind kind = Kind::internal;
+    std::uint64_t start_ns = 0;
+    std::uint64_t end_ns   = 0;
+    std::vector<Attr> attrs;
+    bool failed = false;
+    std::string status;
+};
+
+namespace {
+
+std::atomic<bool> g_enabled {false};
+
+std::mutex g_mutex;
+std::condition_variable g_cv;
+std::vector<std::unique_ptr<Span::Data>> g_queue;
+std::uint64_t g_dropped = 0;
+
+std::FILE* g_file = nullptr;
+int g_socket = -1;
+
+thread_local Context t_current;
+
+std::uint64_t now_ns() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count()
+    );
+}
+
+std::uint64_t random_id() {
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    std::uint64_t id = 0;
+    while (id == 0)
+        id = rng();
+    return id;
+}
+
+void append_hex(std::string& out, std::uint64_t v) {
+    static const char digits[] = "0123456789abcdef";
+    for (int shift = 60; shift >= 0; shift -= 4)
+        out.push_back(digits[(v >> shift) & 0xF]);
+}
+
+void append_json_string(std::string& out, std::string_view s) {
+    out.push_back('"');
+    for (char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                    out += buf;
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+void append_span(std::string& out, const Span::Data& d) {
+    out += "{\"traceId\":\"";
+    append_hex(out, d.ctx.trace_hi);
+    append_hex(out, d.ctx.trace_lo);
+    out += "\",\"spanId\":\"";
+    append_hex(out, d.ctx.span_id);
+    out += '"';
+    if (d.parent) {
+        out += ",\"parentSpanId\":\"";
+        append_hex(out, d.parent);
+        out += '"';
+    }
+    out += ",\"name\":";
+    append_json_string(out, d.name);
+    out += ",\"kind\":" + std::to_string(static_cast<int>(d.kind));
+    // Entiers 64 bits en chaînes, comme le veut le mapping JSON d'OTLP.
+    out += ",\"startTimeUnixNano\":\"" + std::to_string(d.start_ns) + '"';
+    out += ",\"endTimeUnixNano\":\"" + std::to_string(d.end_ns) + '"';
+
+    out += ",\"attributes\":[";
+    for (std::size_t i = 0; i < d.attrs.size(); ++i) {
+        const Attr& a = d.attrs[i];
+        if (i)
+            out.push_back(',');
+        out += "{\"key\":";
+        append_json_string(out, a.key);
+        if (a.is_num) {
+            out += ",\"value\":{\"intValue\":\"" + std::to_string(a.num) + "\"}}";
+        } else {
+            out += ",\"value\":{\"stringValue\":";
+            append_json_string(out, a.str);
+            out += "}}";
+        }
+    }
+    out.push_back(']');
+
+    if (d.failed) {
+        out += ",\"status\":{\"code\":2,\"message\":";
+        append_json_string(out, d.status);
+        out += '}';
+    }
+    out.push_back('}');
+}
+
+const std::string& line_prefix() {
+    static const std::string prefix = []() {
+        std::string p = "{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\","
+                        "\"value\":{\"stringValue\":";
+        append_json_string(p, SERVICE_NAME);
+        p += "}}]},\"scopeSpans\":[{\"scope\":{\"name\":";
+        append_json_string(p, SERVICE_NAME);
+        p += "},\"spans\":[";
+        return p;
+    }();
+    return prefix;
+}
+
+constexpr std::string_view LINE_SUFFIX = "]}]}]}\n";
+
+void write_line(const std::string& line) {
+    if (g_file) {
+        std::fwrite(line.data(), 1, line.size(), g_file);
+        std::fflush(g_file);
+    }
+    if (g_socket >= 0) {
+        // Datagramme perdu si le collecteur n'écoute pas : la trace n'est jamais bloquante.
+        ::send(g_socket, line.data(), line.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+}
+
+// Une ligne par lot, coupée avant de dépasser la taille d'un datagramme.
+void export_batch(const std::vector<std::unique_ptr<Span::Data>>& spans) {
+    std::string line;
+    std::string span;
+    std::size_t in_line = 0;
+
+    for (const auto& d : spans) {
+        span.clear();
+        append_span(span, *d);
+
+        if (in_line > 0 && line.size() + 1 + span.size() + LINE_SUFFIX.size() > DATAGRAM_MAX) {
+            line += LINE_SUFFIX;
+            write_line(line);
+            in_line = 0;
+        }
+
+        if (in_line == 0)
+            line = line_prefix();
+        else
+            line.push_back(',');
+        line += span;
+        in_line++;
+    }
+
+    if (in_line > 0) {
+        line += LINE_SUFFIX;
+        write_line(line);
+    }
+}
+
+void exporter_loop() {
+    std::vector<std::unique_ptr<Span::Data>> batch;
+
+    for (;;) {
+        std::uint64_t dropped = 0;
+        {
+            std::unique_lock<std::mutex> lock(g_mutex);
+            g_cv.wait_for(lock, FLUSH_INTERVAL, [] { return g_queue.size() >= BATCH_MAX; });
+            batch.swap(g_queue);
+            std::swap(dropped, g_dropped);
+        }
+
+        if (dropped > 0)
+            std::cerr << "[Trace] " << dropped << " span(s) abandonné(s), export trop lent\n";
+
+        if (!batch.empty()) {
+            try {
+                export_batch(batch);
+            } catch (const std::exception& ex) {
+                std::cerr << "[Trace] Erreur export : " << ex.what() << "\n";
+            }
+            batch.clear();
+        }
+    }
+}
+
+void enqueue(std::unique_ptr<Span::Data> d) {
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_queue.size() >= QUEUE_MAX) {
+            g_dropped++;
+            return;
+        }
+        g_queue.push_back(std::move(d));
+        if (g_queue.size() < BATCH_MAX)
+            return;
+    }
+    g_cv.notify_one();
+}
+
+// "hôte:port" -> socket UDP connectée, -1 en cas d'échec.
+int open_udp(const std::string& target) {
+    const auto colon = target.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == target.size()) {
+        std::cerr << "[Trace] TRACE_UDP invalide (attendu hôte:port) : " << target << "\n";
+        return -1;
+    }
+    const std::string host = target.substr(0, colon);
+    const std::string port = target.substr(colon + 1);
+
+    addrinfo hints {};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo* res = nullptr;
+    const int rc = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+    if (rc != 0) {
+        std::cerr << "[Trace] TRACE_UDP : " << target << " introuvable : " << gai_strerror(rc) << "\n";
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* ai = res; ai; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(res);
+
+    if (fd < 0)
+        std::cerr << "[Trace] TRACE_UDP : connexion à " << target << " impossible\n";
+    return fd;
+}
+
+} // namespace
+
+void init() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        const std::string file = getenv_or("TRACE_FILE", "");
+        const std::string udp  = getenv_or("TRACE_UDP", "");
+
+        if (!file.empty()) {
+            g_file = std::fopen(file.c_str(), "a");
+            if (!g_file)
+                std::cerr << "[Trace] Ouverture de " << file << " impossible : " << std::strerror(errno) << "\n";
+        }
+        if (!udp.empty())
+            g_socket = open_udp(udp);
+
+        if (!g_file && g_socket < 0)
+            return;
+
+        std::thread(exporter_loop).detach();
+        g_enabled.store(true, std::memory_order_release);
+
+        std::cout << "[Trace] Export OTLP JSON vers "
+                  << (g_file ? file : std::string())
+                  << (g_file && g_socket >= 0 ? " et " : "")
+                  << (g_socket >= 0 ? "udp://" + udp : std::string()) << "\n";
+    });
+}
+
+bool enabled() {
+    return g_enabled.load(std::memory_order_acquire);
+}
+
+Context current() {
+    return t_current;
+}
+
+Scope::Scope(const Context& ctx) : previous_(t_current) {
+    t_current = ctx;
+}
+
+Scope::~Scope() {
+    t_current = previous_;
+}
+
+Span::Span() noexcept = default;
+
+Span::Span(std::string name, Kind kind) : Span(std::move(name), kind, t_current) {}
+
+Span::Span(std::string name, Kind kind, const Context& parent) {
+    if (!enabled())
+        return;
+
+    data_ = std::make_unique<Data>();
+    if (parent.valid()) {
+        data_->ctx.trace_hi = parent.trace_hi;
+        data_->ctx.trace_lo = parent.trace_lo;
+        data_->parent       = parent.span_id;
+    } else {
+        data_->ctx.trace_hi = random_id();
+        data_->ctx.trace_lo = random_id();
+    }
+    data_->ctx.span_id = random_id();
+    data_->name        = std::move(name);
+    data_->kind        = kind;
+    data_->start_ns    = now_ns();
+}
+
+Span Span::interaction(std::string name, std::uint64_t interaction_id) {
+    // Trace = id d'interaction : les spans d'une même interaction se retrouvent par cet id.
+    Span span(std::move(name), Kind::server, Context{});
+    if (span.data_) {
+        span.data_->ctx.trace_hi = 0;
+        span.data_->ctx.trace_lo = interaction_id;
+        span.attr("discord.interaction_id", std::to_string(interaction_id));
+    }
+    return span;
+}
+
+Span::Span(Span&&) noexcept = default;
+
+Span& Span::operator=(Span&& other) noexcept {
+    if (this != &other) {
+        end();
+        data_ = std::move(other.data_);
+    }
+    return *this;
+}
+
+Span::~Span() {
+    end();
+}
+
+Context Span::context() const {
+    return data_ ? data_->ctx : Context{};
+}
+
+void Span::name(std::string name) {
+    if (data_)
+        data_->name = std::move(name);
+}
+
+void Span::attr(std::string_view key, std::string_view value) {
+    if (!data_)
+        return;
+    Attr a;
+    a.key.assign(key.data(), key.size());
+    a.str.assign(value.data(), std::min(value.size(), ATTR_VALUE_MAX));
+    data_->attrs.push_back(std::move(a));
+}
+
+void Span::attr(std::string_view key, std::int64_t value) {
+    if (!data_)
+        return;
+    Attr a;
+    a.key.assign(key.data(), key.size());
+    a.num    = value;
+    a.is_num = true;
+    data_->attrs.push_back(std::move(a));
+}
+
+void Span::error(std::string_view message) {
+    if (!data_)
+        return;
+    data_->failed = true;
+    data_->status.assign(message.data(), std::min(message.size(), ATTR_VALUE_MAX));
+}
+
+void Span::end() {
+    if (!data_)
+        return;
+    data_->end_ns = now_ns();
+    enqueue(std::move(data_));
+}
+
+} // namespace trace
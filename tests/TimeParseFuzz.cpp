@@ -0,0 +1,276 @@
+// Fuzz différentiel : time_parse contre les analyseurs à base de std::stoi
+// qu'il remplace (tests/legacy). Les deux versions reçoivent les mêmes entrées,
+// aléatoires ou construites à partir de la grammaire, et doivent rendre le même
+// verdict et les mêmes valeurs.
+//
+// Usage : time_parse_fuzz [itérations] [graine]
+
+#include "util/TimeParse.hpp"
+#include "util/TimeZone.hpp"
+
+#include "legacy/LegacyTimeParse.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace {
+
+constexpr std::size_t MAX_REPORTED = 20;
+
+std::mt19937_64 g_rng;
+std::size_t g_failures = 0;
+
+// Entrées acceptées par point d'entrée : le fuzz doit aussi couvrir les cas valides.
+enum Entry { HHMM, ISO, FRENCH, DDMM, MAKE_TIME, ENTRY_COUNT };
+const char* const ENTRY_NAMES[ENTRY_COUNT] = {
+    "parse_hhmm", "parse_iso_date", "parse_french_date", "parse_date_ddmm", "make_time_t"
+};
+std::uint64_t g_accepted[ENTRY_COUNT] = {};
+
+std::size_t pick(std::size_t n) {
+    return static_cast<std::size_t>(g_rng() % n);
+}
+
+bool coin(unsigned percent) {
+    return pick(100) < percent;
+}
+
+std::string escaped(const std::string& s) {
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\') {
+            out.push_back(static_cast<char>(c));
+        } else {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\x%02x", c);
+            out += buf;
+        }
+    }
+    return out + "\"";
+}
+
+void report(const char* entry, const std::string& input, const std::string& legacy, const std::string& current) {
+    if (++g_failures > MAX_REPORTED)
+        return;
+    std::cerr << "[" << entry << "] " << escaped(input)
+              << " : ancien " << legacy << ", nouveau " << current << "\n";
+}
+
+// Caractères qui comptent pour les grammaires, plus un peu de bruit.
+const std::string ALPHABET = "0123456789012345678901234567890123456789/-:hH+ \t\n\v\f\rxZé";
+
+std::string random_noise() {
+    std::string s;
+    const std::size_t len = pick(14);
+    for (std::size_t i = 0; i < len; ++i)
+        s.push_back(ALPHABET[pick(ALPHABET.size())]);
+    return s;
+}
+
+std::string blanks() {
+    static const char* const choices[] = { "", "", "", " ", "  ", "\t", " \n", "\r\f" };
+    return choices[pick(sizeof(choices) / sizeof(choices[0]))];
+}
+
+// Nombre tel que saisi : petit, zéros de tête, signe, ou hors des bornes d'int.
+std::string number() {
+    std::string s;
+    if (coin(4))
+        s.push_back(coin(50) ? '-' : '+');
+    if (coin(4))
+        s += blanks();
+
+    switch (pick(12)) {
+    case 0:  return s;                                   // aucun chiffre
+    case 1:
+    case 2:
+    case 3:  return s + std::to_string(pick(10));
+    case 4:
+    case 5:
+    case 6:  return s + std::to_string(pick(100));
+    case 7:  return s + "0" + std::to_string(pick(100));
+    case 8:
+    case 9:  return s + std::to_string(1900 + pick(300));
+    case 10: return s + std::to_string(g_rng() % 100000000000ULL);
+    default: {
+        static const char* const edges[] = {
+            "2147483647", "2147483648", "4294967296", "000000000000012",
+            "99999999999999999999", "31", "32", "29", "28", "30", "2100", "2101", "1969", "1970"
+        };
+        return s + edges[pick(sizeof(edges) / sizeof(edges[0]))];
+    }
+    }
+}
+
+std::string separator(char main) {
+    if (coin(95))
+        return std::string(1, main);
+    static const char seps[] = { '/', '-', ':', 'h', 'H', ' ' };
+    return std::string(1, seps[pick(sizeof(seps))]);
+}
+
+std::string tail() {
+    return coin(10) ? random_noise() : blanks();
+}
+
+std::string time_input() {
+    std::string s = blanks() + number();
+    if (coin(85)) {
+        s += blanks() + separator(coin(50) ? 'h' : ':');
+        if (coin(85))
+            s += blanks() + number();
+    }
+    return s + tail();
+}
+
+std::string iso_input() {
+    std::string s = blanks() + number() + separator('-') + number();
+    if (coin(92))
+        s += separator('-') + number();
+    return s + tail();
+}
+
+std::string french_input() {
+    std::string s = blanks() + number() + separator('/') + number();
+    if (coin(60))
+        s += separator('/') + number();
+    return s + tail();
+}
+
+std::string input_for(int grammar) {
+    if (coin(10))
+        return random_noise();
+
+    switch (grammar) {
+    case 0:  return time_input();
+    case 1:  return iso_input();
+    default: return french_input();
+    }
+}
+
+std::string verdict(bool ok, const std::string& value) {
+    return ok ? "ok " + value : "refus";
+}
+
+std::string tm_text(const std::tm& tm) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%d-%d-%d %d:%d:%d", tm.tm_year + 1900, tm.tm_mon + 1,
+                  tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    return buf;
+}
+
+void check_hhmm(const std::string& input) {
+    std::string legacy_out;
+    const bool legacy_ok = legacy_time_parse::parse_time_to_hhmm(input, legacy_out);
+
+    int h = 0, m = 0;
+    char buf[6] = {};
+    const bool ok = time_parse::parse_hhmm(input, h, m);
+    if (ok)
+        time_parse::format_hhmm(h, m, buf);
+    g_accepted[HHMM] += ok;
+
+    if (legacy_ok != ok || (ok && legacy_out != buf))
+        report("parse_hhmm", input, verdict(legacy_ok, legacy_out), verdict(ok, buf));
+}
+
+void check_iso(const std::string& input) {
+    int ly = 0, lm = 0, ld = 0;
+    const bool legacy_ok = legacy_time_parse::parse_iso_date(input, ly, lm, ld);
+
+    int y = 0, m = 0, d = 0;
+    const bool ok = time_parse::parse_iso_date(input, y, m, d);
+    g_accepted[ISO] += ok;
+
+    if (legacy_ok != ok || (ok && (ly != y || lm != m || ld != d))) {
+        report("parse_iso_date", input,
+               verdict(legacy_ok, std::to_string(ly) + "-" + std::to_string(lm) + "-" + std::to_string(ld)),
+               verdict(ok, std::to_string(y) + "-" + std::to_string(m) + "-" + std::to_string(d)));
+    }
+}
+
+void check_french(const std::string& input, int current_year) {
+    std::string legacy_out;
+    const bool legacy_ok = legacy_time_parse::parse_french_date_to_iso(input, legacy_out);
+
+    int y = 0, m = 0, d = 0;
+    std::string out;
+    const bool ok = time_parse::parse_french_date(input, current_year, y, m, d);
+    if (ok) {
+        char buf[20];
+        out.assign(buf, time_parse::format_iso_date(y, m, d, buf));
+    }
+    g_accepted[FRENCH] += ok;
+
+    if (legacy_ok != ok || (ok && legacy_out != out))
+        report("parse_french_date", input, verdict(legacy_ok, legacy_out), verdict(ok, out));
+}
+
+void check_ddmm(const std::string& input, const std::tm& base) {
+    std::tm legacy_out {};
+    const bool legacy_ok = legacy_time_parse::parse_date_ddmm(input, base, legacy_out);
+
+    std::tm out {};
+    const bool ok = time_parse::parse_date_ddmm(input, base, out);
+    g_accepted[DDMM] += ok;
+
+    if (legacy_ok != ok || (ok && tm_text(legacy_out) != tm_text(out)))
+        report("parse_date_ddmm", input, verdict(legacy_ok, tm_text(legacy_out)), verdict(ok, tm_text(out)));
+}
+
+void check_make_time(const std::string& date, const std::string& time, const TimeZone& utc) {
+    std::time_t legacy_out = 0;
+    const bool legacy_ok = legacy_time_parse::make_time_t(date, time, legacy_out);
+
+    std::time_t out = 0;
+    const bool ok = time_parse::make_time_t(date, time, utc, out);
+    g_accepted[MAKE_TIME] += ok;
+
+    if (legacy_ok != ok || (ok && legacy_out != out)) {
+        report("make_time_t", date + " | " + time,
+               verdict(legacy_ok, std::to_string(legacy_out)), verdict(ok, std::to_string(out)));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 3000000;
+    const std::uint64_t seed       = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20251118;
+
+    // Les anciennes versions passent par mktime/localtime : on les compare
+    // au fuseau UTC, seul fuseau où mktime ignore tm_isdst.
+    setenv("TZ", "UTC", 1);
+    tzset();
+    const TimeZone utc("UTC", 0);
+
+    g_rng.seed(seed);
+
+    const std::time_t now = std::time(nullptr);
+    const int current_year = utc.to_local(now).tm_year + 1900;
+    const std::tm base = utc.to_local(now);
+
+    for (std::uint64_t i = 0; i < iterations; ++i) {
+        check_hhmm(input_for(0));
+        check_iso(input_for(1));
+        check_french(input_for(2), current_year);
+        check_ddmm(input_for(2), base);
+        check_make_time(input_for(1), input_for(0), utc);
+    }
+
+    if (g_failures > 0) {
+        std::cerr << g_failures << " différence(s) sur " << iterations << " itération(s) (graine "
+                  << seed << ")\n";
+        return 1;
+    }
+
+    std::cout << iterations << " itération(s), aucune différence (graine " << seed << ")\n";
+    for (int e = 0; e < ENTRY_COUNT; ++e)
+        std::cout << "  " << ENTRY_NAMES[e] << " : " << g_accepted[e] << " entrée(s) acceptée(s)\n";
+    return 0;
+}
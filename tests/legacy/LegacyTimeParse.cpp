@@ -0,0 +1,260 @@
+#include "LegacyTimeParse.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+namespace legacy_time_parse {
+
+std::string trim(const std::string& s) {
+    std::size_t b = 0;
+    while (b < s.size() &&
+           std::isspace(static_cast<unsigned char>(s[b]))) {
+        ++b;
+    }
+
+    std::size_t e = s.size();
+    while (e > b &&
+           std::isspace(static_cast<unsigned char>(s[e - 1]))) {
+        --e;
+    }
+
+    return s.substr(b, e - b);
+}
+
+bool parse_time_to_hhmm(const std::string& input, std::string& out)
+{
+    std::string s;
+    s.reserve(input.size());
+    for (char c : input) {
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            char lc = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            if (lc == 'h')
+                lc = ':'; // 7h30 -> 7:30, 7h -> 7:
+            s.push_back(lc);
+        }
+    }
+
+    if (s.empty())
+        return false;
+
+    int h = 0;
+    int m = 0;
+
+    auto pos = s.find(':');
+    if (pos == std::string::npos) {
+        // "7", "07" -> 7:00
+        for (char c : s) {
+            if (!std::isdigit(static_cast<unsigned char>(c))) {
+                return false;
+            }
+        }
+
+        try {
+            h = std::stoi(s);
+        } catch (...) {
+            return false;
+        }
+        m = 0;
+    } else {
+        std::string h_str = s.substr(0, pos);
+        std::string m_str;
+
+        if (pos + 1 < s.size()) {
+            m_str = s.substr(pos + 1);
+        } else {
+            m_str = "0"; // "7:" -> minutes = 0
+        }
+
+        if (h_str.empty())
+            return false;
+
+        try {
+            h = std::stoi(h_str);
+            m = std::stoi(m_str);
+        } catch (...) {
+            return false;
+        }
+    }
+
+    if (h < 0 || h > 23 || m < 0 || m > 59)
+        return false;
+
+    std::ostringstream oss;
+    oss << std::setw(2) << std::setfill('0') << h
+        << ":"
+        << std::setw(2) << std::setfill('0') << m;
+
+    out = oss.str();
+    return true;
+}
+
+bool parse_iso_date(const std::string& iso,
+                    int& year, int& month, int& day)
+{
+    std::string s = trim(iso);
+    auto p1 = s.find('-');
+    if (p1 == std::string::npos) return false;
+    auto p2 = s.find('-', p1 + 1);
+    if (p2 == std::string::npos) return false;
+
+    try {
+        year  = std::stoi(s.substr(0, p1));
+        month = std::stoi(s.substr(p1 + 1, p2 - p1 - 1));
+        day   = std::stoi(s.substr(p2 + 1));
+    } catch (...) {
+        return false;
+    }
+
+    if (month < 1 || month > 12 ||
+        day   < 1 || day   > 31)
+        return false;
+
+    return true;
+}
+
+bool make_time_t(const std::string& date_iso,
+                 const std::string& time_str,
+                 std::time_t& out)
+{
+    int year = 0, month = 0, day = 0;
+    if (!parse_iso_date(date_iso, year, month, day))
+        return false;
+
+    std::string s;
+    s.reserve(time_str.size());
+    for (char c : time_str) {
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            s.push_back(c);
+        }
+    }
+    auto pos = s.find(':');
+    if (pos == std::string::npos)
+        return false;
+
+    int hour = 0, minute = 0;
+    try {
+        hour   = std::stoi(s.substr(0, pos));
+        minute = std::stoi(s.substr(pos + 1));
+    } catch (...) {
+        return false;
+    }
+
+    if (hour < 0 || hour > 23 || minute < 0 || minute > 59)
+        return false;
+
+    std::tm tm {};
+    tm.tm_year = year - 1900;
+    tm.tm_mon  = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min  = minute;
+    tm.tm_sec  = 0;
+
+    out = std::mktime(&tm);
+    return true;
+}
+
+bool parse_french_date_to_iso(const std::string& input,
+                              std::string& iso_out)
+{
+    std::string s = trim(input);
+    if (s.empty()) return false;
+
+    auto p1 = s.find('/');
+    if (p1 == std::string::npos) return false;
+    auto p2 = s.find('/', p1 + 1);
+
+    int day = 0, month = 0, year = 0;
+
+    try {
+        day = std::stoi(s.substr(0, p1));
+
+        if (p2 == std::string::npos) {
+            // JJ/MM -> année courante
+            month = std::stoi(s.substr(p1 + 1));
+            std::time_t now = std::time(nullptr);
+            std::tm tm_now {};
+            tm_now = *std::localtime(&now);
+            year = tm_now.tm_year + 1900;
+        } else {
+            // JJ/MM/AAAA, JJ/MM/YY
+            month = std::stoi(s.substr(p1 + 1, p2 - p1 - 1));
+            std::string ystr = s.substr(p2 + 1);
+            year = std::stoi(ystr);
+            if (year < 100) {
+                year += 2000;
+            }
+        }
+    } catch (...) {
+        return false;
+    }
+
+    if (month < 1 || month > 12 || day < 1 || day > 31)
+        return false;
+
+    std::tm tm {};
+    tm.tm_year = year - 1900;
+    tm.tm_mon  = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = 12;
+    tm.tm_min  = 0;
+    tm.tm_sec  = 0;
+    std::time_t t = std::mktime(&tm);
+    if (t == -1)
+        return false;
+    if (tm.tm_year != year - 1900 ||
+        tm.tm_mon  != month - 1   ||
+        tm.tm_mday != day)
+        return false;
+
+    char buf[20];
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d", year, month, day);
+    iso_out = buf;
+    return true;
+}
+
+bool parse_date_ddmm(const std::string& input,
+                     const std::tm& base_tm,
+                     std::tm& out_tm)
+{
+    std::string s = trim(input);
+    if (s.empty())
+        return false;
+
+    int d = 0, m = 0, y = 0;
+
+    std::size_t p1 = s.find('/');
+    if (p1 == std::string::npos)
+        return false;
+
+    std::size_t p2 = s.find('/', p1 + 1);
+
+    try {
+        d = std::stoi(s.substr(0, p1));
+        if (p2 == std::string::npos) {
+            // dd/mm
+            m = std::stoi(s.substr(p1 + 1));
+            y = base_tm.tm_year + 1900;
+        } else {
+            // dd/mm/yyyy
+            m = std::stoi(s.substr(p1 + 1, p2 - (p1 + 1)));
+            y = std::stoi(s.substr(p2 + 1));
+        }
+    } catch (...) {
+        return false;
+    }
+
+    if (d <= 0 || d > 31 || m <= 0 || m > 12 || y < 1970 || y > 2100)
+        return false;
+
+    out_tm = base_tm;
+    out_tm.tm_mday = d;
+    out_tm.tm_mon  = m - 1;
+    out_tm.tm_year = y - 1900;
+
+    return true;
+}
+
+} // namespace legacy_time_parse
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ctime>
+#include <string>
+
+// Analyseurs de dates et d'heures tels qu'ils étaient avant time_parse
+// (std::stoi, std::ostringstream, mktime). Gardés uniquement comme référence
+// pour le fuzz différentiel et les benchmarks : ne pas les utiliser dans le bot.
+namespace legacy_time_parse {
+
+std::string trim(const std::string& s);
+
+bool parse_time_to_hhmm(const std::string& input, std::string& out);
+
+bool parse_iso_date(const std::string& iso, int& year, int& month, int& day);
+
+// Heure locale du processus (TZ) via mktime.
+bool make_time_t(const std::string& date_iso, const std::string& time_str, std::time_t& out);
+
+// JJ/MM : année courante selon localtime.
+bool parse_french_date_to_iso(const std::string& input, std::string& iso_out);
+
+bool parse_date_ddmm(const std::string& input, const std::tm& base_tm, std::tm& out_tm);
+
+} // namespace legacy_time_parse